@@ -1,6 +1,7 @@
 #ifndef AUDIO_HANDLER_H
 
 #include "RPU.h"
+#include "RPU_TimedQueue.h"
 #include "RPU_config.h"
 #include "WavTrigger.h"
 #include <HardwareSerial.h>
@@ -26,18 +27,30 @@ struct AudioSoundtrack {
 #define SB300_SOUND_FUNCTION_SQUARE_WAVE 0
 #define SB300_SOUND_FUNCTION_ANALOG 1
 
+// The play time is kept by the queue
 struct SoundCardCommandEntry {
    uint8_t soundFunction;
    uint8_t soundRegister;
    uint8_t soundByte;
-   unsigned long playTime;
 };
 
 struct SoundEntry {
    uint16_t soundIndex;
    uint8_t audioType;
    uint8_t overrideVolume;
-   unsigned long playTime;
+};
+
+// Original-sound sequences are arrays of steps kept in PROGMEM. Each step
+// sends soundByte to the sound card and waits delayAfter ms before the
+// next one, and the array ends with a SOUND_SEQUENCE_END step:
+//
+//   const SoundSequenceStep ChimeTwice[] PROGMEM = {{0x04, 75}, {0x00, 125}, {SOUND_SEQUENCE_END, 0}};
+//   Audio.PlaySoundSequence(ChimeTwice, CurrentTime, 2);
+constexpr uint8_t SOUND_SEQUENCE_END = 0xFF;
+
+struct SoundSequenceStep {
+   uint8_t soundByte;
+   uint8_t delayAfter;
 };
 
 // These SoundEFfectEntry & Queue functions parcel out FX to the
@@ -83,7 +96,23 @@ class AudioHandler {
       return QueueSound(soundIndex, AUDIO_PLAY_TYPE_WAV_TRIGGER, timeToPlay, overrideVolume);
    }
 
+   // Only one sequence plays at a time - starting another one replaces it
+   bool PlaySoundSequence(const SoundSequenceStep* sequence, unsigned long startTime, uint8_t repeatCount = 1);
+   void StopSoundSequence();
+
    bool QueueSoundCardCommand(uint8_t scFunction, uint8_t scRegister, uint8_t scData, unsigned long startTime);
+   unsigned long GetSoundQueueDrops() const {
+      return soundQueue.GetNumDropped();
+   }
+   unsigned long GetSoundCardQueueDrops() const;
+#if defined(AUDIOHANDLER_USES_WAV_TRIGGER)
+   uint8_t GetWavTriggerTxQueueDepth() const {
+      return wTrig.getTxQueueDepth();
+   }
+   unsigned int GetWavTriggerTxBytesPerSecond() const {
+      return wTrig.getTxBytesPerSecond();
+   }
+#endif
 
    bool PlaySoundCardWhenPossible(uint16_t soundEffectNum, unsigned long currentTime, unsigned long requestedPlayTime = 0,
                                   unsigned long playUntil = 50, uint8_t priority = 10);
@@ -102,8 +131,14 @@ class AudioHandler {
  private:
    static constexpr int NUMBER_OF_SONGS_REMEMBERED = 10;
    static constexpr int VOICE_NOTIFICATION_STACK_SIZE = 5;
+#if (RPU_OS_HARDWARE_REV > 2)
    static constexpr int SOUND_QUEUE_SIZE = 30;
    static constexpr int SOUND_CARD_QUEUE_SIZE = 100;
+#else
+   // The Nano (rev 1 & 2) only has 2K of SRAM
+   static constexpr int SOUND_QUEUE_SIZE = 12;
+   static constexpr int SOUND_CARD_QUEUE_SIZE = 32;
+#endif
    static constexpr int SOUND_EFFECT_QUEUE_SIZE = 50;
 
    AudioSoundtrack* curSoundtrack;
@@ -126,18 +161,28 @@ class AudioHandler {
    uint16_t curSoundtrackEntries;
    uint16_t currentBackgroundTrack;
 
-   SoundEntry soundQueue[SOUND_QUEUE_SIZE];
+   RPUTimedQueue<SoundEntry, SOUND_QUEUE_SIZE> soundQueue;
 
    unsigned long nextVoiceNotificationPlayTime;
    unsigned long backgroundSongEndTime;
 
+   const SoundSequenceStep* soundSequence;
+   uint8_t soundSequenceStep;
+   uint8_t soundSequenceRepeatsLeft;
+   unsigned long soundSequenceNextTime;
+
 #if defined(RPU_OS_USE_WTYPE_1_SOUND) || defined(RPU_OS_USE_WTYPE_2_SOUND)
    SoundEffectEntry CurrentSoundPlaying;
    SoundEffectEntry SoundEffectQueue[SOUND_EFFECT_QUEUE_SIZE];
+   // Nothing in the queue can be played or expire before the earliest
+   // requested time, so the queue only gets scanned once that has passed
+   uint8_t soundEffectQueueCount;
+   unsigned long nextSoundEffectTime;
+   unsigned long soundEffectQueueDrops;
 #endif
 
 #ifdef RPU_OS_USE_SB300
-   SoundCardCommandEntry soundCardQueue[SOUND_CARD_QUEUE_SIZE];
+   RPUTimedQueue<SoundCardCommandEntry, SOUND_CARD_QUEUE_SIZE> soundCardQueue;
 #endif
 
 #if defined(AUDIOHANDLER_USES_WAV_TRIGGER)
@@ -162,6 +207,7 @@ class AudioHandler {
    uint8_t GetTopNotificationPriority();
    bool ServiceSoundCardQueue(unsigned long currentTime);
    bool ServiceSoundQueue(unsigned long currentTime);
+   bool ServiceSoundSequence(unsigned long currentTime);
 };
 
 #define AUDIO_HANDLER_H
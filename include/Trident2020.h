@@ -18,6 +18,7 @@
     See <https://www.gnu.org/licenses/>.
  */
 
+#include <Arduino.h>
 #include <stdint.h>
 
 // Lamp Numbers (defines for lamps)
@@ -148,7 +149,7 @@ constexpr int NUM_SWITCHES_WITH_TRIGGERS = 6;
 constexpr int NUM_PRIORITY_SWITCHES_WITH_TRIGGERS = 6;
 
 // Define automatic solenoid triggers (switch, solenoid, number of 1/120ths of a second to fire)
-const struct PlayfieldAndCabinetSwitch TriggeredSwitches[] = {
+const struct PlayfieldAndCabinetSwitch TriggeredSwitches[] PROGMEM = {
     {SW_TOP_BUMPER,    SOL_TOP_BUMPER,    4},
     {SW_BOTTOM_BUMPER, SOL_BOTTOM_BUMPER, 4},
     {SW_UL_SLING,      SOL_UL_SLING,      4},
@@ -25,6 +25,8 @@
  *   RPU_OS_HARDWARE_REV 102 - MEGA2560 PRO board that plugs into processor socket (prototype)
  *                             adds support for OLED display, WIFI, autodetection of processor type
  *
+ *   RPU_OS_HOST_SIMULATION  - (with RPU_OS_HARDWARE_REV 3) native build against the emulated MPU in lib/RPUHost
+ *
  */
 
 #if (RPU_OS_HARDWARE_REV == 1)
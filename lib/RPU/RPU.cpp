@@ -23,6 +23,8 @@
 #include "RPU_config.h"
 #include "RPU.h"
 #include "OsHardware.h"
+#include "RPU_Ring.h"
+#include "RPU_TimedQueue.h"
 
 #define DEBUG_MESSAGES 0
 
@@ -90,58 +92,137 @@ volatile uint8_t DisplayBIPDigitEnable;
 volatile uint8_t DisplayCommas;
 #endif
 
-#if (RPU_MPU_ARCHITECTURE == 15)
-volatile uint8_t DisplayText[2][RPU_OS_NUM_DIGITS];
-#endif
-
 #endif // End of condition based on RPU_MPU_ARCHITECTURE
 
 // Global variables
-volatile uint8_t DisplayDigits[5][RPU_OS_NUM_DIGITS];
-volatile uint8_t DisplayDigitEnable[5];
 volatile bool DisplayOffCycle = false;
 volatile uint8_t CurrentDisplayDigit = 0;
-volatile uint8_t LampStates[RPU_NUM_LAMP_BANKS], LampDim1[RPU_NUM_LAMP_BANKS], LampDim2[RPU_NUM_LAMP_BANKS];
+volatile uint8_t LampDim1[RPU_NUM_LAMP_BANKS], LampDim2[RPU_NUM_LAMP_BANKS];
 volatile uint8_t LampFlashPeriod[RPU_MAX_LAMPS];
-uint8_t DimDivisor1 = 2;
-uint8_t DimDivisor2 = 3;
+
+// Flashing lamps are kept in groups by flash period so RPU_ApplyFlashToLamps
+// works out the phase once per group (and only when it's due to toggle)
+// instead of dividing the time by the period for every lamp on every loop.
+// Lamps that don't fit in a group are flashed one at a time from
+// UngroupedFlashLamps.
+#if (RPU_OS_HARDWARE_REV > 2)
+#define RPU_NUM_LAMP_FLASH_GROUPS 8
+#else
+#define RPU_NUM_LAMP_FLASH_GROUPS 4
+#endif
+#define LAMP_FLASH_PHASE_UNKNOWN 0xFF
+struct LampFlashGroup {
+   unsigned long nextToggleTime;
+   uint8_t period; // in 50ms units, 0 if the group isn't in use
+   uint8_t numLamps;
+   uint8_t phase; // 1 while the lamps are on
+   uint8_t lampMask[RPU_NUM_LAMP_BANKS];
+};
+LampFlashGroup LampFlashGroups[RPU_NUM_LAMP_FLASH_GROUPS];
+uint8_t UngroupedFlashLamps[RPU_NUM_LAMP_BANKS];
+
+// Lamp brightness is bit-angle modulated over a frame of 8 lamp passes.
+// A lamp at brightness B is held off for (7 - B) of the 8 passes. Bit k
+// of that off count is kept in LampBrightnessPlanes[k], and plane k is
+// shown in 2^k of the passes (interleaved so the off passes are spread
+// out). Plane 3 is always empty - it's the pass where every lit lamp is on.
+#define LAMP_BRIGHTNESS_NUM_PLANES 4
+const uint8_t LampPlaneForPass[8] PROGMEM = {2, 1, 2, 0, 2, 1, 2, 3};
+uint8_t LampPassesOff[RPU_MAX_LAMPS]; // 0 (the default) is full brightness
+// The brightness used for the two RPU_SetLampState dim levels (see RPU_SetDimDivisor)
+uint8_t DimBrightness1 = 3;
+uint8_t DimBrightness2 = 2;
+
+// Everything the interrupts show on the lamps & displays. The RPU_Set*
+// functions draw into DrawFrame and the interrupts show
+// Frames[ShownFrameIndex]. Normally those are the same frame, but with
+// RPU_OS_DOUBLE_BUFFER_FRAMES there are two of them and nothing that's
+// drawn shows up until RPU_CommitFrame flips them.
+struct RPUFrame {
+   uint8_t LampStates[RPU_NUM_LAMP_BANKS];
+   uint8_t LampBrightnessPlanes[LAMP_BRIGHTNESS_NUM_PLANES][RPU_NUM_LAMP_BANKS];
+   uint8_t DisplayDigits[5][RPU_OS_NUM_DIGITS];
+   uint8_t DisplayDigitEnable[5];
+#if (RPU_MPU_ARCHITECTURE == 15)
+   uint8_t DisplayText[2][RPU_OS_NUM_DIGITS];
+#endif
+};
+#if defined(RPU_OS_DOUBLE_BUFFER_FRAMES)
+#define RPU_NUM_FRAMES 2
+#else
+#define RPU_NUM_FRAMES 1
+#endif
+volatile RPUFrame Frames[RPU_NUM_FRAMES];
+// A single byte, so an interrupt always sees a whole flip. Each interrupt
+// reads it once at the start, so a lamp pass or display digit never mixes
+// two frames.
+volatile uint8_t ShownFrameIndex = 0;
+volatile RPUFrame* DrawFrame = &Frames[RPU_NUM_FRAMES - 1];
 
 volatile uint8_t SwitchesMinus2[NUM_SWITCH_BYTES];
 volatile uint8_t SwitchesMinus1[NUM_SWITCH_BYTES];
 volatile uint8_t SwitchesNow[NUM_SWITCH_BYTES];
+
+// Per-switch trigger table built by RPU_SetupGameSwitches so the
+// interrupt can find a switch's solenoid without scanning GameSwitches.
+// An entry is only valid if its bit is set in TriggeredSwitchMask,
+// and PrioritySwitchMask marks the bumpers & slings that fire on the
+// first (off, on) scan.
+struct SwitchTrigger {
+   uint8_t solenoid;
+   uint8_t solenoidHoldTime;
+};
+SwitchTrigger SwitchTriggers[MAX_NUM_SWITCHES];
+uint8_t TriggeredSwitchMask[NUM_SWITCH_BYTES];
+uint8_t PrioritySwitchMask[NUM_SWITCH_BYTES];
 #ifdef RPU_OS_USE_DIP_SWITCHES
 uint8_t DipSwitches[4];
 #endif
 
+// The solenoid stack holds one entry per request rather than one
+// per pulse - the interrupt counts down remainingCycles in place
+// and only moves on when the entry is used up.
 #if (RPU_OS_HARDWARE_REV > 2)
-#define SOLENOID_STACK_SIZE 150
+#define SOLENOID_STACK_SIZE 32
 #else
-#define SOLENOID_STACK_SIZE 60
+#define SOLENOID_STACK_SIZE 16
 #endif
 #define SOLENOID_STACK_EMPTY 0xFF
-volatile uint8_t SolenoidStackFirst;
-volatile uint8_t SolenoidStackLast;
-volatile uint8_t SolenoidStack[SOLENOID_STACK_SIZE];
+struct SolenoidStackEntry {
+   uint8_t solenoid;
+   uint8_t remainingCycles;
+};
+RPURing<SolenoidStackEntry, SOLENOID_STACK_SIZE> SolenoidStack;
 bool SolenoidStackEnabled = true;
 volatile uint8_t CurrentSolenoidByte = 0xFF;
 volatile uint8_t RevertSolenoidBit = 0x00;
 volatile uint8_t NumCyclesBeforeRevertingSolenoidByte = 0;
 
+#if (RPU_OS_HARDWARE_REV > 2)
 #define TIMED_SOLENOID_STACK_SIZE 30
+#else
+#define TIMED_SOLENOID_STACK_SIZE 16
+#endif
 struct TimedSolenoidEntry {
-   uint8_t inUse;
-   unsigned long pushTime;
    uint8_t solenoidNumber;
    uint8_t numPushes;
    uint8_t disableOverride;
 };
-TimedSolenoidEntry TimedSolenoidStack[TIMED_SOLENOID_STACK_SIZE] = {0, 0, 0, 0, 0};
+RPUTimedQueue<TimedSolenoidEntry, TIMED_SOLENOID_STACK_SIZE> TimedSolenoidStack;
 
-#define SWITCH_STACK_SIZE 60
+#if (RPU_OS_HARDWARE_REV > 2)
+#define SWITCH_STACK_SIZE 64
+#else
+#define SWITCH_STACK_SIZE 32
+#endif
 #define SWITCH_STACK_EMPTY 0xFF
-volatile uint8_t SwitchStackFirst;
-volatile uint8_t SwitchStackLast;
-volatile uint8_t SwitchStack[SWITCH_STACK_SIZE];
+struct SwitchStackEntry {
+   uint8_t switchNumber;
+#if defined(RPU_OS_TRACK_SWITCH_LATENCY)
+   unsigned long pushMicros; // micros() when the switch went on the stack
+#endif
+};
+RPURing<SwitchStackEntry, SWITCH_STACK_SIZE> SwitchStack;
 
 // The WTYPE1 and WTYPE2 sound cards can only play one sound at a time,
 // so these structures allow the app to send in as many calls as they
@@ -153,82 +234,28 @@ volatile uint8_t SwitchStack[SWITCH_STACK_SIZE];
 
 #define SOUND_STACK_SIZE 64
 #define SOUND_STACK_EMPTY 0x0000
-volatile uint8_t SoundStackFirst;
-volatile uint8_t SoundStackLast;
-volatile unsigned short SoundStack[SOUND_STACK_SIZE];
+RPURing<unsigned short, SOUND_STACK_SIZE> SoundStack;
 
 #define TIMED_SOUND_STACK_SIZE 20
 struct TimedSoundEntry {
-   uint8_t inUse;
-   unsigned long pushTime;
    unsigned short soundNumber;
    uint8_t numPushes;
 };
-TimedSoundEntry TimedSoundStack[TIMED_SOUND_STACK_SIZE] = {0, 0, 0, 0};
+RPUTimedQueue<TimedSoundEntry, TIMED_SOUND_STACK_SIZE> TimedSoundStack;
 #endif
 
 
-#if (RPU_OS_HARDWARE_REV == 1) or (RPU_OS_HARDWARE_REV == 2)
+#if defined(RPU_OS_HOST_SIMULATION)
+
+// RPU_DataWrite and RPU_DataRead are supplied by lib/RPUHost, which runs
+// them against an emulated U10/U11 pair instead of the 6800 bus
+
+#elif (RPU_OS_HARDWARE_REV == 1) or (RPU_OS_HARDWARE_REV == 2)
 
 #if defined(__AVR_ATmega2560__)
 #error "ATMega requires RPU_OS_HARDWARE_REV of 3, check RPU_Config.h and adjust settings"
 #endif
 
-void RPU_DataWrite(int address, uint8_t data) {
-   // Set data pins to output
-   // Make pins 5-7 output (and pin 3 for R/W)
-   DDRD = DDRD | 0xE8;
-   // Make pins 8-12 output
-   DDRB = DDRB | 0x1F;
-
-   // Set R/W to LOW
-   PORTD = (PORTD & 0xF7);
-
-   // Put data on pins
-   // Put lower three bits on 5-7
-   PORTD = (PORTD & 0x1F) | ((data & 0x07) << 5);
-   // Put upper five bits on 8-12
-   PORTB = (PORTB & 0xE0) | (data >> 3);
-
-   // Set up address lines
-   PORTC = (PORTC & 0xE0) | address;
-
-   // Wait for a falling edge of the clock
-   while ((PIND & 0x10))
-      ;
-
-   // Pulse VMA over one clock cycle
-   // Set VMA ON
-   PORTC = PORTC | 0x20;
-
-   // Wait while clock is low
-   while (!(PIND & 0x10))
-      ;
-
-   // Wait while clock is high
-   while ((PIND & 0x10))
-      ;
-
-   // Wait while clock is low
-   while (!(PIND & 0x10))
-      ;
-
-   // Set VMA OFF
-   PORTC = PORTC & 0xDF;
-
-   // Unset address lines
-   PORTC = PORTC & 0xE0;
-
-   // Set R/W back to HIGH
-   PORTD = (PORTD | 0x08);
-
-   // Set data pins to input
-   // Make pins 5-7 input
-   DDRD = DDRD & 0x1F;
-   // Make pins 8-12 input
-   DDRB = DDRB & 0xE0;
-}
-
 uint8_t RPU_DataRead(int address) {
    // Set data pins to input
    // Make pins 5-7 input
@@ -282,6 +309,67 @@ uint8_t RPU_DataRead(int address) {
    return inputData;
 }
 
+// Writes a run of bus operations with the data pins switched to output
+// (and R/W held low) once for the whole run instead of once per write
+void RPU_DataWriteBurst(const BusOp* ops, uint8_t numOps) {
+   // Set data pins to output
+   // Make pins 5-7 output (and pin 3 for R/W)
+   DDRD = DDRD | 0xE8;
+   // Make pins 8-12 output
+   DDRB = DDRB | 0x1F;
+
+   // Set R/W to LOW
+   PORTD = (PORTD & 0xF7);
+
+   for (uint8_t opCount = 0; opCount < numOps; opCount++) {
+      uint8_t data = ops[opCount].data;
+
+      // Put data on pins
+      // Put lower three bits on 5-7
+      PORTD = (PORTD & 0x1F) | ((data & 0x07) << 5);
+      // Put upper five bits on 8-12
+      PORTB = (PORTB & 0xE0) | (data >> 3);
+
+      // Set up address lines
+      PORTC = (PORTC & 0xE0) | ops[opCount].address;
+
+      // Wait for a falling edge of the clock
+      while ((PIND & 0x10))
+         ;
+
+      // Pulse VMA over one clock cycle
+      // Set VMA ON
+      PORTC = PORTC | 0x20;
+
+      // Wait while clock is low
+      while (!(PIND & 0x10))
+         ;
+
+      // Wait while clock is high
+      while ((PIND & 0x10))
+         ;
+
+      // Wait while clock is low
+      while (!(PIND & 0x10))
+         ;
+
+      // Set VMA OFF
+      PORTC = PORTC & 0xDF;
+   }
+
+   // Unset address lines
+   PORTC = PORTC & 0xE0;
+
+   // Set R/W back to HIGH
+   PORTD = (PORTD | 0x08);
+
+   // Set data pins to input
+   // Make pins 5-7 input
+   DDRD = DDRD & 0x1F;
+   // Make pins 8-12 input
+   DDRB = DDRB & 0xE0;
+}
+
 void WaitClockCycle(int numCycles = 1) {
    for (int count = 0; count < numCycles; count++) {
       // Wait while clock is low
@@ -311,68 +399,6 @@ void WaitClockCycle(int numCycles = 1) {
 #error "RPU_OS_HARDWARE_REV 3 requires ATMega2560, check RPU_Config.h and adjust settings"
 #endif
 
-void RPU_DataWrite(int address, uint8_t data) {
-   // Set data pins to output
-   DDRH = DDRH | 0x78;
-   DDRB = DDRB | 0x70;
-   DDRJ = DDRJ | 0x01;
-
-   // Set R/W to LOW
-   PORTE = (PORTE & 0xF7);
-
-   // Put data on pins
-   // Lower Nibble goes on PortH3 through H6
-   PORTH = (PORTH & 0x87) | ((data & 0x0F) << 3);
-   // Bits 4-6 go on PortB4 through B6
-   PORTB = (PORTB & 0x8F) | ((data & 0x70));
-   // Bit 7 goes on PortJ0
-   PORTJ = (PORTJ & 0xFE) | (data >> 7);
-
-   // Set up address lines
-   PORTH = (PORTH & 0xFC) | ((address & 0x0001) << 1) | ((address & 0x0002) >> 1); // A0-A1
-   PORTD = (PORTD & 0xF0) | ((address & 0x0004) << 1) | ((address & 0x0008) >> 1) | ((address & 0x0010) >> 3) |
-           ((address & 0x0020) >> 5);                                              // A2-A5
-   PORTA = ((address & 0x3FC0) >> 6);                                              // A6-A13
-   PORTC = (PORTC & 0x3F) | ((address & 0x4000) >> 7) | ((address & 0x8000) >> 9); // A14-A15
-
-   // Wait for a falling edge of the clock
-   while ((PINE & 0x20))
-      ;
-
-   // Pulse VMA over one clock cycle
-   // Set VMA ON
-   PORTG = PORTG | 0x20;
-
-   // Wait while clock is low
-   while (!(PINE & 0x20))
-      ;
-
-   // Wait while clock is high
-   while ((PINE & 0x20))
-      ;
-
-   // Wait while clock is low
-   while (!(PINE & 0x20))
-      ;
-
-   // Set VMA OFF
-   PORTG = PORTG & 0xDF;
-
-   // Unset address lines
-   PORTH = (PORTH & 0xFC);
-   PORTD = (PORTD & 0xF0);
-   PORTA = 0;
-   PORTC = (PORTC & 0x3F);
-
-   // Set R/W back to HIGH
-   PORTE = (PORTE | 0x08);
-
-   // Set data pins to input
-   DDRH = DDRH & 0x87;
-   DDRB = DDRB & 0x8F;
-   DDRJ = DDRJ & 0xFE;
-}
-
 uint8_t RPU_DataRead(int address) {
    // Set data pins to input
    DDRH = DDRH & 0x87;
@@ -432,6 +458,75 @@ uint8_t RPU_DataRead(int address) {
    return inputData;
 }
 
+// Writes a run of bus operations with the data pins switched to output
+// (and R/W held low) once for the whole run instead of once per write
+void RPU_DataWriteBurst(const BusOp* ops, uint8_t numOps) {
+   // Set data pins to output
+   DDRH = DDRH | 0x78;
+   DDRB = DDRB | 0x70;
+   DDRJ = DDRJ | 0x01;
+
+   // Set R/W to LOW
+   PORTE = (PORTE & 0xF7);
+
+   for (uint8_t opCount = 0; opCount < numOps; opCount++) {
+      uint8_t data = ops[opCount].data;
+      uint16_t address = ops[opCount].address;
+
+      // Put data on pins
+      // Lower Nibble goes on PortH3 through H6
+      PORTH = (PORTH & 0x87) | ((data & 0x0F) << 3);
+      // Bits 4-6 go on PortB4 through B6
+      PORTB = (PORTB & 0x8F) | ((data & 0x70));
+      // Bit 7 goes on PortJ0
+      PORTJ = (PORTJ & 0xFE) | (data >> 7);
+
+      // Set up address lines
+      PORTH = (PORTH & 0xFC) | ((address & 0x0001) << 1) | ((address & 0x0002) >> 1); // A0-A1
+      PORTD = (PORTD & 0xF0) | ((address & 0x0004) << 1) | ((address & 0x0008) >> 1) | ((address & 0x0010) >> 3) |
+              ((address & 0x0020) >> 5);                                              // A2-A5
+      PORTA = ((address & 0x3FC0) >> 6);                                              // A6-A13
+      PORTC = (PORTC & 0x3F) | ((address & 0x4000) >> 7) | ((address & 0x8000) >> 9); // A14-A15
+
+      // Wait for a falling edge of the clock
+      while ((PINE & 0x20))
+         ;
+
+      // Pulse VMA over one clock cycle
+      // Set VMA ON
+      PORTG = PORTG | 0x20;
+
+      // Wait while clock is low
+      while (!(PINE & 0x20))
+         ;
+
+      // Wait while clock is high
+      while ((PINE & 0x20))
+         ;
+
+      // Wait while clock is low
+      while (!(PINE & 0x20))
+         ;
+
+      // Set VMA OFF
+      PORTG = PORTG & 0xDF;
+   }
+
+   // Unset address lines
+   PORTH = (PORTH & 0xFC);
+   PORTD = (PORTD & 0xF0);
+   PORTA = 0;
+   PORTC = (PORTC & 0x3F);
+
+   // Set R/W back to HIGH
+   PORTE = (PORTE | 0x08);
+
+   // Set data pins to input
+   DDRH = DDRH & 0x87;
+   DDRB = DDRB & 0x8F;
+   DDRJ = DDRJ & 0xFE;
+}
+
 void WaitClockCycle(int numCycles = 1) {
    for (int count = 0; count < numCycles; count++) {
       // Wait while clock is low
@@ -485,15 +580,13 @@ void RPU_SetDataPinsDirection(bool pinsOutput) {
 }
 
 // REVISION 4 HARDWARE
-void RPU_DataWrite(int address, uint8_t data) {
-   // Set data pins to output
-   DDRA = 0xFF;
-
-   // Set R/W to LOW
-   PORTE = (PORTE & 0xDF);
+uint8_t RPU_DataRead(int address) {
+   // Set data pins to input
+   DDRA = 0x00;
 
-   // Put data on pins
-   PORTA = data;
+   // Set R/W to HIGH
+   DDRE = DDRE | 0x20;
+   PORTE = (PORTE | 0x20);
 
    // Set up address lines
    PORTF = (uint8_t)(address & 0x00FF);
@@ -504,7 +597,7 @@ void RPU_DataWrite(int address, uint8_t data) {
       while ((PING & 0x04))
          ;
    } else {
-      // Set clock low (PG2) (if 6802/8)
+      // Set clock low
       PORTG &= ~0x04;
    }
 
@@ -513,11 +606,13 @@ void RPU_DataWrite(int address, uint8_t data) {
    PORTG = PORTG | 0x02;
 
    if (UsesM6800Processor) {
+      // Wait a full clock cycle to make sure data lines are ready
+      // (important for faster clocks)
       // Wait while clock is low
       while (!(PING & 0x04))
          ;
 
-      // Wait while clock is high
+      // Wait for a falling edge of the clock
       while ((PING & 0x04))
          ;
 
@@ -535,84 +630,88 @@ void RPU_DataWrite(int address, uint8_t data) {
       PORTG |= 0x04;
    }
 
+   uint8_t inputData;
+   inputData = PINA;
+
    // Set VMA OFF
    PORTG = PORTG & 0xFD;
 
+   // Set R/W to LOW
+   PORTE = (PORTE & 0xDF);
+
    // Unset address lines
    PORTF = 0x00;
    PORTK = 0x00;
 
-   // Set R/W back to HIGH
-   PORTE = (PORTE | 0x20);
-
-   // Set data pins to input
-   DDRA = 0x00;
+   return inputData;
 }
 
-uint8_t RPU_DataRead(int address) {
-   // Set data pins to input
-   DDRA = 0x00;
-
-   // Set R/W to HIGH
-   DDRE = DDRE | 0x20;
-   PORTE = (PORTE | 0x20);
+// Writes a run of bus operations with the data pins switched to output
+// (and R/W held low) once for the whole run instead of once per write
+void RPU_DataWriteBurst(const BusOp* ops, uint8_t numOps) {
+   // Set data pins to output
+   DDRA = 0xFF;
 
-   // Set up address lines
-   PORTF = (uint8_t)(address & 0x00FF);
-   PORTK = (uint8_t)(address / 256);
+   // Set R/W to LOW
+   PORTE = (PORTE & 0xDF);
 
-   if (UsesM6800Processor) {
-      // Wait for a falling edge of the clock
-      while ((PING & 0x04))
-         ;
-   } else {
-      // Set clock low
-      PORTG &= ~0x04;
-   }
+   for (uint8_t opCount = 0; opCount < numOps; opCount++) {
+      // Put data on pins
+      PORTA = ops[opCount].data;
 
-   // Pulse VMA over one clock cycle
-   // Set VMA ON
-   PORTG = PORTG | 0x02;
+      // Set up address lines
+      PORTF = (uint8_t)(ops[opCount].address & 0x00FF);
+      PORTK = (uint8_t)(ops[opCount].address / 256);
 
-   if (UsesM6800Processor) {
-      // Wait a full clock cycle to make sure data lines are ready
-      // (important for faster clocks)
-      // Wait while clock is low
-      while (!(PING & 0x04))
-         ;
+      if (UsesM6800Processor) {
+         // Wait for a falling edge of the clock
+         while ((PING & 0x04))
+            ;
+      } else {
+         // Set clock low (PG2) (if 6802/8)
+         PORTG &= ~0x04;
+      }
 
-      // Wait for a falling edge of the clock
-      while ((PING & 0x04))
-         ;
+      // Pulse VMA over one clock cycle
+      // Set VMA ON
+      PORTG = PORTG | 0x02;
 
-      // Wait while clock is low
-      while (!(PING & 0x04))
-         ;
-   } else {
-      // Set clock high
-      PORTG |= 0x04;
+      if (UsesM6800Processor) {
+         // Wait while clock is low
+         while (!(PING & 0x04))
+            ;
 
-      // Set clock low
-      PORTG &= ~0x04;
+         // Wait while clock is high
+         while ((PING & 0x04))
+            ;
 
-      // Set clock high
-      PORTG |= 0x04;
-   }
+         // Wait while clock is low
+         while (!(PING & 0x04))
+            ;
+      } else {
+         // Set clock high
+         PORTG |= 0x04;
 
-   uint8_t inputData;
-   inputData = PINA;
+         // Set clock low
+         PORTG &= ~0x04;
 
-   // Set VMA OFF
-   PORTG = PORTG & 0xFD;
+         // Set clock high
+         PORTG |= 0x04;
+      }
 
-   // Set R/W to LOW
-   PORTE = (PORTE & 0xDF);
+      // Set VMA OFF
+      PORTG = PORTG & 0xFD;
+   }
 
    // Unset address lines
    PORTF = 0x00;
    PORTK = 0x00;
 
-   return inputData;
+   // Set R/W back to HIGH
+   PORTE = (PORTE | 0x20);
+
+   // Set data pins to input
+   DDRA = 0x00;
 }
 
 #elif (RPU_OS_HARDWARE_REV == 100)
@@ -645,64 +744,6 @@ void RPU_SetDataPinsDirection(bool pinsOutput) {
 }
 
 // REV 100 HARDWARE
-void RPU_DataWrite(int address, uint8_t data) {
-   // Set data pins to output
-   DDRH = DDRH | 0x78;
-   DDRB = DDRB | 0x70;
-   DDRJ = DDRJ | 0x01;
-
-   // Set R/W to LOW
-   PORTE = (PORTE & 0xF7);
-
-   // Put data on pins
-   // Lower Nibble goes on PortH3 through H6
-   PORTH = (PORTH & 0x87) | ((data & 0x0F) << 3);
-   // Bits 4-6 go on PortB4 through B6
-   PORTB = (PORTB & 0x8F) | ((data & 0x70));
-   // Bit 7 goes on PortJ0
-   PORTJ = (PORTJ & 0xFE) | (data >> 7);
-
-   // Set up address lines
-   PORTH = (PORTH & 0xFC) | ((address & 0x0001) << 1) | ((address & 0x0002) >> 1); // A0-A1
-   PORTD = (PORTD & 0xF0) | ((address & 0x0004) << 1) | ((address & 0x0008) >> 1) | ((address & 0x0010) >> 3) |
-           ((address & 0x0020) >> 5);                                              // A2-A5
-   PORTA = ((address & 0x3FC0) >> 6);                                              // A6-A13
-   PORTC = (PORTC & 0x3F) | ((address & 0x4000) >> 7) | ((address & 0x8000) >> 9); // A14-A15
-
-   // Set clock low
-   PORTE &= ~0x20;
-
-   // Pulse VMA over one clock cycle
-   // Set VMA ON
-   PORTG = PORTG | 0x20;
-
-   // Set clock high
-   PORTE |= 0x20;
-
-   // Set clock low
-   PORTE &= ~0x20;
-
-   // Set clock high
-   PORTE |= 0x20;
-
-   // Set VMA OFF
-   PORTG = PORTG & 0xDF;
-
-   // Unset address lines
-   PORTH = (PORTH & 0xFC);
-   PORTD = (PORTD & 0xF0);
-   PORTA = 0;
-   PORTC = (PORTC & 0x3F);
-
-   // Set R/W back to HIGH
-   PORTE = (PORTE | 0x08);
-
-   // Set data pins to input
-   DDRH = DDRH & 0x87;
-   DDRB = DDRB & 0x8F;
-   DDRJ = DDRJ & 0xFE;
-}
-
 uint8_t RPU_DataRead(int address) {
    // Set data pins to input
    DDRH = DDRH & 0x87;
@@ -756,6 +797,71 @@ uint8_t RPU_DataRead(int address) {
    return inputData;
 }
 
+// Writes a run of bus operations with the data pins switched to output
+// (and R/W held low) once for the whole run instead of once per write
+void RPU_DataWriteBurst(const BusOp* ops, uint8_t numOps) {
+   // Set data pins to output
+   DDRH = DDRH | 0x78;
+   DDRB = DDRB | 0x70;
+   DDRJ = DDRJ | 0x01;
+
+   // Set R/W to LOW
+   PORTE = (PORTE & 0xF7);
+
+   for (uint8_t opCount = 0; opCount < numOps; opCount++) {
+      uint8_t data = ops[opCount].data;
+      uint16_t address = ops[opCount].address;
+
+      // Put data on pins
+      // Lower Nibble goes on PortH3 through H6
+      PORTH = (PORTH & 0x87) | ((data & 0x0F) << 3);
+      // Bits 4-6 go on PortB4 through B6
+      PORTB = (PORTB & 0x8F) | ((data & 0x70));
+      // Bit 7 goes on PortJ0
+      PORTJ = (PORTJ & 0xFE) | (data >> 7);
+
+      // Set up address lines
+      PORTH = (PORTH & 0xFC) | ((address & 0x0001) << 1) | ((address & 0x0002) >> 1); // A0-A1
+      PORTD = (PORTD & 0xF0) | ((address & 0x0004) << 1) | ((address & 0x0008) >> 1) | ((address & 0x0010) >> 3) |
+              ((address & 0x0020) >> 5);                                              // A2-A5
+      PORTA = ((address & 0x3FC0) >> 6);                                              // A6-A13
+      PORTC = (PORTC & 0x3F) | ((address & 0x4000) >> 7) | ((address & 0x8000) >> 9); // A14-A15
+
+      // Set clock low
+      PORTE &= ~0x20;
+
+      // Pulse VMA over one clock cycle
+      // Set VMA ON
+      PORTG = PORTG | 0x20;
+
+      // Set clock high
+      PORTE |= 0x20;
+
+      // Set clock low
+      PORTE &= ~0x20;
+
+      // Set clock high
+      PORTE |= 0x20;
+
+      // Set VMA OFF
+      PORTG = PORTG & 0xDF;
+   }
+
+   // Unset address lines
+   PORTH = (PORTH & 0xFC);
+   PORTD = (PORTD & 0xF0);
+   PORTA = 0;
+   PORTC = (PORTC & 0x3F);
+
+   // Set R/W back to HIGH
+   PORTE = (PORTE | 0x08);
+
+   // Set data pins to input
+   DDRH = DDRH & 0x87;
+   DDRB = DDRB & 0x8F;
+   DDRJ = DDRJ & 0xFE;
+}
+
 void WaitClockCycle(int numCycles = 1) {
    for (int count = 0; count < numCycles; count++) {
       // Wait while clock is low
@@ -805,15 +911,13 @@ void RPU_SetDataPinsDirection(bool pinsOutput) {
 }
 
 // REVISION 101/102 HARDWARE
-void RPU_DataWrite(int address, uint8_t data) {
-   // Set data pins to output
-   DDRA = 0xFF;
-
-   // Set R/W to LOW
-   PORTE = (PORTE & 0xDF);
+uint8_t RPU_DataRead(int address) {
+   // Set data pins to input
+   DDRA = 0x00;
 
-   // Put data on pins
-   PORTA = data;
+   // Set R/W to HIGH
+   DDRE = DDRE | 0x20;
+   PORTE = (PORTE | 0x20);
 
    // Set up address lines
    PORTF = (uint8_t)(address & 0x00FF);
@@ -824,7 +928,7 @@ void RPU_DataWrite(int address, uint8_t data) {
       while ((PING & 0x04))
          ;
    } else {
-      // Set clock low (PG2) (if 6802/8)
+      // Set clock low
       PORTG &= ~0x04;
    }
 
@@ -833,11 +937,13 @@ void RPU_DataWrite(int address, uint8_t data) {
    PORTG = PORTG | 0x02;
 
    if (UsesM6800Processor) {
+      // Wait a full clock cycle to make sure data lines are ready
+      // (important for faster clocks)
       // Wait while clock is low
       while (!(PING & 0x04))
          ;
 
-      // Wait while clock is high
+      // Wait for a falling edge of the clock
       while ((PING & 0x04))
          ;
 
@@ -855,9 +961,79 @@ void RPU_DataWrite(int address, uint8_t data) {
       PORTG |= 0x04;
    }
 
+   uint8_t inputData;
+   inputData = PINA;
+
    // Set VMA OFF
    PORTG = PORTG & 0xFD;
 
+   // Set R/W to LOW
+   PORTE = (PORTE & 0xDF);
+
+   // Unset address lines
+   PORTF = 0x00;
+   PORTK = 0x00;
+
+   return inputData;
+}
+
+// Writes a run of bus operations with the data pins switched to output
+// (and R/W held low) once for the whole run instead of once per write
+void RPU_DataWriteBurst(const BusOp* ops, uint8_t numOps) {
+   // Set data pins to output
+   DDRA = 0xFF;
+
+   // Set R/W to LOW
+   PORTE = (PORTE & 0xDF);
+
+   for (uint8_t opCount = 0; opCount < numOps; opCount++) {
+      // Put data on pins
+      PORTA = ops[opCount].data;
+
+      // Set up address lines
+      PORTF = (uint8_t)(ops[opCount].address & 0x00FF);
+      PORTK = (uint8_t)(ops[opCount].address / 256);
+
+      if (UsesM6800Processor) {
+         // Wait for a falling edge of the clock
+         while ((PING & 0x04))
+            ;
+      } else {
+         // Set clock low (PG2) (if 6802/8)
+         PORTG &= ~0x04;
+      }
+
+      // Pulse VMA over one clock cycle
+      // Set VMA ON
+      PORTG = PORTG | 0x02;
+
+      if (UsesM6800Processor) {
+         // Wait while clock is low
+         while (!(PING & 0x04))
+            ;
+
+         // Wait while clock is high
+         while ((PING & 0x04))
+            ;
+
+         // Wait while clock is low
+         while (!(PING & 0x04))
+            ;
+      } else {
+         // Set clock high
+         PORTG |= 0x04;
+
+         // Set clock low
+         PORTG &= ~0x04;
+
+         // Set clock high
+         PORTG |= 0x04;
+      }
+
+      // Set VMA OFF
+      PORTG = PORTG & 0xFD;
+   }
+
    // Unset address lines
    PORTF = 0x00;
    PORTK = 0x00;
@@ -869,84 +1045,117 @@ void RPU_DataWrite(int address, uint8_t data) {
    DDRA = 0x00;
 }
 
-uint8_t RPU_DataRead(int address) {
-   // Set data pins to input
-   DDRA = 0x00;
-
-   // Set R/W to HIGH
-   DDRE = DDRE | 0x20;
-   PORTE = (PORTE | 0x20);
-
-   // Set up address lines
-   PORTF = (uint8_t)(address & 0x00FF);
-   PORTK = (uint8_t)(address / 256);
+#else
+#error "RPU Hardware Definition Not Recognized"
+#endif
 
-   if (UsesM6800Processor) {
-      // Wait for a falling edge of the clock
-      while ((PING & 0x04))
-         ;
-   } else {
-      // Set clock low
-      PORTG &= ~0x04;
-   }
+#if !defined(RPU_OS_HOST_SIMULATION)
+// A single write is a burst of one, so each revision's port code
+// only lives in its RPU_DataWriteBurst
+void RPU_DataWrite(int address, uint8_t data) {
+   BusOp op = {(uint16_t)address, data};
+   RPU_DataWriteBurst(&op, 1);
+}
+#endif
 
-   // Pulse VMA over one clock cycle
-   // Set VMA ON
-   PORTG = PORTG | 0x02;
+#if (RPU_MPU_ARCHITECTURE < 10)
 
-   if (UsesM6800Processor) {
-      // Wait a full clock cycle to make sure data lines are ready
-      // (important for faster clocks)
-      // Wait while clock is low
-      while (!(PING & 0x04))
-         ;
+/******************************************************
+ *   PIA Shadow Registers
+ *
+ *   Every write to U10 and U11 goes through PIAWrite, which keeps a copy of
+ *   the control, data direction and output registers. Read-modify-write
+ *   sequences and backups use those copies instead of a bus read. Reads the
+ *   hardware answers (switch returns, IRQ flags, reading a data register to
+ *   clear its interrupt, RPU_TestPIAs) still go to the bus.
+ *   With RPU_OS_CHECK_PIA_SHADOWS defined, shadow reads also read the bus
+ *   and count any disagreement (see RPU_GetPIAShadowMismatches).
+ */
 
-      // Wait for a falling edge of the clock
-      while ((PING & 0x04))
-         ;
+#define PIA_CONTROL_WRITABLE_BITS 0x3F
+#define PIA_CONTROL_SELECT_DATA 0x04
 
-      // Wait while clock is low
-      while (!(PING & 0x04))
-         ;
-   } else {
-      // Set clock high
-      PORTG |= 0x04;
+struct PIAShadowSide {
+   uint8_t control;
+   uint8_t dataDirection;
+   uint8_t output;
+};
 
-      // Set clock low
-      PORTG &= ~0x04;
+// U10A, U10B, U11A, U11B
+PIAShadowSide PIAShadow[4];
+#if defined(RPU_OS_CHECK_PIA_SHADOWS)
+volatile unsigned long PIAShadowMismatches = 0;
+#endif
 
-      // Set clock high
-      PORTG |= 0x04;
+inline PIAShadowSide* GetPIAShadowSide(int address) {
+   uint8_t sideNum = (address & 0x02) ? 1 : 0;
+   if ((address & ~0x03) == ADDRESS_U11_A) {
+      sideNum += 2;
    }
+   return &PIAShadow[sideNum];
+}
 
-   uint8_t inputData;
-   inputData = PINA;
+inline void UpdatePIAShadow(int address, uint8_t data) {
+   PIAShadowSide* side = GetPIAShadowSide(address);
+   if (address & 0x01) {
+      side->control = data;
+   } else if (side->control & PIA_CONTROL_SELECT_DATA) {
+      side->output = data;
+   } else {
+      side->dataDirection = data;
+   }
+}
 
-   // Set VMA OFF
-   PORTG = PORTG & 0xFD;
+// The shadow is updated before the bus so that an interrupt landing in
+// between (which may restore a port from its shadow) sees the new value
+inline void PIAWrite(int address, uint8_t data) {
+   UpdatePIAShadow(address, data);
+   RPU_DataWrite(address, data);
+}
 
-   // Set R/W to LOW
-   PORTE = (PORTE & 0xDF);
+void PIAWriteBurst(const BusOp* ops, uint8_t numOps) {
+   for (uint8_t opCount = 0; opCount < numOps; opCount++) {
+      UpdatePIAShadow(ops[opCount].address, ops[opCount].data);
+   }
+   RPU_DataWriteBurst(ops, numOps);
+}
 
-   // Unset address lines
-   PORTF = 0x00;
-   PORTK = 0x00;
+uint8_t PIAShadowRead(int address) {
+   PIAShadowSide* side = GetPIAShadowSide(address);
+   uint8_t shadowValue = (address & 0x01) ? side->control : side->output;
+#if defined(RPU_OS_CHECK_PIA_SHADOWS)
+   // Control reads carry the IRQ flags in b6-b7 and data reads return the
+   // pins, so only the bits we drive are compared
+   uint8_t busValue = RPU_DataRead(address);
+   uint8_t compareMask = (address & 0x01) ? PIA_CONTROL_WRITABLE_BITS : side->dataDirection;
+   if ((busValue ^ shadowValue) & compareMask) {
+      PIAShadowMismatches += 1;
+   }
+#endif
+   return shadowValue;
+}
 
-   return inputData;
+// Puts 0xFF on U10A and pulses U10:CB2 so the lamp decoders latch the
+// parked address (without touching the interrupt flags)
+void ParkLampDecoders() {
+   uint8_t u10BControl = PIAShadowRead(ADDRESS_U10_B_CONTROL);
+   const BusOp parkOps[] = {
+      {ADDRESS_U10_A, 0xFF}, {ADDRESS_U10_B_CONTROL, (uint8_t)(u10BControl | 0x08)}, {ADDRESS_U10_B_CONTROL, (uint8_t)(u10BControl & 0xF7)}};
+   PIAWriteBurst(parkOps, sizeof(parkOps) / sizeof(BusOp));
 }
 
-#else
-#error "RPU Hardware Definition Not Recognized"
+#if defined(RPU_OS_CHECK_PIA_SHADOWS)
+unsigned long RPU_GetPIAShadowMismatches() {
+   return PIAShadowMismatches;
+}
 #endif
 
-#if (RPU_MPU_ARCHITECTURE < 10)
-
 void TestLightOn() {
-   RPU_DataWrite(ADDRESS_U11_A_CONTROL, RPU_DataRead(ADDRESS_U11_A_CONTROL) | 0x08);
+   PIAWrite(ADDRESS_U11_A_CONTROL, PIAShadowRead(ADDRESS_U11_A_CONTROL) | 0x08);
 }
 
 void TestLightOff() {
-   RPU_DataWrite(ADDRESS_U11_A_CONTROL, RPU_DataRead(ADDRESS_U11_A_CONTROL) & 0xF7);
+   PIAWrite(ADDRESS_U11_A_CONTROL, PIAShadowRead(ADDRESS_U11_A_CONTROL) & 0xF7);
 }
 
 void InitializeU10PIA() {
@@ -957,56 +1166,56 @@ void InitializeU10PIA() {
    // PA0-7 - output for switch bank, lamps, and BCD
    // PB0-7 - switch returns
 
-   RPU_DataWrite(ADDRESS_U10_A_CONTROL, 0x38);
+   PIAWrite(ADDRESS_U10_A_CONTROL, 0x38);
    // Set up U10A as output
-   RPU_DataWrite(ADDRESS_U10_A, 0xFF);
+   PIAWrite(ADDRESS_U10_A, 0xFF);
    // Set bit 3 to write data
-   RPU_DataWrite(ADDRESS_U10_A_CONTROL, RPU_DataRead(ADDRESS_U10_A_CONTROL) | 0x04);
+   PIAWrite(ADDRESS_U10_A_CONTROL, PIAShadowRead(ADDRESS_U10_A_CONTROL) | 0x04);
    // Store F0 in U10A Output
-   RPU_DataWrite(ADDRESS_U10_A, 0xF0);
+   PIAWrite(ADDRESS_U10_A, 0xF0);
 
-   RPU_DataWrite(ADDRESS_U10_B_CONTROL, 0x33);
+   PIAWrite(ADDRESS_U10_B_CONTROL, 0x33);
    // Set up U10B as input
-   RPU_DataWrite(ADDRESS_U10_B, 0x00);
+   PIAWrite(ADDRESS_U10_B, 0x00);
    // Set bit 3 so future reads will read data
-   RPU_DataWrite(ADDRESS_U10_B_CONTROL, RPU_DataRead(ADDRESS_U10_B_CONTROL) | 0x04);
+   PIAWrite(ADDRESS_U10_B_CONTROL, PIAShadowRead(ADDRESS_U10_B_CONTROL) | 0x04);
 }
 
 #ifdef RPU_OS_USE_DIP_SWITCHES
 void ReadDipSwitches() {
-   uint8_t backupU10A = RPU_DataRead(ADDRESS_U10_A);
-   uint8_t backupU10BControl = RPU_DataRead(ADDRESS_U10_B_CONTROL);
+   uint8_t backupU10A = PIAShadowRead(ADDRESS_U10_A);
+   uint8_t backupU10BControl = PIAShadowRead(ADDRESS_U10_B_CONTROL);
 
    // Turn on Switch strobe 5 & Read Switches
-   RPU_DataWrite(ADDRESS_U10_A, 0x20);
-   RPU_DataWrite(ADDRESS_U10_B_CONTROL, backupU10BControl & 0xF7);
+   PIAWrite(ADDRESS_U10_A, 0x20);
+   PIAWrite(ADDRESS_U10_B_CONTROL, backupU10BControl & 0xF7);
    // Wait for switch capacitors to charge
    delayMicroseconds(RPU_OS_SWITCH_DELAY_IN_MICROSECONDS);
    DipSwitches[0] = RPU_DataRead(ADDRESS_U10_B);
 
    // Turn on Switch strobe 6 & Read Switches
-   RPU_DataWrite(ADDRESS_U10_A, 0x40);
-   RPU_DataWrite(ADDRESS_U10_B_CONTROL, backupU10BControl & 0xF7);
+   PIAWrite(ADDRESS_U10_A, 0x40);
+   PIAWrite(ADDRESS_U10_B_CONTROL, backupU10BControl & 0xF7);
    // Wait for switch capacitors to charge
    delayMicroseconds(RPU_OS_SWITCH_DELAY_IN_MICROSECONDS);
    DipSwitches[1] = RPU_DataRead(ADDRESS_U10_B);
 
    // Turn on Switch strobe 7 & Read Switches
-   RPU_DataWrite(ADDRESS_U10_A, 0x80);
-   RPU_DataWrite(ADDRESS_U10_B_CONTROL, backupU10BControl & 0xF7);
+   PIAWrite(ADDRESS_U10_A, 0x80);
+   PIAWrite(ADDRESS_U10_B_CONTROL, backupU10BControl & 0xF7);
    // Wait for switch capacitors to charge
    delayMicroseconds(RPU_OS_SWITCH_DELAY_IN_MICROSECONDS);
    DipSwitches[2] = RPU_DataRead(ADDRESS_U10_B);
 
    // Turn on U10 CB2 (strobe 8) and read switches
-   RPU_DataWrite(ADDRESS_U10_A, 0x00);
-   RPU_DataWrite(ADDRESS_U10_B_CONTROL, backupU10BControl | 0x08);
+   PIAWrite(ADDRESS_U10_A, 0x00);
+   PIAWrite(ADDRESS_U10_B_CONTROL, backupU10BControl | 0x08);
    // Wait for switch capacitors to charge
    delayMicroseconds(RPU_OS_SWITCH_DELAY_IN_MICROSECONDS);
    DipSwitches[3] = RPU_DataRead(ADDRESS_U10_B);
 
-   RPU_DataWrite(ADDRESS_U10_B_CONTROL, backupU10BControl);
-   RPU_DataWrite(ADDRESS_U10_A, backupU10A);
+   PIAWrite(ADDRESS_U10_B_CONTROL, backupU10BControl);
+   PIAWrite(ADDRESS_U10_A, backupU10A);
 }
 #endif
 
@@ -1018,21 +1227,21 @@ void InitializeU11PIA() {
    // PA0-7 - display digit enable
    // PB0-7 - solenoid data
 
-   RPU_DataWrite(ADDRESS_U11_A_CONTROL, 0x31);
+   PIAWrite(ADDRESS_U11_A_CONTROL, 0x31);
    // Set up U11A as output
-   RPU_DataWrite(ADDRESS_U11_A, 0xFF);
+   PIAWrite(ADDRESS_U11_A, 0xFF);
    // Set bit 3 to write data
-   RPU_DataWrite(ADDRESS_U11_A_CONTROL, RPU_DataRead(ADDRESS_U11_A_CONTROL) | 0x04);
+   PIAWrite(ADDRESS_U11_A_CONTROL, PIAShadowRead(ADDRESS_U11_A_CONTROL) | 0x04);
    // Store 00 in U11A Output
-   RPU_DataWrite(ADDRESS_U11_A, 0x00);
+   PIAWrite(ADDRESS_U11_A, 0x00);
 
-   RPU_DataWrite(ADDRESS_U11_B_CONTROL, 0x30);
+   PIAWrite(ADDRESS_U11_B_CONTROL, 0x30);
    // Set up U11B as output
-   RPU_DataWrite(ADDRESS_U11_B, 0xFF);
+   PIAWrite(ADDRESS_U11_B, 0xFF);
    // Set bit 3 so future reads will read data
-   RPU_DataWrite(ADDRESS_U11_B_CONTROL, RPU_DataRead(ADDRESS_U11_B_CONTROL) | 0x04);
+   PIAWrite(ADDRESS_U11_B_CONTROL, PIAShadowRead(ADDRESS_U11_B_CONTROL) | 0x04);
    // Store 9F in U11B Output
-   RPU_DataWrite(ADDRESS_U11_B, DEFAULT_SOLENOID_STATE);
+   PIAWrite(ADDRESS_U11_B, DEFAULT_SOLENOID_STATE);
    CurrentSolenoidByte = DEFAULT_SOLENOID_STATE;
 }
 
@@ -1231,62 +1440,257 @@ void RPU_SetBoardLEDs(bool LED1, bool LED2, uint8_t BCDValue) {
  *   Switch Handling Functions
  */
 
-int SpaceLeftOnSwitchStack() {
-   if (SwitchStackFirst >= SWITCH_STACK_SIZE || SwitchStackLast >= SWITCH_STACK_SIZE) {
+#if defined(RPU_OS_TRACK_SWITCH_LATENCY)
+// Time from a switch going on the switch stack (in the interrupt, or from
+// RPU_PushToSwitchStack) to the game pulling it off, kept per switch.
+// Bucket limits are in microseconds - 16 ms is two zero crossing passes.
+#define SWITCH_LATENCY_NUM_BUCKETS 4
+const unsigned long SwitchLatencyBucketLimits[SWITCH_LATENCY_NUM_BUCKETS - 1] PROGMEM = {1000, 4000, 16000};
+
+struct SwitchLatency {
+   uint16_t buckets[SWITCH_LATENCY_NUM_BUCKETS];
+   uint16_t maxMicros; // saturates at 65535
+};
+
+SwitchLatency SwitchLatencies[MAX_NUM_SWITCHES];
+
+void RecordSwitchLatency(uint8_t switchNum, unsigned long latencyMicros) {
+   if (switchNum >= MAX_NUM_SWITCHES) {
+      return;
+   }
+   SwitchLatency* latency = &SwitchLatencies[switchNum];
+
+   uint8_t bucket = 0;
+   while (bucket < (SWITCH_LATENCY_NUM_BUCKETS - 1) && latencyMicros >= pgm_read_dword(&SwitchLatencyBucketLimits[bucket])) {
+      bucket += 1;
+   }
+   if (latency->buckets[bucket] != 0xFFFF) {
+      latency->buckets[bucket] += 1;
+   }
+   if (latencyMicros > latency->maxMicros) {
+      latency->maxMicros = (latencyMicros > 0xFFFF) ? 0xFFFF : latencyMicros;
+   }
+}
+
+void RPU_ResetSwitchLatency() {
+   memset(SwitchLatencies, 0, sizeof(SwitchLatencies));
+}
+
+uint16_t RPU_GetSwitchLatency(uint8_t switchNum, uint16_t* maxMicros) {
+   if (switchNum >= MAX_NUM_SWITCHES) {
+      *maxMicros = 0;
       return 0;
    }
-   if (SwitchStackLast >= SwitchStackFirst) {
-      return ((SWITCH_STACK_SIZE - 1) - (SwitchStackLast - SwitchStackFirst));
+   SwitchLatency* latency = &SwitchLatencies[switchNum];
+   unsigned long numPulls = 0;
+   for (uint8_t bucket = 0; bucket < SWITCH_LATENCY_NUM_BUCKETS; bucket++) {
+      numPulls += latency->buckets[bucket];
    }
-   return (SwitchStackFirst - SwitchStackLast) - 1;
+   *maxMicros = latency->maxMicros;
+   return (numPulls > 0xFFFF) ? 0xFFFF : numPulls;
 }
 
-void PushToSwitchStack(uint8_t switchNumber) {
-   // if ((switchNumber>=MAX_NUM_SWITCHES && switchNumber!=SW_SELF_TEST_SWITCH)) return;
-   if (switchNumber == SWITCH_STACK_EMPTY) {
+void RPU_DumpSwitchLatency() {
+   char buf[80];
+   Serial.write("Switch   <1ms   <4ms  <16ms    16+   max(us)\n");
+   for (uint8_t switchNum = 0; switchNum < MAX_NUM_SWITCHES; switchNum++) {
+      SwitchLatency* latency = &SwitchLatencies[switchNum];
+      if ((latency->buckets[0] | latency->buckets[1] | latency->buckets[2] | latency->buckets[3]) == 0) {
+         continue;
+      }
+      sprintf(buf, "%6d %6u %6u %6u %6u %9u\n", switchNum, latency->buckets[0], latency->buckets[1], latency->buckets[2],
+              latency->buckets[3], latency->maxMicros);
+      Serial.write(buf);
+   }
+}
+#endif
+
+#if defined(RPU_OS_RECORD_SWITCHES)
+// The interrupt keeps each change it sees here until RPU_Update hands it to
+// the writer (see RPU_StartSwitchRecording for the stream format)
+#define SWITCH_RECORD_RING_SIZE 32
+#define SWITCH_RECORD_OPENED 0x80
+#define SWITCH_RECORD_IDLE 0xFF
+#define SWITCH_RECORD_VERSION 1
+
+struct SwitchRecordEntry {
+   uint16_t scanNumber;
+   uint8_t switchCode;
+};
+
+RPURing<SwitchRecordEntry, SWITCH_RECORD_RING_SIZE> SwitchRecordRing;
+volatile uint16_t SwitchScanNumber = 0;
+volatile bool SwitchMatrixScanned = false;
+volatile RPUSwitchRecordWriter SwitchRecordWriter = NULL;
+volatile RPUSwitchScanHook SwitchScanHook = NULL;
+uint16_t SwitchRecordLastScan = 0;
+
+// Called from the interrupt
+void RecordSwitchEvent(uint8_t switchCode) {
+   if (SwitchRecordWriter == NULL) {
+      return;
+   }
+   SwitchRecordEntry newEntry;
+   newEntry.scanNumber = SwitchScanNumber;
+   newEntry.switchCode = switchCode;
+   SwitchRecordRing.Push(newEntry);
+}
+
+// Called from the interrupt with a switch byte that's different from the last scan
+void RecordSwitchChanges(uint8_t switchByte, uint8_t previousSwitches, uint8_t currentSwitches) {
+   // The first scan is compared against the power-up values (every switch
+   // closed), so it's not a real change
+   if (!SwitchMatrixScanned) {
+      return;
+   }
+   uint8_t changes = previousSwitches ^ currentSwitches;
+   for (uint8_t bitCount = 0; changes; bitCount++) {
+      if (changes & 0x01) {
+         RecordSwitchEvent((switchByte * 8 + bitCount) | ((currentSwitches & 0x01) ? 0 : SWITCH_RECORD_OPENED));
+      }
+      changes = changes >> 1;
+      currentSwitches = currentSwitches >> 1;
+   }
+}
+
+void RPU_StartSwitchRecording(RPUSwitchRecordWriter writer) {
+   noInterrupts();
+   SwitchRecordWriter = NULL;
+   SwitchRecordRing.Clear();
+   SwitchRecordLastScan = SwitchScanNumber;
+   interrupts();
+
+   uint8_t header[5] = {'R', 'S', SWITCH_RECORD_VERSION, (uint8_t)(SwitchRecordLastScan & 0xFF), (uint8_t)(SwitchRecordLastScan >> 8)};
+   writer(header, sizeof(header));
+   SwitchRecordWriter = writer;
+}
+
+void RPU_StopSwitchRecording() {
+   RPU_UpdateSwitchRecording();
+   SwitchRecordWriter = NULL;
+}
+
+void RPU_UpdateSwitchRecording() {
+   RPUSwitchRecordWriter writer = SwitchRecordWriter;
+   if (writer == NULL) {
       return;
    }
 
-   // If the switch stack last index is out of range, then it's an error - return
-   if (SpaceLeftOnSwitchStack() == 0) {
+   // Read the scan first, so anything recorded after this is from that
+   // scan or later
+   noInterrupts();
+   uint16_t curScan = SwitchScanNumber;
+   interrupts();
+
+   // Whenever the buffer is flushed there's room left for an event and an
+   // idle marker
+   uint8_t buf[16];
+   uint8_t numBytes = 0;
+   SwitchRecordEntry entry;
+   while (SwitchRecordRing.Pop(&entry)) {
+      uint16_t deltaScans = entry.scanNumber - SwitchRecordLastScan;
+      while (deltaScans >= SWITCH_RECORD_IDLE) {
+         if (numBytes >= sizeof(buf) - 2) {
+            writer(buf, numBytes);
+            numBytes = 0;
+         }
+         buf[numBytes++] = SWITCH_RECORD_IDLE;
+         deltaScans -= SWITCH_RECORD_IDLE;
+      }
+      if (numBytes >= sizeof(buf) - 2) {
+         writer(buf, numBytes);
+         numBytes = 0;
+      }
+      buf[numBytes++] = (uint8_t)deltaScans;
+      buf[numBytes++] = entry.switchCode;
+      SwitchRecordLastScan = entry.scanNumber;
+   }
+
+   // Mark the quiet stretches as they go by so the scan deltas never wrap
+   if ((int16_t)(curScan - SwitchRecordLastScan) >= SWITCH_RECORD_IDLE) {
+      buf[numBytes++] = SWITCH_RECORD_IDLE;
+      SwitchRecordLastScan += SWITCH_RECORD_IDLE;
+   }
+
+   if (numBytes) {
+      writer(buf, numBytes);
+   }
+}
+
+uint16_t RPU_GetSwitchScanNumber() {
+   noInterrupts();
+   uint16_t scanNumber = SwitchScanNumber;
+   interrupts();
+   return scanNumber;
+}
+
+unsigned long RPU_GetSwitchRecordDrops() {
+   return SwitchRecordRing.GetNumDropped();
+}
+
+void RPU_SetSwitchScanHook(RPUSwitchScanHook hook) {
+   SwitchScanHook = hook;
+}
+
+// Called from the interrupt
+void RunSwitchScanHook() {
+   RPUSwitchScanHook hook = SwitchScanHook;
+   if (hook != NULL) {
+      hook(SwitchScanNumber);
+   }
+}
+#endif
+
+// Called from the interrupt (see RPU_PushToSwitchStack for the main loop)
+void PushToSwitchStack(uint8_t switchNumber) {
+   // if ((switchNumber>=MAX_NUM_SWITCHES && switchNumber!=SW_SELF_TEST_SWITCH)) return;
+   if (switchNumber == SWITCH_STACK_EMPTY) {
       return;
    }
 
    // Self test is a special case - there's no good way to debounce it
    // so if it's already first on the stack, ignore it
    if (switchNumber == SW_SELF_TEST_SWITCH) {
-      if (SwitchStackLast != SwitchStackFirst && SwitchStack[SwitchStackFirst] == SW_SELF_TEST_SWITCH) {
+      if (!SwitchStack.IsEmpty() && SwitchStack.Front().switchNumber == SW_SELF_TEST_SWITCH) {
          return;
       }
    }
 
-   SwitchStack[SwitchStackLast] = switchNumber;
-
-   SwitchStackLast += 1;
-   if (SwitchStackLast == SWITCH_STACK_SIZE) {
-      // If the end index is off the end, then wrap
-      SwitchStackLast = 0;
-   }
+   SwitchStackEntry newEntry;
+   newEntry.switchNumber = switchNumber;
+#if defined(RPU_OS_TRACK_SWITCH_LATENCY)
+   newEntry.pushMicros = micros();
+#endif
+   SwitchStack.Push(newEntry);
 }
 
 void RPU_PushToSwitchStack(uint8_t switchNumber) {
+   // The interrupt pushes switches too, so keep it out while we push
+   noInterrupts();
    PushToSwitchStack(switchNumber);
+   interrupts();
 }
 
 uint8_t RPU_PullFirstFromSwitchStack() {
-   // If first and last are equal, there's nothing on the stack
-   if (SwitchStackFirst == SwitchStackLast) {
+   SwitchStackEntry firstEntry;
+   if (!SwitchStack.Pop(&firstEntry)) {
       return SWITCH_STACK_EMPTY;
    }
+#if defined(RPU_OS_TRACK_SWITCH_LATENCY)
+   RecordSwitchLatency(firstEntry.switchNumber, micros() - firstEntry.pushMicros);
+#endif
+   return firstEntry.switchNumber;
+}
 
-   uint8_t retVal = SwitchStack[SwitchStackFirst];
-
-   SwitchStackFirst += 1;
-   if (SwitchStackFirst >= SWITCH_STACK_SIZE) {
-      SwitchStackFirst = 0;
-   }
+uint8_t RPU_GetSwitchStackPeak() {
+   return SwitchStack.GetPeakCount();
+}
 
-   return retVal;
+unsigned long RPU_GetSwitchStackDrops() {
+   noInterrupts();
+   unsigned long numDrops = SwitchStack.GetNumDropped();
+   interrupts();
+   return numDrops;
 }
 
 bool RPU_ReadSingleSwitchState(uint8_t switchNum) {
@@ -1314,10 +1718,41 @@ uint8_t RPU_GetDipSwitches(uint8_t index) {
 #endif
 }
 
-void RPU_SetupGameSwitches(int s_numSwitches, int s_numPrioritySwitches, const PlayfieldAndCabinetSwitch* s_gameSwitchArray) {
+void RPU_SetupGameSwitches(int s_numSwitches, int s_numPrioritySwitches, const PlayfieldAndCabinetSwitch* s_gameSwitchArray,
+                           bool s_arrayInProgmem) {
    NumGameSwitches = s_numSwitches;
    NumGamePrioritySwitches = s_numPrioritySwitches;
    GameSwitches = s_gameSwitchArray;
+
+   noInterrupts();
+   for (uint8_t byteNum = 0; byteNum < NUM_SWITCH_BYTES; byteNum++) {
+      TriggeredSwitchMask[byteNum] = 0;
+      PrioritySwitchMask[byteNum] = 0;
+   }
+   for (int count = 0; GameSwitches && count < NumGameSwitches; count++) {
+      PlayfieldAndCabinetSwitch gameSwitch;
+      if (s_arrayInProgmem) {
+         memcpy_P(&gameSwitch, &GameSwitches[count], sizeof(gameSwitch));
+      } else {
+         gameSwitch = GameSwitches[count];
+      }
+      uint8_t switchNum = gameSwitch.switchNum;
+      if (switchNum >= MAX_NUM_SWITCHES || gameSwitch.solenoid == SOL_NONE) {
+         continue;
+      }
+      uint8_t switchBit = 1 << (switchNum % 8);
+      // Only one trigger per switch - the first entry wins
+      if (TriggeredSwitchMask[switchNum / 8] & switchBit) {
+         continue;
+      }
+      SwitchTriggers[switchNum].solenoid = gameSwitch.solenoid;
+      SwitchTriggers[switchNum].solenoidHoldTime = gameSwitch.solenoidHoldTime;
+      TriggeredSwitchMask[switchNum / 8] |= switchBit;
+      if (count < NumGamePrioritySwitches) {
+         PrioritySwitchMask[switchNum / 8] |= switchBit;
+      }
+   }
+   interrupts();
 }
 
 #if (RPU_MPU_ARCHITECTURE < 10)
@@ -1342,17 +1777,8 @@ bool RPU_GetUpDownSwitchState() {
  *   Solenoid Handling Functions
  */
 
-int SpaceLeftOnSolenoidStack() {
-   if (SolenoidStackFirst >= SOLENOID_STACK_SIZE || SolenoidStackLast >= SOLENOID_STACK_SIZE) {
-      return 0;
-   }
-   if (SolenoidStackLast >= SolenoidStackFirst) {
-      return ((SOLENOID_STACK_SIZE - 1) - (SolenoidStackLast - SolenoidStackFirst));
-   }
-   return (SolenoidStackFirst - SolenoidStackLast) - 1;
-}
-
-void RPU_PushToSolenoidStack(uint8_t solenoidNumber, uint8_t numPushes, bool disableOverride) {
+// Called from the interrupt (see RPU_PushToSolenoidStack for the main loop)
+void PushToSolenoidStack(uint8_t solenoidNumber, uint8_t numPushes, bool disableOverride) {
    if (solenoidNumber >= RPU_NUM_SOLENOIDS) {
       return;
    }
@@ -1362,85 +1788,90 @@ void RPU_PushToSolenoidStack(uint8_t solenoidNumber, uint8_t numPushes, bool dis
       return;
    }
 
-   // If the solenoid stack last index is out of range, then it's an error - return
-   if (SpaceLeftOnSolenoidStack() == 0) {
+   if (numPushes == 0) {
       return;
    }
 
-   for (int count = 0; count < numPushes; count++) {
-      SolenoidStack[SolenoidStackLast] = solenoidNumber;
+   SolenoidStackEntry newEntry;
+   newEntry.solenoid = solenoidNumber;
+   newEntry.remainingCycles = numPushes;
+   SolenoidStack.Push(newEntry);
+}
 
-      SolenoidStackLast += 1;
-      if (SolenoidStackLast == SOLENOID_STACK_SIZE) {
-         // If the end index is off the end, then wrap
-         SolenoidStackLast = 0;
-      }
-      // If the stack is now full, return
-      if (SpaceLeftOnSolenoidStack() == 0) {
-         return;
-      }
-   }
+void RPU_PushToSolenoidStack(uint8_t solenoidNumber, uint8_t numPushes, bool disableOverride) {
+   // The interrupt pushes triggered solenoids too, so keep it out while we push
+   noInterrupts();
+   PushToSolenoidStack(solenoidNumber, numPushes, disableOverride);
+   interrupts();
 }
 
+// Only called from the interrupt
 void PushToFrontOfSolenoidStack(uint8_t solenoidNumber, uint8_t numPushes) {
-   // If the stack is full, return
-   if (SpaceLeftOnSolenoidStack() == 0 || !SolenoidStackEnabled) {
+   if (numPushes == 0 || !SolenoidStackEnabled) {
       return;
    }
 
-   for (int count = 0; count < numPushes; count++) {
-      if (SolenoidStackFirst == 0) {
-         SolenoidStackFirst = SOLENOID_STACK_SIZE - 1;
-      } else {
-         SolenoidStackFirst -= 1;
-      }
-      SolenoidStack[SolenoidStackFirst] = solenoidNumber;
-      if (SpaceLeftOnSolenoidStack() == 0) {
+   // If this solenoid is already firing, just keep it on longer
+   if (!SolenoidStack.IsEmpty()) {
+      SolenoidStackEntry& firstEntry = SolenoidStack.Front();
+      if (firstEntry.solenoid == solenoidNumber && firstEntry.remainingCycles <= (0xFF - numPushes)) {
+         firstEntry.remainingCycles += numPushes;
          return;
       }
    }
+
+   SolenoidStackEntry newEntry;
+   newEntry.solenoid = solenoidNumber;
+   newEntry.remainingCycles = numPushes;
+   SolenoidStack.PushFront(newEntry);
 }
 
 uint8_t PullFirstFromSolenoidStack() {
-   // If first and last are equal, there's nothing on the stack
-   if (SolenoidStackFirst == SolenoidStackLast) {
+   if (SolenoidStack.IsEmpty()) {
       return SOLENOID_STACK_EMPTY;
    }
 
-   uint8_t retVal = SolenoidStack[SolenoidStackFirst];
-
-   SolenoidStackFirst += 1;
-   if (SolenoidStackFirst >= SOLENOID_STACK_SIZE) {
-      SolenoidStackFirst = 0;
+   // Move on to the next entry once this one has used up its cycles
+   SolenoidStackEntry& firstEntry = SolenoidStack.Front();
+   uint8_t retVal = firstEntry.solenoid;
+   firstEntry.remainingCycles -= 1;
+   if (firstEntry.remainingCycles == 0) {
+      SolenoidStack.PopFront();
    }
 
    return retVal;
 }
 
+uint8_t RPU_GetSolenoidStackPeak() {
+   return SolenoidStack.GetPeakCount();
+}
+
+unsigned long RPU_GetSolenoidStackDrops() {
+   noInterrupts();
+   unsigned long numDrops = SolenoidStack.GetNumDropped();
+   interrupts();
+   return numDrops;
+}
+
 bool RPU_PushToTimedSolenoidStack(uint8_t solenoidNumber, uint8_t numPushes, unsigned long whenToFire, bool disableOverride) {
-   for (int count = 0; count < TIMED_SOLENOID_STACK_SIZE; count++) {
-      if (!TimedSolenoidStack[count].inUse) {
-         TimedSolenoidStack[count].inUse = true;
-         TimedSolenoidStack[count].pushTime = whenToFire;
-         TimedSolenoidStack[count].disableOverride = disableOverride;
-         TimedSolenoidStack[count].solenoidNumber = solenoidNumber;
-         TimedSolenoidStack[count].numPushes = numPushes;
-         return true;
-      }
-   }
-   return false;
+   TimedSolenoidEntry newEntry;
+   newEntry.solenoidNumber = solenoidNumber;
+   newEntry.numPushes = numPushes;
+   newEntry.disableOverride = disableOverride;
+   return TimedSolenoidStack.Push(newEntry, whenToFire);
 }
 
 void RPU_UpdateTimedSolenoidStack(unsigned long curTime) {
-   for (int count = 0; count < TIMED_SOLENOID_STACK_SIZE; count++) {
-      if (TimedSolenoidStack[count].inUse && TimedSolenoidStack[count].pushTime < curTime) {
-         RPU_PushToSolenoidStack(TimedSolenoidStack[count].solenoidNumber, TimedSolenoidStack[count].numPushes,
-                                 TimedSolenoidStack[count].disableOverride);
-         TimedSolenoidStack[count].inUse = false;
-      }
+   TimedSolenoidEntry dueEntry;
+   while (TimedSolenoidStack.PopDue(curTime, &dueEntry)) {
+      RPU_PushToSolenoidStack(dueEntry.solenoidNumber, dueEntry.numPushes, dueEntry.disableOverride);
    }
 }
 
+unsigned long RPU_GetTimedSolenoidStackDrops() {
+   return TimedSolenoidStack.GetNumDropped();
+}
+
 #if (RPU_MPU_ARCHITECTURE < 10)
 
 void RPU_SetCoinLockout(bool lockoutOff, uint8_t solbit) {
@@ -1449,7 +1880,7 @@ void RPU_SetCoinLockout(bool lockoutOff, uint8_t solbit) {
    } else {
       CurrentSolenoidByte = CurrentSolenoidByte | solbit;
    }
-   RPU_DataWrite(ADDRESS_U11_B, CurrentSolenoidByte);
+   PIAWrite(ADDRESS_U11_B, CurrentSolenoidByte);
 }
 
 void RPU_SetDisableFlippers(bool disableFlippers, uint8_t solbit) {
@@ -1459,7 +1890,7 @@ void RPU_SetDisableFlippers(bool disableFlippers, uint8_t solbit) {
       CurrentSolenoidByte = CurrentSolenoidByte & ~solbit;
    }
 
-   RPU_DataWrite(ADDRESS_U11_B, CurrentSolenoidByte);
+   PIAWrite(ADDRESS_U11_B, CurrentSolenoidByte);
 }
 
 void RPU_SetContinuousSolenoidBit(bool bitOn, uint8_t solbit) {
@@ -1468,7 +1899,7 @@ void RPU_SetContinuousSolenoidBit(bool bitOn, uint8_t solbit) {
    } else {
       CurrentSolenoidByte = CurrentSolenoidByte & ~solbit;
    }
-   RPU_DataWrite(ADDRESS_U11_B, CurrentSolenoidByte);
+   PIAWrite(ADDRESS_U11_B, CurrentSolenoidByte);
 }
 
 bool RPU_FireContinuousSolenoid(uint8_t solBit, uint8_t numCyclesToFire) {
@@ -1484,7 +1915,7 @@ bool RPU_FireContinuousSolenoid(uint8_t solBit, uint8_t numCyclesToFire) {
 }
 
 uint8_t RPU_ReadContinuousSolenoids() {
-   return RPU_DataRead(ADDRESS_U11_B);
+   return PIAShadowRead(ADDRESS_U11_B);
 }
 
 void RPU_DisableSolenoidStack() {
@@ -1545,11 +1976,110 @@ void RPU_EnableSolenoidStack() {
 
 #endif
 
+/******************************************************
+ *   Packed BCD Functions
+ */
+const unsigned long BCDPlaceValues[7] PROGMEM = {10000000, 1000000, 100000, 10000, 1000, 100, 10};
+
+RPUBCD RPU_BCDFromValue(unsigned long value) {
+   if (value > RPU_BCD_MAX_VALUE) {
+      return 0x99999999;
+   }
+
+   // Each digit is at most 9 subtractions, which is a lot cheaper than a divide
+   RPUBCD bcd = 0;
+   for (uint8_t place = 0; place < 7; place++) {
+      unsigned long placeValue = pgm_read_dword(&BCDPlaceValues[place]);
+      uint8_t digit = 0;
+      while (value >= placeValue) {
+         value -= placeValue;
+         digit += 1;
+      }
+      bcd = (bcd << 4) | digit;
+   }
+   return (bcd << 4) | value;
+}
+
+unsigned long RPU_BCDToValue(RPUBCD bcd) {
+   unsigned long value = 0;
+   for (uint8_t nibble = 0; nibble < 8; nibble++) {
+      value = value * 10 + (bcd >> 28);
+      bcd = bcd << 4;
+   }
+   return value;
+}
+
+RPUBCD RPU_BCDAdd(RPUBCD bcd1, RPUBCD bcd2) {
+   // Add with every digit biased by 6 so a digit that reaches 10 carries
+   // into the next nibble, then take the 6 back out of the digits that
+   // didn't carry
+   RPUBCD biased = bcd1 + 0x66666666;
+   RPUBCD sum = biased + bcd2;
+   if (sum < biased) {
+      // Carried out of the top digit
+      return 0x99999999;
+   }
+   RPUBCD noCarries = ~(sum ^ biased ^ bcd2) & 0x11111110;
+   return sum - (((noCarries >> 2) | (noCarries >> 3)) | 0x60000000);
+}
+
+uint8_t RPU_BCDMagnitude(RPUBCD bcd) {
+   uint8_t magnitude = 0;
+   while (bcd) {
+      bcd = bcd >> 4;
+      magnitude += 1;
+   }
+   return magnitude;
+}
+
+// Packs the bottom 8 digits of a value. If there are more digits than
+// that, the top nibble is left non-zero so the displays (7 digits at
+// most) still show leading zeros the way RPU_SetDisplay always has.
+RPUBCD DisplayValueToBCD(unsigned long value) {
+   if (value > RPU_BCD_MAX_VALUE) {
+      return RPU_BCDFromValue(value % (RPU_BCD_MAX_VALUE + 1UL)) | 0x10000000;
+   }
+   return RPU_BCDFromValue(value);
+}
+
 /******************************************************
  *   Display Handling Functions
  */
-#if (RPU_MPU_ARCHITECTURE < 15)
+
+// Effects that RPU_UpdateDisplayEffects animates on the score displays
+#define RPU_NUM_EFFECT_DISPLAYS 4
+struct DisplayEffect {
+   unsigned long value;
+   unsigned long startTime;
+   unsigned long nextStepTime;
+   unsigned int stepTime;
+   uint8_t effect;
+   uint8_t minDigits;
+   bool needsRender;
+};
+DisplayEffect DisplayEffects[RPU_NUM_EFFECT_DISPLAYS];
+
+// Anything that sets a display directly takes it over from its effect
+void StopDisplayEffect(int displayNumber) {
+   if (displayNumber >= 0 && displayNumber < RPU_NUM_EFFECT_DISPLAYS) {
+      DisplayEffects[displayNumber].effect = RPU_DISPLAY_EFFECT_NONE;
+   }
+}
+
+uint8_t ShowDisplayBCD(int displayNumber, RPUBCD value, bool blankByMagnitude, uint8_t minDigits, bool showCommasByMagnitude);
+
 uint8_t RPU_SetDisplay(int displayNumber, unsigned long value, bool blankByMagnitude, uint8_t minDigits, bool showCommasByMagnitude) {
+   StopDisplayEffect(displayNumber);
+   return ShowDisplayBCD(displayNumber, DisplayValueToBCD(value), blankByMagnitude, minDigits, showCommasByMagnitude);
+}
+
+uint8_t RPU_SetDisplayBCD(int displayNumber, RPUBCD value, bool blankByMagnitude, uint8_t minDigits, bool showCommasByMagnitude) {
+   StopDisplayEffect(displayNumber);
+   return ShowDisplayBCD(displayNumber, value, blankByMagnitude, minDigits, showCommasByMagnitude);
+}
+
+#if (RPU_MPU_ARCHITECTURE < 15)
+uint8_t ShowDisplayBCD(int displayNumber, RPUBCD value, bool blankByMagnitude, uint8_t minDigits, bool showCommasByMagnitude) {
    if (displayNumber < 0 || displayNumber > 4) {
       return 0;
    }
@@ -1586,12 +2116,12 @@ uint8_t RPU_SetDisplay(int displayNumber, unsigned long value, bool blankByMagni
 #else
       (void)showCommasByMagnitude;
 #endif
-      DisplayDigits[displayNumber][(RPU_OS_NUM_DIGITS - 1) - count] = value % 10;
-      value /= 10;
+      DrawFrame->DisplayDigits[displayNumber][(RPU_OS_NUM_DIGITS - 1) - count] = value & 0x0F;
+      value = value >> 4;
    }
 
    if (blankByMagnitude) {
-      DisplayDigitEnable[displayNumber] = blank;
+      DrawFrame->DisplayDigitEnable[displayNumber] = blank;
    }
 
    return blank;
@@ -1601,13 +2131,13 @@ uint8_t RPU_SetDisplay(int displayNumber, unsigned long value, bool blankByMagni
 #if (RPU_MPU_ARCHITECTURE < 10)
 void RPU_SetDisplayCredits(int value, bool displayOn, bool showBothDigits) {
 #ifdef RPU_OS_USE_6_DIGIT_CREDIT_DISPLAY_WITH_7_DIGIT_DISPLAYS
-   DisplayDigits[4][2] = (value % 100) / 10;
-   DisplayDigits[4][3] = (value % 10);
+   DrawFrame->DisplayDigits[4][2] = (value % 100) / 10;
+   DrawFrame->DisplayDigits[4][3] = (value % 10);
 #else
-   DisplayDigits[4][1] = (value % 100) / 10;
-   DisplayDigits[4][2] = (value % 10);
+   DrawFrame->DisplayDigits[4][1] = (value % 100) / 10;
+   DrawFrame->DisplayDigits[4][2] = (value % 10);
 #endif
-   uint8_t enableMask = DisplayDigitEnable[4] & RPU_OS_MASK_SHIFT_1;
+   uint8_t enableMask = DrawFrame->DisplayDigitEnable[4] & RPU_OS_MASK_SHIFT_1;
 
    if (displayOn) {
       if (value > 9 || showBothDigits) {
@@ -1617,18 +2147,18 @@ void RPU_SetDisplayCredits(int value, bool displayOn, bool showBothDigits) {
       }
    }
 
-   DisplayDigitEnable[4] = enableMask;
+   DrawFrame->DisplayDigitEnable[4] = enableMask;
 }
 
 void RPU_SetDisplayBallInPlay(int value, bool displayOn, bool showBothDigits) {
 #ifdef RPU_OS_USE_6_DIGIT_CREDIT_DISPLAY_WITH_7_DIGIT_DISPLAYS
-   DisplayDigits[4][5] = (value % 100) / 10;
-   DisplayDigits[4][6] = (value % 10);
+   DrawFrame->DisplayDigits[4][5] = (value % 100) / 10;
+   DrawFrame->DisplayDigits[4][6] = (value % 10);
 #else
-   DisplayDigits[4][4] = (value % 100) / 10;
-   DisplayDigits[4][5] = (value % 10);
+   DrawFrame->DisplayDigits[4][4] = (value % 100) / 10;
+   DrawFrame->DisplayDigits[4][5] = (value % 10);
 #endif
-   uint8_t enableMask = DisplayDigitEnable[4] & RPU_OS_MASK_SHIFT_2;
+   uint8_t enableMask = DrawFrame->DisplayDigitEnable[4] & RPU_OS_MASK_SHIFT_2;
 
    if (displayOn) {
       if (value > 9 || showBothDigits) {
@@ -1638,7 +2168,7 @@ void RPU_SetDisplayBallInPlay(int value, bool displayOn, bool showBothDigits) {
       }
    }
 
-   DisplayDigitEnable[4] = enableMask;
+   DrawFrame->DisplayDigitEnable[4] = enableMask;
 }
 
 #elif (RPU_MPU_ARCHITECTURE < 15)
@@ -1741,19 +2271,24 @@ void RPU_SetDisplayMatch(int value, bool displayOn, bool showBothDigits) {
 // so, looking at it from left to right on the display
 //   digit=  1  2  3  4  5  6
 //   bit=   b0 b1 b2 b3 b4 b5
-void RPU_SetDisplayBlank(int displayNumber, uint8_t bitMask) {
+void ShowDisplayBlank(int displayNumber, uint8_t bitMask) {
    if (displayNumber < 0 || displayNumber > 4) {
       return;
    }
 
-   DisplayDigitEnable[displayNumber] = bitMask;
+   DrawFrame->DisplayDigitEnable[displayNumber] = bitMask;
+}
+
+void RPU_SetDisplayBlank(int displayNumber, uint8_t bitMask) {
+   StopDisplayEffect(displayNumber);
+   ShowDisplayBlank(displayNumber, bitMask);
 }
 
 uint8_t RPU_GetDisplayBlank(int displayNumber) {
    if (displayNumber < 0 || displayNumber > 4) {
       return 0;
    }
-   return DisplayDigitEnable[displayNumber];
+   return DrawFrame->DisplayDigitEnable[displayNumber];
 }
 
 #if defined(RPU_OS_ADJUSTABLE_DISPLAY_INTERRUPT)
@@ -1789,10 +2324,194 @@ void RPU_SetDisplayFlash(int displayNumber, unsigned long value, unsigned long c
 void RPU_SetDisplayFlashCredits(unsigned long curTime, int period) {
    if (period) {
       if ((curTime / period) % 2) {
-         DisplayDigitEnable[4] |= 0x06;
+         DrawFrame->DisplayDigitEnable[4] |= 0x06;
+      } else {
+         DrawFrame->DisplayDigitEnable[4] &= 0x39;
+      }
+   }
+}
+
+/******************************************************
+ *   Display Effects
+ */
+// Digits in the value as the displays render it (anything past 8 digits
+// counts as 8, see DisplayValueToBCD)
+inline uint8_t DisplayValueMagnitude(unsigned long value) {
+   return RPU_BCDMagnitude(DisplayValueToBCD(value));
+}
+
+// Enable bits for the rightmost numDigits digits
+uint8_t DisplayMaskForDigits(uint8_t numDigits) {
+   uint8_t displayMask = 0;
+   for (uint8_t digitCount = 0; digitCount < numDigits; digitCount++) {
+      displayMask |= ((0x01 << (RPU_OS_NUM_DIGITS - 1)) >> digitCount);
+   }
+   return displayMask;
+}
+
+void ShowDisplayValue(int displayNumber, unsigned long value, bool blankByMagnitude, uint8_t minDigits = 2) {
+   ShowDisplayBCD(displayNumber, DisplayValueToBCD(value), blankByMagnitude, minDigits, false);
+}
+
+void RenderDisplayEffect(int displayNumber, DisplayEffect* effect, unsigned long step) {
+   unsigned long value = effect->value;
+
+   switch (effect->effect) {
+   case RPU_DISPLAY_EFFECT_STATIC:
+      ShowDisplayValue(displayNumber, value, true, effect->minDigits);
+      break;
+
+   case RPU_DISPLAY_EFFECT_OFF:
+      ShowDisplayBlank(displayNumber, 0x00);
+      break;
+
+   case RPU_DISPLAY_EFFECT_FLASH:
+      if ((step % 2) == 0) {
+         ShowDisplayBlank(displayNumber, 0x00);
+      } else {
+         ShowDisplayValue(displayNumber, value, true, effect->minDigits);
+      }
+      break;
+
+   case RPU_DISPLAY_EFFECT_DASH: {
+      // Wipe the digits off from the left and back on from the right,
+      // then show the value for the rest of the 36 steps
+      uint8_t dashPhase = step % 36;
+      if (dashPhase < 12) {
+         uint8_t numDigits = DisplayValueMagnitude(value);
+         uint8_t displayMask = DisplayMaskForDigits((numDigits == 0) ? 2 : numDigits);
+         if (dashPhase < 7) {
+            for (uint8_t maskCount = 0; maskCount < dashPhase; maskCount++) {
+               displayMask &= ~(0x01 << maskCount);
+            }
+         } else {
+            for (uint8_t maskCount = 12; maskCount > dashPhase; maskCount--) {
+               displayMask &= ~((0x01 << (RPU_OS_NUM_DIGITS - 1)) >> (maskCount - dashPhase - 1));
+            }
+         }
+         ShowDisplayValue(displayNumber, value, false);
+         ShowDisplayBlank(displayNumber, displayMask);
+      } else {
+         ShowDisplayValue(displayNumber, value, true, effect->minDigits);
+      }
+      break;
+   }
+
+   case RPU_DISPLAY_EFFECT_SCROLL: {
+      // Show the bottom digits for the first 16 steps, then scroll the
+      // whole value through 10 places and wait 6 steps
+      if (step < 16) {
+         ShowDisplayValue(displayNumber, value % (RPU_OS_MAX_DISPLAY_SCORE + 1), false);
+         ShowDisplayBlank(displayNumber, RPU_OS_ALL_DIGITS_MASK);
+         break;
+      }
+      uint8_t scrollPhase = step % 16;
+      if (scrollPhase >= 11) {
+         break;
+      }
+      uint8_t numDigits = DisplayValueMagnitude(value);
+      uint8_t displayMask;
+      unsigned long displayValue = value;
+
+      // Figure out top part of the value
+      if (scrollPhase < RPU_OS_NUM_DIGITS) {
+         displayMask = RPU_OS_ALL_DIGITS_MASK;
+         for (uint8_t scrollCount = 0; scrollCount < scrollPhase; scrollCount++) {
+            displayValue = (displayValue % (RPU_OS_MAX_DISPLAY_SCORE + 1)) * 10;
+            displayMask = displayMask >> 1;
+         }
       } else {
-         DisplayDigitEnable[4] &= 0x39;
+         displayValue = 0;
+         displayMask = 0x00;
+      }
+
+      // Add in lower part of the value
+      if ((numDigits + scrollPhase) > 10) {
+         uint8_t numDigitsNeeded = (numDigits + scrollPhase) - 10;
+         for (uint8_t scrollCount = 0; scrollCount < (numDigits - numDigitsNeeded); scrollCount++) {
+            value /= 10;
+         }
+         displayMask |= DisplayMaskForDigits(DisplayValueMagnitude(value));
+         displayValue += value;
+      }
+      ShowDisplayBlank(displayNumber, displayMask);
+      ShowDisplayValue(displayNumber, displayValue, false);
+      break;
+   }
+
+   case RPU_DISPLAY_EFFECT_BOUNCE: {
+      uint8_t numDigits = DisplayValueMagnitude(value);
+      if (numDigits == 0) {
+         numDigits = 1;
+      }
+      if (numDigits >= (RPU_OS_NUM_DIGITS - 1)) {
+         ShowDisplayValue(displayNumber, value, true, effect->minDigits);
+         break;
+      }
+      uint8_t shiftDigits = step % (((RPU_OS_NUM_DIGITS + 1) - numDigits) + ((RPU_OS_NUM_DIGITS - 1) - numDigits));
+      if (shiftDigits >= ((RPU_OS_NUM_DIGITS + 1) - numDigits)) {
+         shiftDigits = (RPU_OS_NUM_DIGITS - numDigits) * 2 - shiftDigits;
+      }
+      uint8_t displayMask = DisplayMaskForDigits(numDigits);
+      for (uint8_t digitCount = 0; digitCount < shiftDigits; digitCount++) {
+         value *= 10;
+         displayMask = displayMask >> 1;
+      }
+      ShowDisplayBlank(displayNumber, 0x00);
+      ShowDisplayValue(displayNumber, value, false);
+      ShowDisplayBlank(displayNumber, displayMask);
+      break;
+   }
+   }
+}
+
+void RPU_SetDisplayEffect(int displayNumber, uint8_t effect, unsigned long value, unsigned long startTime, unsigned int stepTime,
+                          uint8_t minDigits) {
+   if (displayNumber < 0 || displayNumber >= RPU_NUM_EFFECT_DISPLAYS) {
+      return;
+   }
+   if (stepTime == 0) {
+      stepTime = 1;
+   }
+
+   DisplayEffect* displayEffect = &DisplayEffects[displayNumber];
+   if (displayEffect->effect == effect && displayEffect->value == value && displayEffect->startTime == startTime &&
+       displayEffect->stepTime == stepTime && displayEffect->minDigits == minDigits) {
+      return;
+   }
+
+   displayEffect->effect = effect;
+   displayEffect->value = value;
+   displayEffect->startTime = startTime;
+   displayEffect->stepTime = stepTime;
+   displayEffect->minDigits = minDigits;
+   displayEffect->needsRender = true;
+}
+
+uint8_t RPU_GetDisplayEffect(int displayNumber) {
+   if (displayNumber < 0 || displayNumber >= RPU_NUM_EFFECT_DISPLAYS) {
+      return RPU_DISPLAY_EFFECT_NONE;
+   }
+   return DisplayEffects[displayNumber].effect;
+}
+
+void RPU_UpdateDisplayEffects(unsigned long curTime) {
+   for (uint8_t displayCount = 0; displayCount < RPU_NUM_EFFECT_DISPLAYS; displayCount++) {
+      DisplayEffect* displayEffect = &DisplayEffects[displayCount];
+      if (displayEffect->effect == RPU_DISPLAY_EFFECT_NONE) {
+         continue;
+      }
+      if (!displayEffect->needsRender) {
+         // Static effects only change when they're set
+         if (displayEffect->effect <= RPU_DISPLAY_EFFECT_OFF || RPU_TimeDifference(curTime, displayEffect->nextStepTime) < 0) {
+            continue;
+         }
       }
+
+      unsigned long step = (curTime - displayEffect->startTime) / displayEffect->stepTime;
+      displayEffect->nextStepTime = displayEffect->startTime + (step + 1) * displayEffect->stepTime;
+      displayEffect->needsRender = false;
+      RenderDisplayEffect(displayCount, displayEffect, step);
    }
 }
 
@@ -1801,7 +2520,7 @@ void RPU_SetDisplayFlashCredits(unsigned long curTime, int period) {
 
 // Alpha numeric numbers and alphabet
 
-const uint16_t SevenSegmentNumbers[10] = {
+const uint16_t SevenSegmentNumbers[10] PROGMEM = {
     0x3F, /* 0 */
     0x06, /* 1 */
     0x5B, /* 2 */
@@ -1815,7 +2534,7 @@ const uint16_t SevenSegmentNumbers[10] = {
 };
 
 // alphanumeric 14-segment display (ASCII)
-const uint16_t FourteenSegmentASCII[96] = {
+const uint16_t FourteenSegmentASCII[96] PROGMEM = {
     0x0000, /*   converted 0x0000 to 0x0000*/
     0x0006, /* ! converted 0x4006 to 0x0006*/
     0x0102, /* " converted 0x0202 to 0x0102*/
@@ -1918,6 +2637,7 @@ uint8_t RPU_SetDisplayText(int displayNumber, char* text, bool blankByLength) {
    if (displayNumber > 1 || displayNumber < 0) {
       return 0;
    }
+   StopDisplayEffect(displayNumber);
    uint8_t stringLength = 0xff;
    bool writeSpace = false;
    uint8_t blank = 0;
@@ -1928,26 +2648,27 @@ uint8_t RPU_SetDisplayText(int displayNumber, char* text, bool blankByLength) {
          writeSpace = true;
       }
       if (!writeSpace) {
-         DisplayText[displayNumber][stringLength] = (uint8_t)text[stringLength] - 0x20;
+         DrawFrame->DisplayText[displayNumber][stringLength] = (uint8_t)text[stringLength] - 0x20;
       } else {
-         DisplayText[displayNumber][stringLength] = 0;
+         DrawFrame->DisplayText[displayNumber][stringLength] = 0;
       }
 
-      if (DisplayText[displayNumber][stringLength]) {
+      if (DrawFrame->DisplayText[displayNumber][stringLength]) {
          blank |= placeMask;
       }
       placeMask *= 2;
    }
 
    if (blankByLength) {
-      DisplayDigitEnable[displayNumber] = blank;
+      DrawFrame->DisplayDigitEnable[displayNumber] = blank;
    }
 
    return stringLength;
 }
 
 // Architectures with alpha store numbers as 7-seg
-uint8_t RPU_SetDisplay(int displayNumber, unsigned long value, bool blankByMagnitude, uint8_t minDigits, bool showCommasByMagnitude) {
+uint8_t ShowDisplayBCD(int displayNumber, RPUBCD value, bool blankByMagnitude, uint8_t minDigits, bool showCommasByMagnitude) {
+   (void)showCommasByMagnitude;
    if (displayNumber < 0 || displayNumber > 3) {
       return 0;
    }
@@ -1959,22 +2680,22 @@ uint8_t RPU_SetDisplay(int displayNumber, unsigned long value, bool blankByMagni
       if (value != 0 || count < minDigits) {
          blank |= 1;
          if (displayNumber / 2) {
-            DisplayDigits[displayNumber][(RPU_OS_NUM_DIGITS - 1) - count] = SevenSegmentNumbers[value % 10];
+            DrawFrame->DisplayDigits[displayNumber][(RPU_OS_NUM_DIGITS - 1) - count] = pgm_read_word(&SevenSegmentNumbers[value & 0x0F]);
          } else {
-            DisplayText[displayNumber][(RPU_OS_NUM_DIGITS - 1) - count] = (value % 10) + 16;
+            DrawFrame->DisplayText[displayNumber][(RPU_OS_NUM_DIGITS - 1) - count] = (value & 0x0F) + 16;
          }
       } else {
          if (displayNumber / 2) {
-            DisplayDigits[displayNumber][(RPU_OS_NUM_DIGITS - 1) - count] = 0;
+            DrawFrame->DisplayDigits[displayNumber][(RPU_OS_NUM_DIGITS - 1) - count] = 0;
          } else {
-            DisplayText[displayNumber][(RPU_OS_NUM_DIGITS - 1) - count] = 0;
+            DrawFrame->DisplayText[displayNumber][(RPU_OS_NUM_DIGITS - 1) - count] = 0;
          }
       }
-      value /= 10;
+      value = value >> 4;
    }
 
    if (blankByMagnitude) {
-      DisplayDigitEnable[displayNumber] = blank;
+      DrawFrame->DisplayDigitEnable[displayNumber] = blank;
    }
 
    return blank;
@@ -1984,15 +2705,15 @@ void RPU_SetDisplayCredits(int value, bool displayOn, bool showBothDigits) {
    uint8_t blank = 0x02;
    value = value % 100;
    if (value >= 10) {
-      DisplayCreditDigits[0] = SevenSegmentNumbers[value / 10];
+      DisplayCreditDigits[0] = pgm_read_word(&SevenSegmentNumbers[value / 10]);
       blank |= 1;
    } else {
-      DisplayCreditDigits[0] = SevenSegmentNumbers[0];
+      DisplayCreditDigits[0] = pgm_read_word(&SevenSegmentNumbers[0]);
       if (showBothDigits) {
          blank |= 1;
       }
    }
-   DisplayCreditDigits[1] = SevenSegmentNumbers[value % 10];
+   DisplayCreditDigits[1] = pgm_read_word(&SevenSegmentNumbers[value % 10]);
    if (displayOn) {
       DisplayCreditDigitEnable = blank;
    } else {
@@ -2004,15 +2725,15 @@ void RPU_SetDisplayBallInPlay(int value, bool displayOn, bool showBothDigits) {
    uint8_t blank = 0x02;
    value = value % 100;
    if (value >= 10) {
-      DisplayBIPDigits[0] = SevenSegmentNumbers[value / 10];
+      DisplayBIPDigits[0] = pgm_read_word(&SevenSegmentNumbers[value / 10]);
       blank |= 1;
    } else {
-      DisplayBIPDigits[0] = SevenSegmentNumbers[0];
+      DisplayBIPDigits[0] = pgm_read_word(&SevenSegmentNumbers[0]);
       if (showBothDigits) {
          blank |= 1;
       }
    }
-   DisplayBIPDigits[1] = SevenSegmentNumbers[value % 10];
+   DisplayBIPDigits[1] = pgm_read_word(&SevenSegmentNumbers[value % 10]);
    if (displayOn) {
       DisplayBIPDigitEnable = blank;
    } else {
@@ -2026,17 +2747,136 @@ void RPU_SetDisplayBallInPlay(int value, bool displayOn, bool showBothDigits) {
  *   Lamp Handling Functions
  */
 
+// left shift is iterative on Arduinos, so a bit array is suprisingly faster
+const uint8_t BitShiftValues[8] PROGMEM = {0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80};
+
+// Rebuilds a lamp's bits in the brightness planes from its own brightness
+// and its dim level (whichever is dimmer wins)
+void UpdateLampBrightnessPlanes(int lampNum) {
+   uint8_t lampCol = lampNum / 8;
+   uint8_t lampBit = pgm_read_byte(&BitShiftValues[lampNum % 8]);
+
+   uint8_t brightness = RPU_LAMP_BRIGHTNESS_FULL - LampPassesOff[lampNum];
+   if ((LampDim1[lampCol] & lampBit) && DimBrightness1 < brightness) {
+      brightness = DimBrightness1;
+   }
+   if ((LampDim2[lampCol] & lampBit) && DimBrightness2 < brightness) {
+      brightness = DimBrightness2;
+   }
+
+   uint8_t passesOff = RPU_LAMP_BRIGHTNESS_FULL - brightness;
+   for (uint8_t plane = 0; plane < 3; plane++) {
+      if (passesOff & (1 << plane)) {
+         DrawFrame->LampBrightnessPlanes[plane][lampCol] |= lampBit;
+      } else {
+         DrawFrame->LampBrightnessPlanes[plane][lampCol] &= ~lampBit;
+      }
+   }
+}
+
 void RPU_SetDimDivisor(uint8_t level, uint8_t divisor) {
+   // A divisor of d means the lamp is on one pass in d, so pick the
+   // brightness closest to 8/d passes out of 8
+   uint8_t brightness = RPU_LAMP_BRIGHTNESS_FULL;
+   if (divisor > 1) {
+      uint8_t passesOn = (16 / divisor + 1) / 2;
+      brightness = (passesOn > 0) ? (passesOn - 1) : 0;
+   }
+
    if (level == 1) {
-      DimDivisor1 = divisor;
+      DimBrightness1 = brightness;
    }
    if (level == 2) {
-      DimDivisor2 = divisor;
+      DimBrightness2 = brightness;
+   }
+
+   for (int lampNum = 0; lampNum < RPU_MAX_LAMPS; lampNum++) {
+      UpdateLampBrightnessPlanes(lampNum);
    }
 }
 
-// left shift is iterative on Arduinos, so a bit array is suprisingly faster
-uint8_t BitShiftValues[8] = {0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80};
+void RPU_SetLampBrightness(int lampNum, uint8_t brightness) {
+   if (lampNum >= RPU_MAX_LAMPS || lampNum < 0) {
+      return;
+   }
+   if (brightness > RPU_LAMP_BRIGHTNESS_FULL) {
+      brightness = RPU_LAMP_BRIGHTNESS_FULL;
+   }
+   LampPassesOff[lampNum] = RPU_LAMP_BRIGHTNESS_FULL - brightness;
+   UpdateLampBrightnessPlanes(lampNum);
+}
+
+uint8_t RPU_ReadLampBrightness(int lampNum) {
+   if (lampNum >= RPU_MAX_LAMPS || lampNum < 0) {
+      return 0;
+   }
+   return RPU_LAMP_BRIGHTNESS_FULL - LampPassesOff[lampNum];
+}
+
+void ShowLampFlashPhase(uint8_t lampCol, uint8_t lampMask, uint8_t phase) {
+   if (phase) {
+      DrawFrame->LampStates[lampCol] &= ~lampMask;
+   } else {
+      DrawFrame->LampStates[lampCol] |= lampMask;
+   }
+}
+
+// Moves a lamp to the flash group for its new period (0 for no flash)
+void SetLampFlashPeriod(int lampNum, uint8_t period) {
+   uint8_t oldPeriod = LampFlashPeriod[lampNum];
+   if (period == oldPeriod) {
+      return;
+   }
+   LampFlashPeriod[lampNum] = period;
+
+   uint8_t lampCol = lampNum / 8;
+   uint8_t lampBit = pgm_read_byte(&BitShiftValues[lampNum % 8]);
+   LampFlashGroup* freeGroup = NULL;
+   LampFlashGroup* newGroup = NULL;
+
+   UngroupedFlashLamps[lampCol] &= ~lampBit;
+   for (uint8_t groupNum = 0; groupNum < RPU_NUM_LAMP_FLASH_GROUPS; groupNum++) {
+      LampFlashGroup* group = &LampFlashGroups[groupNum];
+      if (oldPeriod && group->period == oldPeriod && (group->lampMask[lampCol] & lampBit)) {
+         group->lampMask[lampCol] &= ~lampBit;
+         group->numLamps -= 1;
+         if (group->numLamps == 0) {
+            group->period = 0;
+         }
+      }
+      if (group->period == 0) {
+         if (freeGroup == NULL) {
+            freeGroup = group;
+         }
+      } else if (period && group->period == period) {
+         newGroup = group;
+      }
+   }
+
+   if (period == 0) {
+      return;
+   }
+
+   if (newGroup == NULL) {
+      if (freeGroup == NULL) {
+         UngroupedFlashLamps[lampCol] |= lampBit;
+         return;
+      }
+      newGroup = freeGroup;
+      newGroup->period = period;
+      newGroup->numLamps = 0;
+      newGroup->phase = LAMP_FLASH_PHASE_UNKNOWN;
+      memset(newGroup->lampMask, 0, sizeof(newGroup->lampMask));
+   }
+
+   newGroup->lampMask[lampCol] |= lampBit;
+   newGroup->numLamps += 1;
+   // Join in step with the rest of the group (a new group gets its
+   // phase on the next RPU_ApplyFlashToLamps)
+   if (newGroup->phase != LAMP_FLASH_PHASE_UNKNOWN) {
+      ShowLampFlashPhase(lampCol, lampBit, newGroup->phase);
+   }
+}
 
 void RPU_SetLampState(int lampNum, uint8_t s_lampState, uint8_t s_lampDim, int s_lampFlashPeriod) {
    if (lampNum >= RPU_MAX_LAMPS || lampNum < 0) {
@@ -2044,7 +2884,7 @@ void RPU_SetLampState(int lampNum, uint8_t s_lampState, uint8_t s_lampDim, int s
    }
    uint8_t lampRow = lampNum % 8;
    uint8_t lampCol = lampNum / 8;
-   uint8_t lampBit = BitShiftValues[lampRow];
+   uint8_t lampBit = pgm_read_byte(&BitShiftValues[lampRow]);
 
    if (s_lampState) {
       int adjustedLampFlash = s_lampFlashPeriod / 50;
@@ -2059,12 +2899,12 @@ void RPU_SetLampState(int lampNum, uint8_t s_lampState, uint8_t s_lampDim, int s
       // Only turn on the lamp if there's no flash, because if there's a flash
       // then the lamp will be turned on by the ApplyFlashToLamps function
       if (s_lampFlashPeriod == 0) {
-         LampStates[lampCol] &= ~(lampBit);
+         DrawFrame->LampStates[lampCol] &= ~(lampBit);
       }
-      LampFlashPeriod[lampNum] = adjustedLampFlash;
+      SetLampFlashPeriod(lampNum, adjustedLampFlash);
    } else {
-      LampStates[lampCol] |= lampBit;
-      LampFlashPeriod[lampNum] = 0;
+      DrawFrame->LampStates[lampCol] |= lampBit;
+      SetLampFlashPeriod(lampNum, 0);
    }
 
    if (s_lampDim & 0x01) {
@@ -2078,13 +2918,15 @@ void RPU_SetLampState(int lampNum, uint8_t s_lampState, uint8_t s_lampDim, int s
    } else {
       LampDim2[lampCol] &= ~lampBit;
    }
+
+   UpdateLampBrightnessPlanes(lampNum);
 }
 
 uint8_t RPU_ReadLampState(int lampNum) {
    if (lampNum >= RPU_MAX_LAMPS || lampNum < 0) {
       return 0x00;
    }
-   uint8_t lampStateByte = LampStates[lampNum / 8];
+   uint8_t lampStateByte = DrawFrame->LampStates[lampNum / 8];
    return (lampStateByte & (0x01 << (lampNum % 8))) ? 0 : 1;
 }
 
@@ -2115,24 +2957,42 @@ int RPU_ReadLampFlash(int lampNum) {
 }
 
 void RPU_ApplyFlashToLamps(unsigned long curTime) {
-   int curLampByte = 0;
-   uint8_t curLampBit = 0;
-   int curLampNum = 0;
+   for (uint8_t groupNum = 0; groupNum < RPU_NUM_LAMP_FLASH_GROUPS; groupNum++) {
+      LampFlashGroup* group = &LampFlashGroups[groupNum];
+      if (group->period == 0) {
+         continue;
+      }
+      if (group->phase != LAMP_FLASH_PHASE_UNKNOWN && RPU_TimeDifference(curTime, group->nextToggleTime) < 0) {
+         continue;
+      }
 
-   for (curLampByte = 0; curLampByte < RPU_NUM_LAMP_BANKS; curLampByte++) {
-      curLampBit = 0x01;
-      for (uint8_t curBit = 0; curBit < 8; curBit++) {
-         if (LampFlashPeriod[curLampNum] != 0) {
-            unsigned long adjustedLampFlash = (unsigned long)LampFlashPeriod[curLampNum] * (unsigned long)50;
-            if ((curTime / adjustedLampFlash) % 2) {
-               LampStates[curLampByte] &= ~(curLampBit);
-            } else {
-               LampStates[curLampByte] |= (curLampBit);
-            }
+      unsigned long adjustedLampFlash = (unsigned long)group->period * (unsigned long)50;
+      unsigned long flashCount = curTime / adjustedLampFlash;
+      group->nextToggleTime = (flashCount + 1) * adjustedLampFlash;
+      uint8_t phase = flashCount % 2;
+      if (phase == group->phase) {
+         continue;
+      }
+      group->phase = phase;
+      for (uint8_t curLampByte = 0; curLampByte < RPU_NUM_LAMP_BANKS; curLampByte++) {
+         if (group->lampMask[curLampByte]) {
+            ShowLampFlashPhase(curLampByte, group->lampMask[curLampByte], phase);
          }
+      }
+   }
 
-         curLampBit *= 2;
-         curLampNum += 1;
+   // Lamps that didn't get a group
+   for (uint8_t curLampByte = 0; curLampByte < RPU_NUM_LAMP_BANKS; curLampByte++) {
+      uint8_t ungroupedLamps = UngroupedFlashLamps[curLampByte];
+      if (ungroupedLamps == 0) {
+         continue;
+      }
+      for (uint8_t curBit = 0; curBit < 8; curBit++) {
+         uint8_t curLampBit = pgm_read_byte(&BitShiftValues[curBit]);
+         if (ungroupedLamps & curLampBit) {
+            unsigned long adjustedLampFlash = (unsigned long)LampFlashPeriod[curLampByte * 8 + curBit] * (unsigned long)50;
+            ShowLampFlashPhase(curLampByte, curLampBit, (curTime / adjustedLampFlash) % 2);
+         }
       }
    }
 }
@@ -2151,23 +3011,38 @@ void RPU_TurnOffAllLamps() {
    }
 }
 
+bool RPU_CommitFrame() {
+#if defined(RPU_OS_DOUBLE_BUFFER_FRAMES)
+   volatile RPUFrame* shownFrame = &Frames[ShownFrameIndex];
+   if (memcmp((const void*)DrawFrame, (const void*)shownFrame, sizeof(RPUFrame)) == 0) {
+      return false;
+   }
+
+   ShownFrameIndex ^= 1;
+   // This only runs from the main loop, so no interrupt is part way through
+   // showing the old frame - it can be brought up to date and drawn on
+   memcpy((void*)shownFrame, (const void*)DrawFrame, sizeof(RPUFrame));
+   DrawFrame = shownFrame;
+   return true;
+#else
+   return false;
+#endif
+}
+
 /******************************************************
  *   Helper Functions
  */
 
 void RPU_ClearVariables() {
    // Reset solenoid stack
-   SolenoidStackFirst = 0;
-   SolenoidStackLast = 0;
+   SolenoidStack.Clear();
 
    // Reset switch stack
-   SwitchStackFirst = 0;
-   SwitchStackLast = 0;
+   SwitchStack.Clear();
 
 #if (RPU_MPU_ARCHITECTURE > 9)
    // Reset sound stack
-   SoundStackFirst = 0;
-   SoundStackLast = 0;
+   SoundStack.Clear();
 #endif
 
    CurrentDisplayDigit = 0;
@@ -2175,24 +3050,34 @@ void RPU_ClearVariables() {
    // Set default values for the displays
    for (int displayCount = 0; displayCount < 5; displayCount++) {
       for (int digitCount = 0; digitCount < RPU_OS_NUM_DIGITS; digitCount++) {
-         DisplayDigits[displayCount][digitCount] = 0;
+         DrawFrame->DisplayDigits[displayCount][digitCount] = 0;
       }
-      DisplayDigitEnable[displayCount] = 0x00;
+      DrawFrame->DisplayDigitEnable[displayCount] = 0x00;
    }
 #if (RPU_MPU_ARCHITECTURE >= 13)
    DisplayCommas = 0x00;
 #endif
+   memset(DisplayEffects, 0, sizeof(DisplayEffects));
 
    // Turn off all lamp states
    for (int lampBankCounter = 0; lampBankCounter < RPU_NUM_LAMP_BANKS; lampBankCounter++) {
-      LampStates[lampBankCounter] = 0xFF;
+      DrawFrame->LampStates[lampBankCounter] = 0xFF;
       LampDim1[lampBankCounter] = 0x00;
       LampDim2[lampBankCounter] = 0x00;
+      for (uint8_t plane = 0; plane < LAMP_BRIGHTNESS_NUM_PLANES; plane++) {
+         DrawFrame->LampBrightnessPlanes[plane][lampBankCounter] = 0x00;
+      }
    }
+#if defined(RPU_OS_DOUBLE_BUFFER_FRAMES)
+   memcpy((void*)&Frames[ShownFrameIndex], (const void*)DrawFrame, sizeof(RPUFrame));
+#endif
 
    for (int lampFlashCount = 0; lampFlashCount < RPU_MAX_LAMPS; lampFlashCount++) {
       LampFlashPeriod[lampFlashCount] = 0;
+      LampPassesOff[lampFlashCount] = 0;
    }
+   memset(LampFlashGroups, 0, sizeof(LampFlashGroups));
+   memset(UngroupedFlashLamps, 0, sizeof(UngroupedFlashLamps));
 
    // Reset all the switch values
    // (set them as closed so that if they're stuck they don't register as new events)
@@ -2203,21 +3088,10 @@ void RPU_ClearVariables() {
       SwitchesNow[switchCount] = 0xFF;
    }
 
-   for (uint8_t count = 0; count < TIMED_SOLENOID_STACK_SIZE; count++) {
-      TimedSolenoidStack[count].inUse = 0;
-      TimedSolenoidStack[count].pushTime = 0;
-      TimedSolenoidStack[count].solenoidNumber = 0;
-      TimedSolenoidStack[count].numPushes = 0;
-      TimedSolenoidStack[count].disableOverride = 0;
-   }
+   TimedSolenoidStack.Clear();
 
 #if (RPU_MPU_ARCHITECTURE > 9)
-   for (uint8_t count = 0; count < TIMED_SOUND_STACK_SIZE; count++) {
-      TimedSoundStack[count].inUse = 0;
-      TimedSoundStack[count].pushTime = 0;
-      TimedSoundStack[count].soundNumber = 0;
-      TimedSoundStack[count].numPushes = 0;
-   }
+   TimedSoundStack.Clear();
 #endif
 }
 
@@ -2234,39 +3108,39 @@ void RPU_PlaySoundSAndT(uint8_t soundByte) {
    noInterrupts();
 
    // Get the current value of U11:PortB - current solenoids
-   oldSolenoidControlByte = RPU_DataRead(ADDRESS_U11_B);
+   oldSolenoidControlByte = PIAShadowRead(ADDRESS_U11_B);
    soundLowerNibble = (oldSolenoidControlByte & 0xF0) | (soundByte & 0x0F);
    soundUpperNibble = (oldSolenoidControlByte & 0xF0) | (soundByte / 16);
 
    // Put 1s on momentary solenoid lines
-   RPU_DataWrite(ADDRESS_U11_B, oldSolenoidControlByte | 0x0F);
+   PIAWrite(ADDRESS_U11_B, oldSolenoidControlByte | 0x0F);
 
    // Put sound latch low
-   RPU_DataWrite(ADDRESS_U11_B_CONTROL, 0x34);
+   PIAWrite(ADDRESS_U11_B_CONTROL, 0x34);
 
    // Let the strobe stay low for a moment
    delayMicroseconds(32);
 
    // Put sound latch high
-   RPU_DataWrite(ADDRESS_U11_B_CONTROL, 0x3C);
+   PIAWrite(ADDRESS_U11_B_CONTROL, 0x3C);
 
    // put the new uint8_t on U11:PortB (the lower nibble is currently loaded)
-   RPU_DataWrite(ADDRESS_U11_B, soundLowerNibble);
+   PIAWrite(ADDRESS_U11_B, soundLowerNibble);
 
    // wait 138 microseconds
    delayMicroseconds(138);
 
    // put the new uint8_t on U11:PortB (the uppper nibble is currently loaded)
-   RPU_DataWrite(ADDRESS_U11_B, soundUpperNibble);
+   PIAWrite(ADDRESS_U11_B, soundUpperNibble);
 
    // wait 76 microseconds
    delayMicroseconds(145);
 
    // Restore the original solenoid uint8_t
-   RPU_DataWrite(ADDRESS_U11_B, oldSolenoidControlByte);
+   PIAWrite(ADDRESS_U11_B, oldSolenoidControlByte);
 
    // Put sound latch low
-   RPU_DataWrite(ADDRESS_U11_B_CONTROL, 0x34);
+   PIAWrite(ADDRESS_U11_B_CONTROL, 0x34);
 
    interrupts();
 }
@@ -2320,8 +3194,8 @@ void RPU_PlaySoundDash51(uint8_t soundByte) {
    noInterrupts();
 
    // Get the current value of U11:PortB - current solenoids
-   oldSolenoidControlByte = RPU_DataRead(ADDRESS_U11_B);
-   oldDisplayByte = RPU_DataRead(ADDRESS_U11_A);
+   oldSolenoidControlByte = PIAShadowRead(ADDRESS_U11_B);
+   oldDisplayByte = PIAShadowRead(ADDRESS_U11_A);
    soundLowerNibble = (oldSolenoidControlByte & 0xF0) | (soundByte & 0x0F);
    displayWithSoundBit4 = oldDisplayByte;
    if (soundByte & 0x10) {
@@ -2331,34 +3205,34 @@ void RPU_PlaySoundDash51(uint8_t soundByte) {
    }
 
    // Put 1s on momentary solenoid lines
-   RPU_DataWrite(ADDRESS_U11_B, oldSolenoidControlByte | 0x0F);
+   PIAWrite(ADDRESS_U11_B, oldSolenoidControlByte | 0x0F);
 
    // Put sound latch low
-   RPU_DataWrite(ADDRESS_U11_B_CONTROL, 0x34);
+   PIAWrite(ADDRESS_U11_B_CONTROL, 0x34);
 
    // Let the strobe stay low for a moment
    delayMicroseconds(68);
 
    // put bit 4 on Display Enable 7
-   RPU_DataWrite(ADDRESS_U11_A, displayWithSoundBit4);
+   PIAWrite(ADDRESS_U11_A, displayWithSoundBit4);
 
    // Put sound latch high
-   RPU_DataWrite(ADDRESS_U11_B_CONTROL, 0x3C);
+   PIAWrite(ADDRESS_U11_B_CONTROL, 0x3C);
 
    // put the new uint8_t on U11:PortB (the lower nibble is currently loaded)
-   RPU_DataWrite(ADDRESS_U11_B, soundLowerNibble);
+   PIAWrite(ADDRESS_U11_B, soundLowerNibble);
 
    // wait 180 microseconds
    delayMicroseconds(180);
 
    // Restore the original solenoid uint8_t
-   RPU_DataWrite(ADDRESS_U11_B, oldSolenoidControlByte);
+   PIAWrite(ADDRESS_U11_B, oldSolenoidControlByte);
 
    // Restore the original display uint8_t
-   RPU_DataWrite(ADDRESS_U11_A, oldDisplayByte);
+   PIAWrite(ADDRESS_U11_A, oldDisplayByte);
 
    // Put sound latch low
-   RPU_DataWrite(ADDRESS_U11_B_CONTROL, 0x34);
+   PIAWrite(ADDRESS_U11_B_CONTROL, 0x34);
 
    interrupts();
 }
@@ -2391,77 +3265,45 @@ void RPU_SetSoundValueLimits(unsigned short lowerLimit, unsigned short upperLimi
    SoundUpperLimit = upperLimit;
 }
 
-int SpaceLeftOnSoundStack() {
-   if (SoundStackFirst >= SOUND_STACK_SIZE || SoundStackLast >= SOUND_STACK_SIZE) {
-      return 0;
-   }
-   if (SoundStackLast >= SoundStackFirst) {
-      return ((SOUND_STACK_SIZE - 1) - (SoundStackLast - SoundStackFirst));
-   }
-   return (SoundStackFirst - SoundStackLast) - 1;
-}
-
+// Only the main loop pushes sounds, so this doesn't need to mask interrupts
 void RPU_PushToSoundStack(unsigned short soundNumber, uint8_t numPushes) {
-   // If the solenoid stack last index is out of range, then it's an error - return
-   if (SpaceLeftOnSoundStack() == 0) {
-      return;
-   }
    if (soundNumber < SoundLowerLimit || soundNumber > SoundUpperLimit) {
       return;
    }
 
    for (int count = 0; count < numPushes; count++) {
-      SoundStack[SoundStackLast] = soundNumber;
-
-      SoundStackLast += 1;
-      if (SoundStackLast == SOUND_STACK_SIZE) {
-         // If the end index is off the end, then wrap
-         SoundStackLast = 0;
-      }
       // If the stack is now full, return
-      if (SpaceLeftOnSoundStack() == 0) {
+      if (!SoundStack.Push(soundNumber)) {
          return;
       }
    }
 }
 
 unsigned short PullFirstFromSoundStack() {
-   // If first and last are equal, there's nothing on the stack
-   if (SoundStackFirst == SoundStackLast) {
+   unsigned short retVal;
+   if (!SoundStack.Pop(&retVal)) {
       return SOUND_STACK_EMPTY;
    }
-
-   unsigned short retVal = SoundStack[SoundStackFirst];
-
-   SoundStackFirst += 1;
-   if (SoundStackFirst >= SOUND_STACK_SIZE) {
-      SoundStackFirst = 0;
-   }
-
    return retVal;
 }
 
 bool RPU_PushToTimedSoundStack(unsigned short soundNumber, uint8_t numPushes, unsigned long whenToPlay) {
-   for (int count = 0; count < TIMED_SOUND_STACK_SIZE; count++) {
-      if (!TimedSoundStack[count].inUse) {
-         TimedSoundStack[count].inUse = true;
-         TimedSoundStack[count].pushTime = whenToPlay;
-         TimedSoundStack[count].soundNumber = soundNumber;
-         TimedSoundStack[count].numPushes = numPushes;
-         return true;
-      }
-   }
-   return false;
+   TimedSoundEntry newEntry;
+   newEntry.soundNumber = soundNumber;
+   newEntry.numPushes = numPushes;
+   return TimedSoundStack.Push(newEntry, whenToPlay);
 }
 
 void RPU_UpdateTimedSoundStack(unsigned long curTime) {
-   for (int count = 0; count < TIMED_SOUND_STACK_SIZE; count++) {
-      if (TimedSoundStack[count].inUse && TimedSoundStack[count].pushTime < curTime) {
-         RPU_PushToSoundStack(TimedSoundStack[count].soundNumber, TimedSoundStack[count].numPushes);
-         TimedSoundStack[count].inUse = false;
-      }
+   TimedSoundEntry dueEntry;
+   while (TimedSoundStack.PopDue(curTime, &dueEntry)) {
+      RPU_PushToSoundStack(dueEntry.soundNumber, dueEntry.numPushes);
    }
 }
+
+unsigned long RPU_GetTimedSoundStackDrops() {
+   return TimedSoundStack.GetNumDropped();
+}
 #endif
 
 #ifdef RPU_OS_USE_WTYPE_11_SOUND
@@ -2484,16 +3326,109 @@ void RPU_PlayW11Music(uint8_t songNum) {
  *   EEPROM Helper Functions
  */
 
+#if defined(RPU_OS_USE_EEPROM_CACHE)
+// RAM image of the settings & audits at the start of the EEPROM. Once
+// it's loaded, writes only change the image and mark the byte dirty, and
+// RPU_Update starts one dirty byte's write whenever the EEPROM is ready.
+// Each write takes ~3.3ms, so writing them directly stalled the loop for
+// the whole time a game start or coin updated its audits.
+uint8_t EEPromCache[RPU_EEPROM_CACHE_SIZE];
+uint8_t EEPromCacheDirty[(RPU_EEPROM_CACHE_SIZE + 7) / 8];
+unsigned short EEPromCacheNumDirty = 0;
+unsigned short EEPromCacheNextCommit = 0;
+bool EEPromCacheLoaded = false;
+
+void RPU_LoadEEPromCache() {
+   // Only the first call reads the EEPROM. After that the image is the
+   // newer copy (re-reading it would throw away bytes not written yet).
+   if (EEPromCacheLoaded) {
+      return;
+   }
+   for (unsigned short address = 0; address < RPU_EEPROM_CACHE_SIZE; address++) {
+      EEPromCache[address] = EEPROM.read(address);
+   }
+   memset(EEPromCacheDirty, 0, sizeof(EEPromCacheDirty));
+   EEPromCacheNumDirty = 0;
+   EEPromCacheNextCommit = 0;
+   EEPromCacheLoaded = true;
+}
+
+// Starts the write of the next dirty byte (searching from where the last
+// one left off). Returns false if nothing was dirty.
+bool CommitNextEEPromByte() {
+   if (EEPromCacheNumDirty == 0) {
+      return false;
+   }
+
+   unsigned short address = EEPromCacheNextCommit;
+   while ((EEPromCacheDirty[address / 8] & (1 << (address % 8))) == 0) {
+      address += 1;
+      if (address >= RPU_EEPROM_CACHE_SIZE) {
+         address = 0;
+      }
+   }
+   EEPromCacheDirty[address / 8] &= ~(1 << (address % 8));
+   EEPromCacheNumDirty -= 1;
+   EEPromCacheNextCommit = address + 1;
+   if (EEPromCacheNextCommit >= RPU_EEPROM_CACHE_SIZE) {
+      EEPromCacheNextCommit = 0;
+   }
+
+   EEPROM.write(address, EEPromCache[address]);
+   return true;
+}
+
+void RPU_UpdateEEPromCache() {
+   if (eeprom_is_ready()) {
+      CommitNextEEPromByte();
+   }
+}
+
+void RPU_FlushEEPromCache() {
+   while (CommitNextEEPromByte()) {
+   }
+}
+
+unsigned short RPU_GetEEPromCacheNumDirty() {
+   return EEPromCacheNumDirty;
+}
+#endif
+
+uint8_t ReadEEPromByte(unsigned short address) {
+#if defined(RPU_OS_USE_EEPROM_CACHE)
+   if (EEPromCacheLoaded && address < RPU_EEPROM_CACHE_SIZE) {
+      return EEPromCache[address];
+   }
+#endif
+   return EEPROM.read(address);
+}
+
+void WriteEEPromByte(unsigned short address, uint8_t value) {
+#if defined(RPU_OS_USE_EEPROM_CACHE)
+   if (EEPromCacheLoaded && address < RPU_EEPROM_CACHE_SIZE) {
+      if (EEPromCache[address] != value) {
+         EEPromCache[address] = value;
+         if ((EEPromCacheDirty[address / 8] & (1 << (address % 8))) == 0) {
+            EEPromCacheDirty[address / 8] |= (1 << (address % 8));
+            EEPromCacheNumDirty += 1;
+         }
+      }
+      return;
+   }
+#endif
+   EEPROM.write(address, value);
+}
+
 void RPU_WriteByteToEEProm(unsigned short startByte, uint8_t value) {
-   EEPROM.write(startByte, value);
+   WriteEEPromByte(startByte, value);
 }
 
-uint8_t RPU_ReadByteFromEEProm(unsigned short startByte) {
-   uint8_t value = EEPROM.read(startByte);
+uint8_t RPU_ReadByteFromEEProm(unsigned short startByte, uint8_t defaultValue) {
+   uint8_t value = ReadEEPromByte(startByte);
 
    // If this value is unset, set it
    if (value == 0xFF) {
-      value = 0;
+      value = defaultValue;
       RPU_WriteByteToEEProm(startByte, value);
    }
    return value;
@@ -2502,8 +3437,8 @@ uint8_t RPU_ReadByteFromEEProm(unsigned short startByte) {
 unsigned long RPU_ReadULFromEEProm(unsigned short startByte, unsigned long defaultValue) {
    unsigned long value;
 
-   value = (((unsigned long)EEPROM.read(startByte + 3)) << 24) | ((unsigned long)(EEPROM.read(startByte + 2)) << 16) |
-           ((unsigned long)(EEPROM.read(startByte + 1)) << 8) | ((unsigned long)(EEPROM.read(startByte)));
+   value = (((unsigned long)ReadEEPromByte(startByte + 3)) << 24) | ((unsigned long)(ReadEEPromByte(startByte + 2)) << 16) |
+           ((unsigned long)(ReadEEPromByte(startByte + 1)) << 8) | ((unsigned long)(ReadEEPromByte(startByte)));
 
    if (value == 0xFFFFFFFF) {
       value = defaultValue;
@@ -2513,10 +3448,10 @@ unsigned long RPU_ReadULFromEEProm(unsigned short startByte, unsigned long defau
 }
 
 void RPU_WriteULToEEProm(unsigned short startByte, unsigned long value) {
-   EEPROM.write(startByte + 3, (uint8_t)(value >> 24));
-   EEPROM.write(startByte + 2, (uint8_t)((value >> 16) & 0x000000FF));
-   EEPROM.write(startByte + 1, (uint8_t)((value >> 8) & 0x000000FF));
-   EEPROM.write(startByte, (uint8_t)(value & 0x000000FF));
+   WriteEEPromByte(startByte + 3, (uint8_t)(value >> 24));
+   WriteEEPromByte(startByte + 2, (uint8_t)((value >> 16) & 0x000000FF));
+   WriteEEPromByte(startByte + 1, (uint8_t)((value >> 8) & 0x000000FF));
+   WriteEEPromByte(startByte, (uint8_t)(value & 0x000000FF));
 }
 
 /******************************************************
@@ -2572,6 +3507,123 @@ bool CheckForMPUClock() {
 
 #if (RPU_MPU_ARCHITECTURE < 10)
 
+/******************************************************
+ *   Interrupt Profiling
+ *
+ *   Timer 3 free-runs at clk/8 (0.5us per tick, wrapping every 32.7ms), so a
+ *   phase is timed by differencing TCNT3. Phase times include any display
+ *   interrupt that nests inside them (the zero crossing opens an interrupt
+ *   window for each switch strobe and each lamp nibble).
+ */
+#if defined(RPU_OS_PROFILE_INTERRUPTS)
+#if (RPU_OS_HARDWARE_REV < 3)
+#error "RPU_OS_PROFILE_INTERRUPTS needs timer 3, which is only on the MEGA 2560 (RPU_OS_HARDWARE_REV 3 and up)"
+#endif
+
+#define PROFILE_PHASE_SWITCH_SCAN 0
+#define PROFILE_PHASE_TRIGGER_LOOKUP 1
+#define PROFILE_PHASE_SOLENOIDS 2
+#define PROFILE_PHASE_LAMPS 3
+#define PROFILE_PHASE_AUX_LAMPS 4
+#define PROFILE_PHASE_ZERO_CROSSING 5
+#define PROFILE_PHASE_DISPLAY 6
+#define PROFILE_NUM_PHASES 7
+// Bucket n counts times of 2^(n-1) to 2^n - 1 ticks (bucket 0 is 0 ticks)
+#define PROFILE_NUM_BUCKETS 16
+
+struct InterruptProfilePhase {
+   uint16_t minTicks;
+   uint16_t maxTicks;
+   uint32_t totalTicks;
+   uint32_t count;
+   uint16_t buckets[PROFILE_NUM_BUCKETS];
+};
+
+InterruptProfilePhase InterruptProfile[PROFILE_NUM_PHASES];
+const char* const InterruptProfilePhaseNames[PROFILE_NUM_PHASES] = {"Switch scan", "Trigger lookup", "Solenoids", "Lamps",
+                                                                    "Aux lamps",   "Zero crossing",  "Display"};
+
+void RecordInterruptProfile(uint8_t phase, uint16_t ticks) {
+   InterruptProfilePhase* profile = &InterruptProfile[phase];
+   if (ticks < profile->minTicks) {
+      profile->minTicks = ticks;
+   }
+   if (ticks > profile->maxTicks) {
+      profile->maxTicks = ticks;
+   }
+   profile->totalTicks += ticks;
+   profile->count += 1;
+
+   uint8_t bucket = 0;
+   while (ticks && bucket < (PROFILE_NUM_BUCKETS - 1)) {
+      ticks = ticks >> 1;
+      bucket += 1;
+   }
+   if (profile->buckets[bucket] != 0xFFFF) {
+      profile->buckets[bucket] += 1;
+   }
+}
+
+// Adds the ticks since the mark to an accumulator and moves the mark up
+#define PROFILE_LAP(mark, accumulator)                                                                                                     \
+   {                                                                                                                                        \
+      uint16_t profileNow = TCNT3;                                                                                                         \
+      accumulator += (uint16_t)(profileNow - mark);                                                                                        \
+      mark = profileNow;                                                                                                                   \
+   }
+
+// Records the ticks since the mark as one sample of a phase and moves the mark up
+#define PROFILE_PHASE_END(mark, phase)                                                                                                     \
+   {                                                                                                                                        \
+      uint16_t profileNow = TCNT3;                                                                                                         \
+      RecordInterruptProfile(phase, profileNow - mark);                                                                                    \
+      mark = profileNow;                                                                                                                   \
+   }
+
+void RPU_ResetInterruptProfile() {
+   noInterrupts();
+   memset(InterruptProfile, 0, sizeof(InterruptProfile));
+   for (uint8_t phase = 0; phase < PROFILE_NUM_PHASES; phase++) {
+      InterruptProfile[phase].minTicks = 0xFFFF;
+   }
+   interrupts();
+}
+
+void RPU_DumpInterruptProfile() {
+   char buf[80];
+   Serial.write("Phase            count   min(us)  mean(us)   max(us)\n");
+   for (uint8_t phase = 0; phase < PROFILE_NUM_PHASES; phase++) {
+      // Take a consistent copy -- the interrupts keep recording while we print
+      InterruptProfilePhase profile;
+      noInterrupts();
+      profile = InterruptProfile[phase];
+      interrupts();
+
+      if (profile.count == 0) {
+         sprintf(buf, "%-14s %7s\n", InterruptProfilePhaseNames[phase], "-");
+         Serial.write(buf);
+         continue;
+      }
+      sprintf(buf, "%-14s %7lu %9u %9lu %9u\n", InterruptProfilePhaseNames[phase], (unsigned long)profile.count, profile.minTicks / 2,
+              (unsigned long)((profile.totalTicks / profile.count) / 2), profile.maxTicks / 2);
+      Serial.write(buf);
+
+      // Histogram, one column per power of two (in ticks), skipping empty buckets
+      Serial.write("   ");
+      for (uint8_t bucket = 0; bucket < PROFILE_NUM_BUCKETS; bucket++) {
+         if (profile.buckets[bucket] && bucket == 0) {
+            sprintf(buf, " 0us:%u", profile.buckets[bucket]);
+            Serial.write(buf);
+         } else if (profile.buckets[bucket]) {
+            sprintf(buf, " <%luus:%u", (1UL << bucket) / 2, profile.buckets[bucket]);
+            Serial.write(buf);
+         }
+      }
+      Serial.write("\n");
+   }
+}
+#endif
+
 volatile int numberOfU10Interrupts = 0;
 volatile int numberOfU11Interrupts = 0;
 volatile uint8_t InsideZeroCrossingInterrupt = 0;
@@ -2579,39 +3631,49 @@ volatile uint8_t InsideZeroCrossingInterrupt = 0;
 // INTERRUPT SERVICE ROUTINE
 // for ARCH 1 (B/S)
 ISR(TIMER1_COMPA_vect) { // This is the interrupt request
-   // Backup U10A
-   uint8_t backupU10A = RPU_DataRead(ADDRESS_U10_A);
+#if defined(RPU_OS_PROFILE_INTERRUPTS)
+   uint16_t profileMark = TCNT3;
+#endif
 
-   // Disable lamp decoders & strobe latch
-   RPU_DataWrite(ADDRESS_U10_A, 0xFF);
-   RPU_DataWrite(ADDRESS_U10_B_CONTROL, RPU_DataRead(ADDRESS_U10_B_CONTROL) | 0x08);
-   RPU_DataWrite(ADDRESS_U10_B_CONTROL, RPU_DataRead(ADDRESS_U10_B_CONTROL) & 0xF7);
+   // Backup U10A
+   uint8_t backupU10A = PIAShadowRead(ADDRESS_U10_A);
+   uint8_t u10BControl = PIAShadowRead(ADDRESS_U10_B_CONTROL);
 #ifdef RPU_OS_USE_AUX_LAMPS
-   // Also park the aux lamp board
-   RPU_DataWrite(ADDRESS_U11_A_CONTROL, RPU_DataRead(ADDRESS_U11_A_CONTROL) | 0x08);
-   RPU_DataWrite(ADDRESS_U11_A_CONTROL, RPU_DataRead(ADDRESS_U11_A_CONTROL) & 0xF7);
+   uint8_t u11AControl = PIAShadowRead(ADDRESS_U11_A_CONTROL);
 #endif
 
-   // Blank Displays
-   RPU_DataWrite(ADDRESS_U10_A_CONTROL, RPU_DataRead(ADDRESS_U10_A_CONTROL) & 0xF7);
-   // Set all 5 display latch strobes high
-   RPU_DataWrite(ADDRESS_U11_A, (RPU_DataRead(ADDRESS_U11_A)) | 0x01);
-   RPU_DataWrite(ADDRESS_U10_A, 0x0F);
+   const BusOp blankingOps[] = {
+      // Disable lamp decoders & strobe latch
+      {ADDRESS_U10_A, 0xFF},
+      {ADDRESS_U10_B_CONTROL, (uint8_t)(u10BControl | 0x08)},
+      {ADDRESS_U10_B_CONTROL, (uint8_t)(u10BControl & 0xF7)},
+#ifdef RPU_OS_USE_AUX_LAMPS
+      // Also park the aux lamp board
+      {ADDRESS_U11_A_CONTROL, (uint8_t)(u11AControl | 0x08)},
+      {ADDRESS_U11_A_CONTROL, (uint8_t)(u11AControl & 0xF7)},
+#endif
+      // Blank Displays
+      {ADDRESS_U10_A_CONTROL, (uint8_t)(PIAShadowRead(ADDRESS_U10_A_CONTROL) & 0xF7)},
+      // Set all 5 display latch strobes high
+      {ADDRESS_U11_A, (uint8_t)(PIAShadowRead(ADDRESS_U11_A) | 0x01)},
+      {ADDRESS_U10_A, 0x0F}};
+   PIAWriteBurst(blankingOps, sizeof(blankingOps) / sizeof(BusOp));
 
    uint8_t displayStrobeMask = 0x01;
    uint8_t displayDigitsMask;
 #ifdef RPU_OS_USE_7_DIGIT_DISPLAYS
    displayDigitsMask = (0x02 << CurrentDisplayDigit);
 #else
-   displayDigitsMask = RPU_DataRead(ADDRESS_U11_A) & 0x02;
+   displayDigitsMask = PIAShadowRead(ADDRESS_U11_A) & 0x02;
    displayDigitsMask |= (0x04 << CurrentDisplayDigit);
 #endif
 
    // Write current display digits to 5 displays
+   volatile RPUFrame* shownFrame = &Frames[ShownFrameIndex];
    for (int displayCount = 0; displayCount < 5; displayCount++) {
       // The BCD for this digit is in b4-b7, and the display latch strobes are in b0-b3 (and U11A:b0)
-      uint8_t displayDataByte = ((DisplayDigits[displayCount][CurrentDisplayDigit]) << 4) | 0x0F;
-      uint8_t displayEnable = ((DisplayDigitEnable[displayCount]) >> CurrentDisplayDigit) & 0x01;
+      uint8_t displayDataByte = ((shownFrame->DisplayDigits[displayCount][CurrentDisplayDigit]) << 4) | 0x0F;
+      uint8_t displayEnable = ((shownFrame->DisplayDigitEnable[displayCount]) >> CurrentDisplayDigit) & 0x01;
 
       // if this digit shouldn't be displayed, then set data lines to 0xFX so digit will be blank
       if (!displayEnable) {
@@ -2629,10 +3691,10 @@ ISR(TIMER1_COMPA_vect) { // This is the interrupt request
       // The strobe for the four score displays is high here because then the strobes
       // are NOR'd with U10:CA2 (which mutes the signals during other actions).
       // Only one strobe is low (from the above line.
-      RPU_DataWrite(ADDRESS_U10_A, displayDataByte);
+      PIAWrite(ADDRESS_U10_A, displayDataByte);
       if (displayCount == 4) {
          // Strobe #5 latch on U11A:b0
-         RPU_DataWrite(ADDRESS_U11_A, displayDigitsMask & 0xFE);
+         PIAWrite(ADDRESS_U11_A, displayDigitsMask & 0xFE);
       }
 
       // Right now the "Display Latch Strobe" is high
@@ -2642,28 +3704,32 @@ ISR(TIMER1_COMPA_vect) { // This is the interrupt request
       if (displayCount < 4) {
          displayDataByte |= 0x0F;
          // Need to delay a little to make sure the strobe is low (high on the port) for long enough
-         RPU_DataWrite(ADDRESS_U10_A, displayDataByte);
+         PIAWrite(ADDRESS_U10_A, displayDataByte);
       } else {
-         RPU_DataWrite(ADDRESS_U11_A, displayDigitsMask | 0x01);
+         PIAWrite(ADDRESS_U11_A, displayDigitsMask | 0x01);
       }
 
       displayStrobeMask *= 2;
    }
 
-   // While the data is being strobed, we need to enable the current digit
-   RPU_DataWrite(ADDRESS_U11_A, displayDigitsMask | 0x01);
-
    CurrentDisplayDigit = CurrentDisplayDigit + 1;
    if (CurrentDisplayDigit >= RPU_OS_NUM_DIGITS) {
       CurrentDisplayDigit = 0;
       DisplayOffCycle ^= true;
    }
 
-   // Stop Blanking (current digits are all latched and ready)
-   RPU_DataWrite(ADDRESS_U10_A_CONTROL, RPU_DataRead(ADDRESS_U10_A_CONTROL) | 0x08);
+   const BusOp unblankingOps[] = {
+      // While the data is being strobed, we need to enable the current digit
+      {ADDRESS_U11_A, (uint8_t)(displayDigitsMask | 0x01)},
+      // Stop Blanking (current digits are all latched and ready)
+      {ADDRESS_U10_A_CONTROL, (uint8_t)(PIAShadowRead(ADDRESS_U10_A_CONTROL) | 0x08)},
+      // Restore 10A from backup
+      {ADDRESS_U10_A, backupU10A}};
+   PIAWriteBurst(unblankingOps, sizeof(unblankingOps) / sizeof(BusOp));
 
-   // Restore 10A from backup
-   RPU_DataWrite(ADDRESS_U10_A, backupU10A);
+#if defined(RPU_OS_PROFILE_INTERRUPTS)
+   PROFILE_PHASE_END(profileMark, PROFILE_PHASE_DISPLAY);
+#endif
 }
 
 /*
@@ -2751,6 +3817,9 @@ void InterruptService3() {
       // self test switch
       if (RPU_DataRead(ADDRESS_U10_A_CONTROL) & 0x80) {
          PushToSwitchStack(SW_SELF_TEST_SWITCH);
+#if defined(RPU_OS_RECORD_SWITCHES)
+         RecordSwitchEvent(SW_SELF_TEST_SWITCH);
+#endif
       }
       RPU_DataRead(ADDRESS_U10_A);
    }
@@ -2774,20 +3843,29 @@ void InterruptService3() {
    if ((u10BControl & 0x80) && (InsideZeroCrossingInterrupt == 0)) {
       InsideZeroCrossingInterrupt = InsideZeroCrossingInterrupt + 1;
 
-      uint8_t u10BControlLatest = RPU_DataRead(ADDRESS_U10_B_CONTROL);
+#if defined(RPU_OS_PROFILE_INTERRUPTS)
+      uint16_t profileStart = TCNT3;
+      uint16_t profileMark = profileStart;
+      uint16_t profileSwitchScanTicks = 0;
+      uint16_t profileTriggerLookupTicks = 0;
+#endif
+
+      uint8_t u10BControlLatest = PIAShadowRead(ADDRESS_U10_B_CONTROL);
 
       // Backup contents of U10A
-      uint8_t backup10A = RPU_DataRead(ADDRESS_U10_A);
+      uint8_t backup10A = PIAShadowRead(ADDRESS_U10_A);
 
       // Latch 0xFF separately without interrupt clear
-      RPU_DataWrite(ADDRESS_U10_A, 0xFF);
-      RPU_DataWrite(ADDRESS_U10_B_CONTROL, RPU_DataRead(ADDRESS_U10_B_CONTROL) | 0x08);
-      RPU_DataWrite(ADDRESS_U10_B_CONTROL, RPU_DataRead(ADDRESS_U10_B_CONTROL) & 0xF7);
+      ParkLampDecoders();
       // Read U10B to clear interrupt
       RPU_DataRead(ADDRESS_U10_B);
 
       // Turn off U10BControl interrupts
-      RPU_DataWrite(ADDRESS_U10_B_CONTROL, 0x30);
+      PIAWrite(ADDRESS_U10_B_CONTROL, 0x30);
+
+#if defined(RPU_OS_RECORD_SWITCHES)
+      RunSwitchScanHook();
+#endif
 
       // Copy old switch values
       uint8_t switchCount;
@@ -2800,86 +3878,85 @@ void InterruptService3() {
          // Enable switch strobe
 #if defined(RPU_USE_EXTENDED_SWITCHES_ON_PB4) or defined(RPU_USE_EXTENDED_SWITCHES_ON_PB7)
          if (switchCount < NUM_SWITCH_BYTES_ON_U10_PORT_A) {
-            RPU_DataWrite(ADDRESS_U10_A, 0x01 << switchCount);
+            PIAWrite(ADDRESS_U10_A, 0x01 << switchCount);
          } else {
             RPU_SetContinuousSolenoidBit(true, ST5_CONTINUOUS_SOLENOID_BIT);
          }
-#else
-         RPU_DataWrite(ADDRESS_U10_A, 0x01 << switchCount);
-#endif
 
          // Turn off U10:CB2 if it's on (because it strobes the last bank of dip switches
-         RPU_DataWrite(ADDRESS_U10_B_CONTROL, 0x34);
+         PIAWrite(ADDRESS_U10_B_CONTROL, 0x34);
+#else
+         // (and turn off U10:CB2 if it's on, because it strobes the last bank of dip switches)
+         const BusOp strobeOps[] = {{ADDRESS_U10_A, (uint8_t)(0x01 << switchCount)}, {ADDRESS_U10_B_CONTROL, 0x34}};
+         PIAWriteBurst(strobeOps, sizeof(strobeOps) / sizeof(BusOp));
+#endif
 
          // Delay for switch capacitors to charge
          delayMicroseconds(RPU_OS_SWITCH_DELAY_IN_MICROSECONDS);
 
          // Read the switches
          SwitchesNow[switchCount] = RPU_DataRead(ADDRESS_U10_B);
+#if defined(RPU_OS_RECORD_SWITCHES)
+         if (SwitchesNow[switchCount] != SwitchesMinus1[switchCount]) {
+            RecordSwitchChanges(switchCount, SwitchesMinus1[switchCount], SwitchesNow[switchCount]);
+         }
+#endif
 
          // Unset the strobe
-         RPU_DataWrite(ADDRESS_U10_A, 0x00);
+         PIAWrite(ADDRESS_U10_A, 0x00);
 #if defined(RPU_USE_EXTENDED_SWITCHES_ON_PB4) or defined(RPU_USE_EXTENDED_SWITCHES_ON_PB7)
          RPU_SetContinuousSolenoidBit(false, ST5_CONTINUOUS_SOLENOID_BIT);
 #endif
 
+#if defined(RPU_OS_PROFILE_INTERRUPTS)
+         PROFILE_LAP(profileMark, profileSwitchScanTicks);
+#endif
+
          // Some switches need to trigger immediate closures (bumpers & slings)
-         startingClosures = (SwitchesNow[switchCount]) & (~SwitchesMinus1[switchCount]);
-         bool immediateSolenoidFired = false;
-         // If one of the switches is starting to close (off, on)
+         startingClosures = (SwitchesNow[switchCount]) & (~SwitchesMinus1[switchCount]) & PrioritySwitchMask[switchCount];
+         // If one of the priority switches is starting to close (off, on)
          if (startingClosures) {
-            // Loop on bits of switch uint8_t
-            for (uint8_t bitCount = 0; bitCount < 8 && immediateSolenoidFired == false; bitCount++) {
-               // If this switch bit is closed
-               if (startingClosures & 0x01) {
-                  uint8_t startingSwitchNum = switchCount * 8 + bitCount;
-                  // Loop on immediate switch data
-                  for (int immediateSwitchCount = 0; immediateSwitchCount < NumGamePrioritySwitches && immediateSolenoidFired == false;
-                       immediateSwitchCount++) {
-                     // If this switch requires immediate action
-                     if (GameSwitches && startingSwitchNum == GameSwitches[immediateSwitchCount].switchNum) {
-                        // Start firing this solenoid (just one until the closure is validate
-                        PushToFrontOfSolenoidStack(GameSwitches[immediateSwitchCount].solenoid, 1);
-                        immediateSolenoidFired = true;
-                     }
-                  }
-               }
+            // Only the lowest closing switch in this byte fires right away
+            uint8_t startingSwitchNum = switchCount * 8;
+            while ((startingClosures & 0x01) == 0) {
                startingClosures = startingClosures >> 1;
+               startingSwitchNum += 1;
             }
+            // Start firing this solenoid (just one until the closure is validated)
+            PushToFrontOfSolenoidStack(SwitchTriggers[startingSwitchNum].solenoid, 1);
          }
 
-         immediateSolenoidFired = false;
          validClosures = (SwitchesNow[switchCount] & SwitchesMinus1[switchCount]) & ~SwitchesMinus2[switchCount];
          // If there is a valid switch closure (off, on, on)
          if (validClosures) {
+            uint8_t triggeredClosures = validClosures & TriggeredSwitchMask[switchCount];
+            uint8_t priorityClosures = validClosures & PrioritySwitchMask[switchCount];
             // Loop on bits of switch uint8_t
             for (uint8_t bitCount = 0; bitCount < 8; bitCount++) {
                // If this switch bit is closed
                if (validClosures & 0x01) {
                   uint8_t validSwitchNum = switchCount * 8 + bitCount;
-                  // Loop through all switches and see what's triggered
-                  for (int validSwitchCount = 0; validSwitchCount < NumGameSwitches; validSwitchCount++) {
-                     // If we've found a valid closed switch
-                     if (GameSwitches && GameSwitches[validSwitchCount].switchNum == validSwitchNum) {
-                        // If we're supposed to trigger a solenoid, then do it
-                        if (GameSwitches[validSwitchCount].solenoid != SOL_NONE) {
-                           if (validSwitchCount < NumGamePrioritySwitches && immediateSolenoidFired == false) {
-                              PushToFrontOfSolenoidStack(GameSwitches[validSwitchCount].solenoid,
-                                                         GameSwitches[validSwitchCount].solenoidHoldTime);
-                           } else {
-                              RPU_PushToSolenoidStack(GameSwitches[validSwitchCount].solenoid,
-                                                      GameSwitches[validSwitchCount].solenoidHoldTime);
-                           }
-                        } // End if this is a real solenoid
-                     } // End if this is a switch in the switch table
-                  } // End loop on switches in switch table
+                  // If we're supposed to trigger a solenoid, then do it
+                  if (triggeredClosures & 0x01) {
+                     if (priorityClosures & 0x01) {
+                        PushToFrontOfSolenoidStack(SwitchTriggers[validSwitchNum].solenoid, SwitchTriggers[validSwitchNum].solenoidHoldTime);
+                     } else {
+                        PushToSolenoidStack(SwitchTriggers[validSwitchNum].solenoid, SwitchTriggers[validSwitchNum].solenoidHoldTime, false);
+                     }
+                  }
                   // Push this switch to the game rules stack
                   PushToSwitchStack(validSwitchNum);
                }
                validClosures = validClosures >> 1;
+               triggeredClosures = triggeredClosures >> 1;
+               priorityClosures = priorityClosures >> 1;
             }
          }
 
+#if defined(RPU_OS_PROFILE_INTERRUPTS)
+         PROFILE_LAP(profileMark, profileTriggerLookupTicks);
+#endif
+
          // There are no port reads or writes for the rest of the loop,
          // so we can allow the display interrupt to fire
          interrupts();
@@ -2888,8 +3965,18 @@ void InterruptService3() {
          delayMicroseconds(RPU_OS_TIMING_LOOP_PADDING_IN_MICROSECONDS);
 
          noInterrupts();
+
+#if defined(RPU_OS_PROFILE_INTERRUPTS)
+         PROFILE_LAP(profileMark, profileSwitchScanTicks);
+#endif
       }
-      RPU_DataWrite(ADDRESS_U10_A, backup10A);
+      PIAWrite(ADDRESS_U10_A, backup10A);
+
+#if defined(RPU_OS_PROFILE_INTERRUPTS)
+      RecordInterruptProfile(PROFILE_PHASE_SWITCH_SCAN, profileSwitchScanTicks);
+      RecordInterruptProfile(PROFILE_PHASE_TRIGGER_LOOKUP, profileTriggerLookupTicks);
+      profileMark = TCNT3;
+#endif
 
       if (NumCyclesBeforeRevertingSolenoidByte != 0) {
          NumCyclesBeforeRevertingSolenoidByte -= 1;
@@ -2901,35 +3988,43 @@ void InterruptService3() {
 
 #ifdef RPU_OS_USE_DASH32
       // mask out sound E line
-      uint8_t curDisplayDigitEnableByte = RPU_DataRead(ADDRESS_U11_A);
-      RPU_DataWrite(ADDRESS_U11_A, curDisplayDigitEnableByte | 0x02);
+      uint8_t curDisplayDigitEnableByte = PIAShadowRead(ADDRESS_U11_A);
+      PIAWrite(ADDRESS_U11_A, curDisplayDigitEnableByte | 0x02);
 #endif
 
       // If we need to turn off momentary solenoids, do it first
       uint8_t momentarySolenoidAtStart = PullFirstFromSolenoidStack();
       if (momentarySolenoidAtStart != SOLENOID_STACK_EMPTY) {
          CurrentSolenoidByte = (CurrentSolenoidByte & 0xF0) | momentarySolenoidAtStart;
-         RPU_DataWrite(ADDRESS_U11_B, CurrentSolenoidByte);
+         PIAWrite(ADDRESS_U11_B, CurrentSolenoidByte);
 #ifdef RPU_OS_USE_DASH32
          // Raise CB2 so we don't unset the solenoid we just set
-         RPU_DataWrite(ADDRESS_U11_B_CONTROL, 0x3C);
+         PIAWrite(ADDRESS_U11_B_CONTROL, 0x3C);
          // Mask off sound lines
-         RPU_DataWrite(ADDRESS_U11_B, CurrentSolenoidByte | SOL_NONE);
+         PIAWrite(ADDRESS_U11_B, CurrentSolenoidByte | SOL_NONE);
          // Put CB2 back low
-         RPU_DataWrite(ADDRESS_U11_B_CONTROL, 0x34);
+         PIAWrite(ADDRESS_U11_B_CONTROL, 0x34);
          // Put solenoids back again
-         RPU_DataWrite(ADDRESS_U11_B, CurrentSolenoidByte);
+         PIAWrite(ADDRESS_U11_B, CurrentSolenoidByte);
 #endif
       } else {
          CurrentSolenoidByte = (CurrentSolenoidByte & 0xF0) | SOL_NONE;
-         RPU_DataWrite(ADDRESS_U11_B, CurrentSolenoidByte);
+         PIAWrite(ADDRESS_U11_B, CurrentSolenoidByte);
       }
 
 #ifdef RPU_OS_USE_DASH32
       // put back U11 A without E line
-      RPU_DataWrite(ADDRESS_U11_A, curDisplayDigitEnableByte);
+      PIAWrite(ADDRESS_U11_A, curDisplayDigitEnableByte);
 #endif
 
+#if defined(RPU_OS_PROFILE_INTERRUPTS)
+      PROFILE_PHASE_END(profileMark, PROFILE_PHASE_SOLENOIDS);
+#endif
+
+      // Lamps held off for this pass of the brightness frame
+      volatile RPUFrame* shownFrame = &Frames[ShownFrameIndex];
+      volatile uint8_t* lampBrightnessPlane = shownFrame->LampBrightnessPlanes[pgm_read_byte(&LampPlaneForPass[numberOfU10Interrupts & 0x07])];
+
       for (int lampByteCount = 0; lampByteCount < 8; lampByteCount++) {
          for (uint8_t nibbleCount = 0; nibbleCount < 2; nibbleCount++) {
             // We skip iteration number 16 because the last position is to park the lamps
@@ -2939,52 +4034,48 @@ void InterruptService3() {
 
             uint8_t lampData = 0xF0 + (lampByteCount * 2) + nibbleCount;
 
+            // Use the inhibit lines to set the actual data to the lamp SCRs
+            // (here, we don't care about the lower nibble because the address was already latched)
+            uint8_t nibbleOffset = (nibbleCount) ? 1 : 16;
+            uint8_t lampOutput = ((shownFrame->LampStates[lampByteCount] | lampBrightnessPlane[lampByteCount]) * nibbleOffset);
+
+            // The display interrupt gets its chance between nibbles
             interrupts();
-            RPU_DataWrite(ADDRESS_U10_A, 0xFF);
+            PIAWrite(ADDRESS_U10_A, 0xFF);
             noInterrupts();
 
-            // Latch address & strobe
-            RPU_DataWrite(ADDRESS_U10_A, lampData);
 #ifdef RPU_SLOW_DOWN_LAMP_STROBE
+            // Latch address & strobe
+            PIAWrite(ADDRESS_U10_A, lampData);
             delayMicroseconds(2);
-#endif
 
-            RPU_DataWrite(ADDRESS_U10_B_CONTROL, 0x38);
-#ifdef RPU_SLOW_DOWN_LAMP_STROBE
+            PIAWrite(ADDRESS_U10_B_CONTROL, 0x38);
             delayMicroseconds(2);
-#endif
 
-            RPU_DataWrite(ADDRESS_U10_B_CONTROL, 0x30);
-#ifdef RPU_SLOW_DOWN_LAMP_STROBE
+            PIAWrite(ADDRESS_U10_B_CONTROL, 0x30);
             delayMicroseconds(2);
-#endif
-
-            // Use the inhibit lines to set the actual data to the lamp SCRs
-            // (here, we don't care about the lower nibble because the address was already latched)
-            uint8_t nibbleOffset = (nibbleCount) ? 1 : 16;
-            uint8_t lampOutput = (LampStates[lampByteCount] * nibbleOffset);
-            // Every other time through the cycle, we OR in the dim variable
-            // in order to dim those lights
-            if (numberOfU10Interrupts % DimDivisor1) {
-               lampOutput |= (LampDim1[lampByteCount] * nibbleOffset);
-            }
-            if (numberOfU10Interrupts % DimDivisor2) {
-               lampOutput |= (LampDim2[lampByteCount] * nibbleOffset);
-            }
 
-            RPU_DataWrite(ADDRESS_U10_A, lampOutput | 0x0F);
-#ifdef RPU_SLOW_DOWN_LAMP_STROBE
+            PIAWrite(ADDRESS_U10_A, lampOutput | 0x0F);
             delayMicroseconds(2);
+#else
+            // Latch address & strobe, then put the data on the inhibit lines
+            const BusOp lampOps[] = {{ADDRESS_U10_A, lampData},
+                                     {ADDRESS_U10_B_CONTROL, 0x38},
+                                     {ADDRESS_U10_B_CONTROL, 0x30},
+                                     {ADDRESS_U10_A, (uint8_t)(lampOutput | 0x0F)}};
+            PIAWriteBurst(lampOps, sizeof(lampOps) / sizeof(BusOp));
 #endif
          } // end loop on nibble
       } // end loop on lamp bytes
 
+#if defined(RPU_OS_PROFILE_INTERRUPTS)
+      PROFILE_PHASE_END(profileMark, PROFILE_PHASE_LAMPS);
+#endif
+
 #ifdef RPU_OS_USE_AUX_LAMPS
       // Latch 0xFF separately without interrupt clear
       // to park 0xFF in main lamp board
-      RPU_DataWrite(ADDRESS_U10_A, 0xFF);
-      RPU_DataWrite(ADDRESS_U10_B_CONTROL, RPU_DataRead(ADDRESS_U10_B_CONTROL) | 0x08);
-      RPU_DataWrite(ADDRESS_U10_B_CONTROL, RPU_DataRead(ADDRESS_U10_B_CONTROL) & 0xF7);
+      ParkLampDecoders();
 
       // For the first four bits of lamps, we're going to look at LampStates[7] again
       // and use those top 4 bits that we didn't use before. Then we're going
@@ -2996,49 +4087,53 @@ void InterruptService3() {
                nibbleCount = 1; // skip the first nibble of uint8_t 7 because it belongs to primary lamps
             }
             uint8_t nibbleOffset = (nibbleCount) ? 1 : 16;
-            uint8_t lampOutput = (LampStates[lampByteCount] * nibbleOffset);
-            // Every other time through the cycle, we OR in the dim variable
-            // in order to dim those lights
-            if (numberOfU10Interrupts % DimDivisor1) {
-               lampOutput |= (LampDim1[lampByteCount] * nibbleOffset);
-            }
-            if (numberOfU10Interrupts % DimDivisor2) {
-               lampOutput |= (LampDim2[lampByteCount] * nibbleOffset);
-            }
+            uint8_t lampOutput = ((shownFrame->LampStates[lampByteCount] | lampBrightnessPlane[lampByteCount]) * nibbleOffset);
 
             // The data will be in the upper nibble, but we need the bank count in the lower
             lampOutput &= 0xF0;
             lampOutput += auxBankNum;
 
             interrupts();
-            RPU_DataWrite(ADDRESS_U10_A, 0xFF);
+            PIAWrite(ADDRESS_U10_A, 0xFF);
             noInterrupts();
 
-            RPU_DataWrite(ADDRESS_U10_A, lampOutput | 0xF0);
-            RPU_DataWrite(ADDRESS_U11_A_CONTROL, RPU_DataRead(ADDRESS_U11_A_CONTROL) | 0x08);
-            RPU_DataWrite(ADDRESS_U11_A_CONTROL, RPU_DataRead(ADDRESS_U11_A_CONTROL) & 0xF7);
-            RPU_DataWrite(ADDRESS_U10_A, lampOutput);
+            uint8_t u11AControl = PIAShadowRead(ADDRESS_U11_A_CONTROL);
+            const BusOp auxLampOps[] = {{ADDRESS_U10_A, (uint8_t)(lampOutput | 0xF0)},
+                                        {ADDRESS_U11_A_CONTROL, (uint8_t)(u11AControl | 0x08)},
+                                        {ADDRESS_U11_A_CONTROL, (uint8_t)(u11AControl & 0xF7)},
+                                        {ADDRESS_U10_A, lampOutput}};
+            PIAWriteBurst(auxLampOps, sizeof(auxLampOps) / sizeof(BusOp));
 
             auxBankNum += 1;
          }
       }
+
+#if defined(RPU_OS_PROFILE_INTERRUPTS)
+      PROFILE_PHASE_END(profileMark, PROFILE_PHASE_AUX_LAMPS);
+#endif
 #endif
 
       // Latch 0xFF separately without interrupt clear
-      RPU_DataWrite(ADDRESS_U10_A, 0xFF);
-      RPU_DataWrite(ADDRESS_U10_B_CONTROL, RPU_DataRead(ADDRESS_U10_B_CONTROL) | 0x08);
-      RPU_DataWrite(ADDRESS_U10_B_CONTROL, RPU_DataRead(ADDRESS_U10_B_CONTROL) & 0xF7);
+      ParkLampDecoders();
 
       interrupts();
       noInterrupts();
 
       InsideZeroCrossingInterrupt = 0;
-      RPU_DataWrite(ADDRESS_U10_A, backup10A);
-      RPU_DataWrite(ADDRESS_U10_B_CONTROL, u10BControlLatest);
+      const BusOp restoreOps[] = {{ADDRESS_U10_A, backup10A}, {ADDRESS_U10_B_CONTROL, u10BControlLatest}};
+      PIAWriteBurst(restoreOps, sizeof(restoreOps) / sizeof(BusOp));
 
       // Read U10B to clear interrupt
       RPU_DataRead(ADDRESS_U10_B);
       numberOfU10Interrupts += 1;
+#if defined(RPU_OS_RECORD_SWITCHES)
+      SwitchScanNumber += 1;
+      SwitchMatrixScanned = true;
+#endif
+
+#if defined(RPU_OS_PROFILE_INTERRUPTS)
+      RecordInterruptProfile(PROFILE_PHASE_ZERO_CROSSING, TCNT3 - profileStart);
+#endif
    }
 }
 
@@ -3066,8 +4161,19 @@ void RPU_HookInterrupts() {
    TCCR1B |= (1 << CS12) | (1 << CS10);
    // enable timer compare interrupt
    TIMSK1 |= (1 << OCIE1A);
+
+#if defined(RPU_OS_PROFILE_INTERRUPTS)
+   // Timer 3 free-runs at clk/8 as the time base for the profiler
+   TCCR3A = 0;
+   TCCR3B = (1 << CS31);
+   TCNT3 = 0;
+#endif
    sei();
 
+#if defined(RPU_OS_PROFILE_INTERRUPTS)
+   RPU_ResetInterruptProfile();
+#endif
+
    attachInterrupt(digitalPinToInterrupt(2), InterruptService3, LOW);
 }
 
@@ -3152,9 +4258,9 @@ bool CheckCreditResetSwitchArch1(uint8_t creditResetSwitch) {
 
    uint8_t strobeNum = 0x01 << (creditResetSwitch / 8);
    uint8_t switchNum = 0x01 << (creditResetSwitch % 8);
-   RPU_DataWrite(ADDRESS_U10_A, strobeNum);
+   PIAWrite(ADDRESS_U10_A, strobeNum);
    // Turn off U10:CB2 if it's on (because it strobes the last bank of dip switches
-   RPU_DataWrite(ADDRESS_U10_B_CONTROL, 0x34);
+   PIAWrite(ADDRESS_U10_B_CONTROL, 0x34);
 
    // Delay for switch capacitors to charge
    delayMicroseconds(RPU_OS_SWITCH_DELAY_IN_MICROSECONDS);
@@ -3163,7 +4269,7 @@ bool CheckCreditResetSwitchArch1(uint8_t creditResetSwitch) {
    uint8_t curSwitchByte = RPU_DataRead(ADDRESS_U10_B);
 
    // Unset the strobe
-   RPU_DataWrite(ADDRESS_U10_A, 0x00);
+   PIAWrite(ADDRESS_U10_A, 0x00);
 
    if (curSwitchByte & switchNum) {
       return true;
@@ -3413,11 +4519,9 @@ unsigned long RPU_InitializeMPUArch1(unsigned long initOptions, uint8_t creditRe
 #if (RPU_MPU_ARCHITECTURE >= 10)
 
 bool CheckSwitchStack(uint8_t switchNum) {
-   for (uint8_t stackIndex = SwitchStackFirst; stackIndex != SwitchStackLast; stackIndex++) {
-      if (stackIndex >= SWITCH_STACK_SIZE) {
-         stackIndex = 0;
-      }
-      if (SwitchStack[stackIndex] == switchNum) {
+   uint8_t numEntries = SwitchStack.GetCount();
+   for (uint8_t offset = 0; offset < numEntries; offset++) {
+      if (SwitchStack.Peek(offset).switchNumber == switchNum) {
          return true;
       }
    }
@@ -3430,9 +4534,9 @@ volatile uint8_t DisplayStrobe = 0;
 volatile uint8_t InterruptPass = 0;
 bool NeedToTurnOffTriggeredSolenoids = true;
 #if (RPU_OS_NUM_DIGITS == 6)
-uint8_t BlankingBit[16] = {0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x01, 0x02, 0x01, 0x02, 0x04, 0x08, 0x010, 0x20, 0x01, 0x02};
+const uint8_t BlankingBit[16] PROGMEM = {0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x01, 0x02, 0x01, 0x02, 0x04, 0x08, 0x010, 0x20, 0x01, 0x02};
 #elif (RPU_OS_NUM_DIGITS == 7)
-uint8_t BlankingBit[16] = {0x01, 0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x02, 0x01, 0x02, 0x04, 0x08, 0x010, 0x20, 0x40};
+const uint8_t BlankingBit[16] PROGMEM = {0x01, 0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x02, 0x01, 0x02, 0x04, 0x08, 0x010, 0x20, 0x40};
 #endif
 volatile uint8_t UpDownPassCounter = 0;
 
@@ -3454,11 +4558,13 @@ ISR(TIMER1_COMPA_vect) { // This is the interrupt request (running at 965.3 Hz)
       }
    }
 
+   volatile RPUFrame* shownFrame = &Frames[ShownFrameIndex];
+
 #if (RPU_MPU_ARCHITECTURE == 15)
    // Create display data
    unsigned int digit1 = 0x0000;
    uint8_t digit2 = 0x00;
-   uint8_t blankingBit = BlankingBit[DisplayStrobe];
+   uint8_t blankingBit = pgm_read_byte(&BlankingBit[DisplayStrobe]);
    if (DisplayStrobe == 0) {
       if (DisplayBIPDigitEnable & blankingBit) {
          digit1 = DisplayBIPDigits[0];
@@ -3467,11 +4573,11 @@ ISR(TIMER1_COMPA_vect) { // This is the interrupt request (running at 965.3 Hz)
          digit2 = DisplayCreditDigits[0];
       }
    } else if (DisplayStrobe < 8) {
-      if (DisplayDigitEnable[0] & blankingBit) {
-         digit1 = FourteenSegmentASCII[DisplayText[0][DisplayStrobe - 1]];
+      if (shownFrame->DisplayDigitEnable[0] & blankingBit) {
+         digit1 = pgm_read_word(&FourteenSegmentASCII[shownFrame->DisplayText[0][DisplayStrobe - 1]]);
       }
-      if (DisplayDigitEnable[2] & blankingBit) {
-         digit2 = DisplayDigits[2][DisplayStrobe - 1];
+      if (shownFrame->DisplayDigitEnable[2] & blankingBit) {
+         digit2 = shownFrame->DisplayDigits[2][DisplayStrobe - 1];
       }
    } else if (DisplayStrobe == 8) {
       if (DisplayBIPDigitEnable & blankingBit) {
@@ -3481,11 +4587,11 @@ ISR(TIMER1_COMPA_vect) { // This is the interrupt request (running at 965.3 Hz)
          digit2 = DisplayCreditDigits[1];
       }
    } else {
-      if (DisplayDigitEnable[1] & blankingBit) {
-         digit1 = FourteenSegmentASCII[DisplayText[1][DisplayStrobe - 9]];
+      if (shownFrame->DisplayDigitEnable[1] & blankingBit) {
+         digit1 = pgm_read_word(&FourteenSegmentASCII[shownFrame->DisplayText[1][DisplayStrobe - 9]]);
       }
-      if (DisplayDigitEnable[3] & blankingBit) {
-         digit2 = DisplayDigits[3][DisplayStrobe - 9];
+      if (shownFrame->DisplayDigitEnable[3] & blankingBit) {
+         digit2 = shownFrame->DisplayDigits[3][DisplayStrobe - 9];
       }
    }
    // Show current display digit
@@ -3496,7 +4602,7 @@ ISR(TIMER1_COMPA_vect) { // This is the interrupt request (running at 965.3 Hz)
 #elif (RPU_MPU_ARCHITECTURE == 13)
    // Create display data
    uint8_t digit1 = 0x0F, digit2 = 0x0F;
-   uint8_t blankingBit = BlankingBit[DisplayStrobe];
+   uint8_t blankingBit = pgm_read_byte(&BlankingBit[DisplayStrobe]);
    bool comma12 = false, comma34 = false;
 
    if (DisplayStrobe == 0) {
@@ -3507,11 +4613,11 @@ ISR(TIMER1_COMPA_vect) { // This is the interrupt request (running at 965.3 Hz)
          digit2 = DisplayCreditDigits[0];
       }
    } else if (DisplayStrobe < 8) {
-      if (DisplayDigitEnable[0] & blankingBit) {
-         digit1 = DisplayDigits[0][DisplayStrobe - 1];
+      if (shownFrame->DisplayDigitEnable[0] & blankingBit) {
+         digit1 = shownFrame->DisplayDigits[0][DisplayStrobe - 1];
       }
-      if (DisplayDigitEnable[2] & blankingBit) {
-         digit2 = DisplayDigits[2][DisplayStrobe - 1];
+      if (shownFrame->DisplayDigitEnable[2] & blankingBit) {
+         digit2 = shownFrame->DisplayDigits[2][DisplayStrobe - 1];
       }
 
       if (DisplayStrobe == 1) {
@@ -3538,11 +4644,11 @@ ISR(TIMER1_COMPA_vect) { // This is the interrupt request (running at 965.3 Hz)
          digit2 = DisplayCreditDigits[1];
       }
    } else {
-      if (DisplayDigitEnable[1] & blankingBit) {
-         digit1 = DisplayDigits[1][DisplayStrobe - 9];
+      if (shownFrame->DisplayDigitEnable[1] & blankingBit) {
+         digit1 = shownFrame->DisplayDigits[1][DisplayStrobe - 9];
       }
-      if (DisplayDigitEnable[3] & blankingBit) {
-         digit2 = DisplayDigits[3][DisplayStrobe - 9];
+      if (shownFrame->DisplayDigitEnable[3] & blankingBit) {
+         digit2 = shownFrame->DisplayDigits[3][DisplayStrobe - 9];
       }
 
       if (DisplayStrobe == 9) {
@@ -3578,24 +4684,24 @@ ISR(TIMER1_COMPA_vect) { // This is the interrupt request (running at 965.3 Hz)
 #else
    // Create display data
    uint8_t digit1 = 0x0F, digit2 = 0x0F;
-   uint8_t blankingBit = BlankingBit[DisplayStrobe];
+   uint8_t blankingBit = pgm_read_byte(&BlankingBit[DisplayStrobe]);
    if (DisplayStrobe < 6) {
-      if (DisplayDigitEnable[0] & blankingBit) {
-         digit1 = DisplayDigits[0][DisplayStrobe];
+      if (shownFrame->DisplayDigitEnable[0] & blankingBit) {
+         digit1 = shownFrame->DisplayDigits[0][DisplayStrobe];
       }
-      if (DisplayDigitEnable[2] & blankingBit) {
-         digit2 = DisplayDigits[2][DisplayStrobe];
+      if (shownFrame->DisplayDigitEnable[2] & blankingBit) {
+         digit2 = shownFrame->DisplayDigits[2][DisplayStrobe];
       }
    } else if (DisplayStrobe < 8) {
       if (DisplayBIPDigitEnable & blankingBit) {
          digit1 = DisplayBIPDigits[DisplayStrobe - 6];
       }
    } else if (DisplayStrobe < 14) {
-      if (DisplayDigitEnable[1] & blankingBit) {
-         digit1 = DisplayDigits[1][DisplayStrobe - 8];
+      if (shownFrame->DisplayDigitEnable[1] & blankingBit) {
+         digit1 = shownFrame->DisplayDigits[1][DisplayStrobe - 8];
       }
-      if (DisplayDigitEnable[3] & blankingBit) {
-         digit2 = DisplayDigits[3][DisplayStrobe - 8];
+      if (shownFrame->DisplayDigitEnable[3] & blankingBit) {
+         digit2 = shownFrame->DisplayDigits[3][DisplayStrobe - 8];
       }
    } else {
       if (DisplayCreditDigitEnable & blankingBit) {
@@ -3615,13 +4721,7 @@ ISR(TIMER1_COMPA_vect) { // This is the interrupt request (running at 965.3 Hz)
 
    if (InterruptPass == 0) {
       // Show lamps
-      uint8_t curLampByte = LampStates[LampStrobe];
-      if (LampPass % DimDivisor1) {
-         curLampByte |= LampDim1[LampStrobe];
-      }
-      if (LampPass % DimDivisor2) {
-         curLampByte |= LampDim2[LampStrobe];
-      }
+      uint8_t curLampByte = shownFrame->LampStates[LampStrobe] | shownFrame->LampBrightnessPlanes[pgm_read_byte(&LampPlaneForPass[LampPass & 0x07])][LampStrobe];
       RPU_DataWrite(PIA_LAMPS_PORT_B, 0x01 << (LampStrobe));
       RPU_DataWrite(PIA_LAMPS_PORT_A, curLampByte);
 
@@ -3637,12 +4737,18 @@ ISR(TIMER1_COMPA_vect) { // This is the interrupt request (running at 965.3 Hz)
          // If the diagnostic switch isn't on the stack already, put it there
          if (!CheckSwitchStack(SW_SELF_TEST_SWITCH)) {
             PushToSwitchStack(SW_SELF_TEST_SWITCH);
+#if defined(RPU_OS_RECORD_SWITCHES)
+            RecordSwitchEvent(SW_SELF_TEST_SWITCH);
+#endif
          }
          // Clear the interrupt
          RPU_DataRead(PIA_DISPLAY_PORT_A);
       }
 
       // Check switches
+#if defined(RPU_OS_RECORD_SWITCHES)
+      RunSwitchScanHook();
+#endif
       uint8_t switchColStrobe = 1;
       for (uint8_t switchCol = 0; switchCol < 8; switchCol++) {
          // Cycle the debouncing variables
@@ -3654,8 +4760,17 @@ ISR(TIMER1_COMPA_vect) { // This is the interrupt request (running at 965.3 Hz)
          delayMicroseconds(12);
          // Read switch input
          SwitchesNow[switchCol] = RPU_DataRead(PIA_SWITCH_PORT_A);
+#if defined(RPU_OS_RECORD_SWITCHES)
+         if (SwitchesNow[switchCol] != SwitchesMinus1[switchCol]) {
+            RecordSwitchChanges(switchCol, SwitchesMinus1[switchCol], SwitchesNow[switchCol]);
+         }
+#endif
          switchColStrobe *= 2;
       }
+#if defined(RPU_OS_RECORD_SWITCHES)
+      SwitchScanNumber += 1;
+      SwitchMatrixScanned = true;
+#endif
       RPU_DataWrite(PIA_SWITCH_PORT_B, 0);
 
       // If there are any closures, add them to the switch stack
@@ -3985,16 +5100,28 @@ unsigned long RPU_InitializeMPUArch10(unsigned long initOptions, uint8_t creditR
 unsigned long LastSwitchReport = 0;
 #endif
 
-void RPU_Update(unsigned long currentTime) {
+void RPU_UpdateTimedStacks(unsigned long currentTime) {
    if (RPU_MPU_ARCHITECTURE == 1) {
       RPU_DataRead(0);
    }
 
-   RPU_ApplyFlashToLamps(currentTime);
    RPU_UpdateTimedSolenoidStack(currentTime);
 #if (RPU_MPU_ARCHITECTURE >= 10) && (defined(RPU_OS_USE_WTYPE_1_SOUND) || defined(RPU_OS_USE_WTYPE_2_SOUND))
    RPU_UpdateTimedSoundStack(currentTime);
 #endif
+#if defined(RPU_OS_USE_EEPROM_CACHE)
+   RPU_UpdateEEPromCache();
+#endif
+#if defined(RPU_OS_RECORD_SWITCHES)
+   RPU_UpdateSwitchRecording();
+#endif
+}
+
+void RPU_Update(unsigned long currentTime) {
+   RPU_UpdateTimedStacks(currentTime);
+   RPU_ApplyFlashToLamps(currentTime);
+   RPU_UpdateDisplayEffects(currentTime);
+   RPU_CommitFrame();
 }
 
 // This function should eventually support auto-detect and initialize the appropriate
@@ -32,6 +32,12 @@ struct PlayfieldAndCabinetSwitch {
    uint8_t solenoidHoldTime;
 };
 
+// One write in a burst (see RPU_DataWriteBurst)
+struct BusOp {
+   uint16_t address;
+   uint8_t data;
+};
+
 #define SW_SELF_TEST_SWITCH 0x7F
 #define SOL_NONE 0x0F
 #define SWITCH_STACK_EMPTY 0xFF
@@ -78,14 +84,27 @@ struct PlayfieldAndCabinetSwitch {
 unsigned long RPU_InitializeMPU(unsigned long initOptions = RPU_CMD_BOOT_ORIGINAL_IF_CREDIT_RESET |
                                                             RPU_CMD_BOOT_ORIGINAL_IF_NOT_SWITCH_CLOSED | RPU_CMD_PERFORM_MPU_TEST,
                                 uint8_t creditResetSwitch = 0xFF);
-void RPU_SetupGameSwitches(int s_numSwitches, int s_numPrioritySwitches, const PlayfieldAndCabinetSwitch* s_gameSwitchArray);
+// The switch array is only read here, so it can live in PROGMEM (pass s_arrayInProgmem = true)
+void RPU_SetupGameSwitches(int s_numSwitches, int s_numPrioritySwitches, const PlayfieldAndCabinetSwitch* s_gameSwitchArray,
+                           bool s_arrayInProgmem = false);
 uint8_t RPU_GetDipSwitches(uint8_t index);
 
 // EEProm Helper Functions
-uint8_t RPU_ReadByteFromEEProm(unsigned short startByte);
+// A value that has never been written (0xFF) is set to the default
+uint8_t RPU_ReadByteFromEEProm(unsigned short startByte, uint8_t defaultValue = 0);
 void RPU_WriteByteToEEProm(unsigned short startByte, uint8_t value);
 unsigned long RPU_ReadULFromEEProm(unsigned short startByte, unsigned long defaultValue = 0);
 void RPU_WriteULToEEProm(unsigned short startByte, unsigned long value);
+#if defined(RPU_OS_USE_EEPROM_CACHE)
+// Once loaded, the helpers above read & write a RAM copy of the first
+// RPU_EEPROM_CACHE_SIZE bytes, and RPU_Update writes changed bytes back
+// one at a time when the EEPROM isn't busy. Flush before anything that
+// might not come back to RPU_Update (like running the original code).
+void RPU_LoadEEPromCache();
+void RPU_UpdateEEPromCache();
+void RPU_FlushEEPromCache();
+unsigned short RPU_GetEEPromCacheNumDirty();
+#endif
 
 //   Swtiches
 uint8_t RPU_PullFirstFromSwitchStack();
@@ -93,6 +112,28 @@ bool RPU_ReadSingleSwitchState(uint8_t switchNum);
 void RPU_PushToSwitchStack(uint8_t switchNumber);
 bool RPU_GetUpDownSwitchState(); // This always returns true for RPU_MPU_ARCHITECTURE==1 (no up/down switch)
 void RPU_ClearUpDownSwitchState();
+uint8_t RPU_GetSwitchStackPeak(); // Most switches that have been waiting on the stack at once
+unsigned long RPU_GetSwitchStackDrops(); // Switches lost because the switch stack was full
+#if defined(RPU_OS_RECORD_SWITCHES)
+// Streams every change the switch scan sees, tagged with the scan that saw
+// it, to the writer (a serial port, or a logger on an SD card). The stream
+// is a 5-byte header ('R', 'S', 1, starting scan low & high byte) and then:
+//   deltaScans switchCode   - a change, deltaScans after the one before
+//                             (switchCode bit 7 is set if the switch opened)
+//   0xFF                    - 255 scans went by
+// The host build can replay it (--replay). RPU_Update passes events on to
+// the writer, and they're dropped if more than 32 pile up in between.
+typedef void (*RPUSwitchRecordWriter)(const uint8_t* data, uint8_t numBytes);
+void RPU_StartSwitchRecording(RPUSwitchRecordWriter writer);
+void RPU_StopSwitchRecording();
+void RPU_UpdateSwitchRecording();
+uint16_t RPU_GetSwitchScanNumber();
+unsigned long RPU_GetSwitchRecordDrops();
+// The hook is called from the interrupt just before each switch scan, with
+// that scan's number, so a recording can be played back into the matrix
+typedef void (*RPUSwitchScanHook)(uint16_t scanNumber);
+void RPU_SetSwitchScanHook(RPUSwitchScanHook hook);
+#endif
 
 //   Solenoids
 void RPU_PushToSolenoidStack(uint8_t solenoidNumber, uint8_t numPushes, bool disableOverride = false);
@@ -108,10 +149,26 @@ void RPU_DisableSolenoidStack();
 void RPU_EnableSolenoidStack();
 bool RPU_PushToTimedSolenoidStack(uint8_t solenoidNumber, uint8_t numPushes, unsigned long whenToFire, bool disableOverride = false);
 void RPU_UpdateTimedSolenoidStack(unsigned long curTime);
+unsigned long RPU_GetTimedSolenoidStackDrops(); // Timed requests lost because the timed stack was full
+unsigned long RPU_GetSolenoidStackDrops(); // Requests lost because the solenoid stack was full
+uint8_t RPU_GetSolenoidStackPeak();
+
+//   Packed BCD
+// One decimal digit per nibble (ones in the low nibble), so scores can be
+// added up and shown without dividing by 10. Packed values compare the
+// same way the numbers they hold do.
+typedef uint32_t RPUBCD;
+#define RPU_BCD_MAX_VALUE 99999999
+RPUBCD RPU_BCDFromValue(unsigned long value); // Saturates at RPU_BCD_MAX_VALUE
+unsigned long RPU_BCDToValue(RPUBCD bcd);
+RPUBCD RPU_BCDAdd(RPUBCD bcd1, RPUBCD bcd2); // Saturates at RPU_BCD_MAX_VALUE
+uint8_t RPU_BCDMagnitude(RPUBCD bcd);         // Number of digits (0 for 0)
 
 //   Displays
 uint8_t RPU_SetDisplay(int displayNumber, unsigned long value, bool blankByMagnitude = false, uint8_t minDigits = 2,
                        bool showCommasByMagnitude = false);
+uint8_t RPU_SetDisplayBCD(int displayNumber, RPUBCD value, bool blankByMagnitude = false, uint8_t minDigits = 2,
+                          bool showCommasByMagnitude = false);
 void RPU_SetDisplayBlank(int displayNumber, uint8_t bitMask);
 void RPU_SetDisplayCredits(int value, bool displayOn = true, bool showBothDigits = true);
 void RPU_SetDisplayMatch(int value, bool displayOn = true, bool showBothDigits = true);
@@ -120,6 +177,23 @@ void RPU_SetDisplayFlash(int displayNumber, unsigned long value, unsigned long c
 void RPU_SetDisplayFlashCredits(unsigned long curTime, int period = 100);
 void RPU_CycleAllDisplays(unsigned long curTime, uint8_t digitNum = 0); // Self-test function
 uint8_t RPU_GetDisplayBlank(int displayNumber);
+
+//   Display effects
+// RPU_Update animates these on the score displays, so the game only has
+// to say what a display should show when that changes (setting the same
+// effect again does nothing). Setting a display any other way stops its
+// effect. Effects step every stepTime ms counted from startTime.
+#define RPU_DISPLAY_EFFECT_NONE 0   // The game sets the display itself
+#define RPU_DISPLAY_EFFECT_STATIC 1 // The value
+#define RPU_DISPLAY_EFFECT_OFF 2    // Blank
+#define RPU_DISPLAY_EFFECT_FLASH 3  // The value, blanked on even steps
+#define RPU_DISPLAY_EFFECT_DASH 4   // Digits wipe off & back on, then the value (36 steps)
+#define RPU_DISPLAY_EFFECT_SCROLL 5 // A value too long for the display, held 16 steps then scrolled (16 steps)
+#define RPU_DISPLAY_EFFECT_BOUNCE 6 // A short value moving back and forth across the display
+void RPU_SetDisplayEffect(int displayNumber, uint8_t effect, unsigned long value = 0, unsigned long startTime = 0,
+                          unsigned int stepTime = 250, uint8_t minDigits = 2);
+uint8_t RPU_GetDisplayEffect(int displayNumber);
+void RPU_UpdateDisplayEffects(unsigned long curTime);
 #if (RPU_MPU_ARCHITECTURE == 15)
 uint8_t RPU_SetDisplayText(int displayNumber, char* text, bool blankByLength = true);
 #endif
@@ -132,11 +206,22 @@ void RPU_SetLampState(int lampNum, uint8_t s_lampState, uint8_t s_lampDim = 0, i
 void RPU_ApplyFlashToLamps(unsigned long curTime);
 void RPU_FlashAllLamps(unsigned long curTime); // Self-test function
 void RPU_TurnOffAllLamps();
-void RPU_SetDimDivisor(uint8_t level = 1, uint8_t divisor = 2); // 2 means 50% duty cycle, 3 means 33%, 4 means 25%...
+// 2 means 50% duty cycle, 3 means 33%, 4 means 25%... (rounded to the nearest 1/8)
+void RPU_SetDimDivisor(uint8_t level = 1, uint8_t divisor = 2);
+// Brightness of a lit lamp, 0 (on 1/8 of the time) to RPU_LAMP_BRIGHTNESS_FULL
+#define RPU_LAMP_BRIGHTNESS_FULL 7
+void RPU_SetLampBrightness(int lampNum, uint8_t brightness);
+uint8_t RPU_ReadLampBrightness(int lampNum);
 uint8_t RPU_ReadLampState(int lampNum);
 uint8_t RPU_ReadLampDim(int lampNum);
 int RPU_ReadLampFlash(int lampNum);
 
+//   Frames
+// With RPU_OS_DOUBLE_BUFFER_FRAMES, lamp & display changes are held back
+// until this shows them all at once (RPU_Update calls it at the end of
+// every loop). Returns true if anything changed.
+bool RPU_CommitFrame();
+
 // Sound Functions
 #ifdef RPU_OS_USE_S_AND_T
 void RPU_PlaySoundSAndT(uint8_t soundByte);
@@ -163,6 +248,7 @@ void RPU_SetSoundValueLimits(unsigned short lowerLimit, unsigned short upperLimi
 void RPU_PushToSoundStack(unsigned short soundNumber, uint8_t numPushes);
 bool RPU_PushToTimedSoundStack(unsigned short soundNumber, uint8_t numPushes, unsigned long whenToPlay);
 void RPU_UpdateTimedSoundStack(unsigned long curTime);
+unsigned long RPU_GetTimedSoundStackDrops();
 #endif
 #ifdef RPU_OS_USE_WTYPE_11_SOUND
 void RPU_PlayW11Sound(uint8_t soundNum);
@@ -171,7 +257,27 @@ void RPU_PlayW11Music(uint8_t songNum);
 
 //   General
 uint8_t RPU_DataRead(int address);
+void RPU_DataWrite(int address, uint8_t data);
+void RPU_DataWriteBurst(const BusOp* ops, uint8_t numOps);
+// RPU_Update does all of the main loop work below. A game that schedules
+// its own work can call RPU_UpdateTimedStacks every loop, and
+// RPU_ApplyFlashToLamps, RPU_UpdateDisplayEffects and RPU_CommitFrame as
+// often as its lamps and displays need.
 void RPU_Update(unsigned long currentTime);
+void RPU_UpdateTimedStacks(unsigned long currentTime);
+#if defined(RPU_OS_CHECK_PIA_SHADOWS)
+unsigned long RPU_GetPIAShadowMismatches();
+#endif
+#if defined(RPU_OS_PROFILE_INTERRUPTS)
+void RPU_ResetInterruptProfile();
+void RPU_DumpInterruptProfile();
+#endif
+#if defined(RPU_OS_TRACK_SWITCH_LATENCY)
+void RPU_ResetSwitchLatency();
+void RPU_DumpSwitchLatency();
+// Number of times the switch came off the stack (saturates at 65535) and its longest wait
+uint16_t RPU_GetSwitchLatency(uint8_t switchNum, uint16_t* maxMicros);
+#endif
 #if RPU_MPU_ARCHITECTURE > 9
 void RPU_SetBoardLEDs(bool LED1, bool LED2, uint8_t BCDValue = 0xFF);
 #endif
@@ -0,0 +1,211 @@
+/**************************************************************************
+ *     This file is part of the RPU for Arduino Project.
+
+    RPU is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    RPU is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    See <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef RPU_GAME_TIMERS_H
+
+#include "RPU_TimedQueue.h"
+#include <stddef.h>
+#include <stdint.h>
+
+typedef void (*RPUGameTimerCallback)(uint8_t timerId, unsigned long curTime);
+
+// Named deadlines for the game rules. Each timer is a slot picked by the
+// caller (0 to N-1), is either one-shot or periodic, and can call a
+// function when it expires. Update only compares the current time against
+// the earliest deadline, so it costs one compare on most loops, and when
+// several timers come due together their callbacks run in deadline order.
+// All the compares are rollover-safe (see RPU_TimeHasPassed).
+//
+// Pause freezes every pausable timer (for a ball save or a tilt, say) and
+// Resume pushes their deadlines out by however long they were paused.
+// Timers started with pausable = false keep running through a pause.
+//
+//   #define TIMER_MODE_END 0
+//   RPUGameTimers<4> GameTimers;
+//   GameTimers.Start(TIMER_MODE_END, CurrentTime, 45000, EndMode);
+//   ...
+//   GameTimers.Update(CurrentTime);
+//
+// A callback is free to start or cancel timers (including its own). A
+// periodic timer that falls more than a period behind skips ahead rather
+// than firing several times to catch up.
+template <uint8_t N> class RPUGameTimers {
+   static_assert(N > 0 && N < 128, "RPUGameTimers holds 1 to 127 timers");
+
+ public:
+   RPUGameTimers() : nextDeadline(0), pauseTime(0), haveDeadline(false), paused(false) {
+      for (uint8_t timerId = 0; timerId < N; timerId++) {
+         timers[timerId].running = false;
+      }
+   }
+
+   // Starting a timer that's already running restarts it
+   void Start(uint8_t timerId, unsigned long curTime, unsigned long delayMs, RPUGameTimerCallback callback = NULL,
+              unsigned long periodMs = 0, bool pausable = true) {
+      if (timerId >= N) {
+         return;
+      }
+      Timer* timer = &timers[timerId];
+      timer->callback = callback;
+      timer->periodMs = periodMs;
+      timer->pausable = pausable;
+      timer->running = true;
+      // Time stands still for a paused timer, so it starts counting from
+      // the pause and gets the whole delay once things resume
+      timer->dueTime = ((paused && pausable) ? pauseTime : curTime) + delayMs;
+      FindNextDeadline();
+   }
+
+   void Cancel(uint8_t timerId) {
+      if (timerId >= N || !timers[timerId].running) {
+         return;
+      }
+      timers[timerId].running = false;
+      FindNextDeadline();
+   }
+
+   // Stops every timer and clears the pause
+   void CancelAll() {
+      for (uint8_t timerId = 0; timerId < N; timerId++) {
+         timers[timerId].running = false;
+      }
+      paused = false;
+      haveDeadline = false;
+   }
+
+   bool IsRunning(uint8_t timerId) const {
+      return (timerId < N) && timers[timerId].running;
+   }
+
+   // Milliseconds until the timer expires (0 if it isn't running). This
+   // holds still while the timer is paused.
+   unsigned long GetRemaining(uint8_t timerId, unsigned long curTime) const {
+      if (!IsRunning(timerId)) {
+         return 0;
+      }
+      const Timer* timer = &timers[timerId];
+      unsigned long now = (paused && timer->pausable) ? pauseTime : curTime;
+      if (RPU_TimeHasPassed(now, timer->dueTime)) {
+         return 0;
+      }
+      return (unsigned long)RPU_TimeDifference(timer->dueTime, now);
+   }
+
+   void Pause(unsigned long curTime) {
+      if (paused) {
+         return;
+      }
+      paused = true;
+      pauseTime = curTime;
+      FindNextDeadline();
+   }
+
+   void Resume(unsigned long curTime) {
+      if (!paused) {
+         return;
+      }
+      unsigned long pausedFor = curTime - pauseTime;
+      for (uint8_t timerId = 0; timerId < N; timerId++) {
+         if (timers[timerId].running && timers[timerId].pausable) {
+            timers[timerId].dueTime += pausedFor;
+         }
+      }
+      paused = false;
+      FindNextDeadline();
+   }
+
+   bool IsPaused() const {
+      return paused;
+   }
+
+   // Fires every timer that has expired, earliest deadline first
+   void Update(unsigned long curTime) {
+      if (!haveDeadline || !RPU_TimeHasPassed(curTime, nextDeadline)) {
+         return;
+      }
+
+      uint8_t timerId;
+      while ((timerId = FindEarliestExpired(curTime)) < N) {
+         Timer* timer = &timers[timerId];
+         // Reschedule (or stop) before the callback so it can restart or
+         // cancel the timer
+         if (timer->periodMs != 0) {
+            timer->dueTime += timer->periodMs;
+            if (RPU_TimeHasPassed(curTime, timer->dueTime)) {
+               timer->dueTime = curTime + timer->periodMs;
+            }
+         } else {
+            timer->running = false;
+         }
+         if (timer->callback != NULL) {
+            timer->callback(timerId, curTime);
+         }
+      }
+
+      FindNextDeadline();
+   }
+
+ private:
+   struct Timer {
+      RPUGameTimerCallback callback;
+      unsigned long dueTime;
+      unsigned long periodMs;
+      bool running;
+      bool pausable;
+   };
+
+   bool IsFrozen(const Timer* timer) const {
+      return paused && timer->pausable;
+   }
+
+   // Returns N if nothing has expired
+   uint8_t FindEarliestExpired(unsigned long curTime) const {
+      uint8_t earliest = N;
+      for (uint8_t timerId = 0; timerId < N; timerId++) {
+         const Timer* timer = &timers[timerId];
+         if (!timer->running || IsFrozen(timer) || !RPU_TimeHasPassed(curTime, timer->dueTime)) {
+            continue;
+         }
+         if (earliest == N || RPU_TimeHasPassed(timers[earliest].dueTime, timer->dueTime)) {
+            earliest = timerId;
+         }
+      }
+      return earliest;
+   }
+
+   void FindNextDeadline() {
+      haveDeadline = false;
+      for (uint8_t timerId = 0; timerId < N; timerId++) {
+         const Timer* timer = &timers[timerId];
+         if (!timer->running || IsFrozen(timer)) {
+            continue;
+         }
+         if (!haveDeadline || RPU_TimeHasPassed(nextDeadline, timer->dueTime)) {
+            nextDeadline = timer->dueTime;
+            haveDeadline = true;
+         }
+      }
+   }
+
+   Timer timers[N];
+   unsigned long nextDeadline;
+   unsigned long pauseTime;
+   bool haveDeadline;
+   bool paused;
+};
+
+#define RPU_GAME_TIMERS_H
+#endif
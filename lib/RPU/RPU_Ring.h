@@ -0,0 +1,137 @@
+/**************************************************************************
+ *     This file is part of the RPU for Arduino Project.
+
+    RPU is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    RPU is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    See <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef RPU_RING_H
+
+#include <stdint.h>
+
+// Keeps the compiler from moving memory accesses across this point
+#define RPU_RING_BARRIER() __asm__ __volatile__("" ::: "memory")
+
+// Single-producer / single-consumer ring buffer for passing items
+// between the main loop and an interrupt without masking interrupts.
+//
+// The head and tail are free-running 8-bit counters (masked down to a
+// slot with N-1), so N has to be a power of two no bigger than 128 and
+// all N slots are usable. Each index is a single byte, so it's read and
+// written atomically on the AVR, and each side only ever writes its own
+// index - after the slot it covers has been filled or emptied.
+//
+//   Producer side: Push
+//   Consumer side: IsEmpty, Front, PopFront, Pop, PushFront
+//
+// If more than one context pushes (for example the interrupt and the main
+// loop), the main loop has to keep interrupts off around its push.
+template <typename T, uint8_t N> class RPURing {
+   static_assert(N >= 2 && N <= 128 && (N & (N - 1)) == 0, "RPURing size has to be a power of two from 2 to 128");
+
+ public:
+   RPURing() : head(0), tail(0), peakCount(0), numDropped(0) {}
+
+   // Only call this when neither side can be using the ring
+   void Clear() {
+      head = 0;
+      tail = 0;
+   }
+
+   // Returns false (and counts a drop) if the ring is full
+   bool Push(const T& item) {
+      uint8_t curTail = tail;
+      uint8_t count = curTail - head;
+      if (count >= N) {
+         numDropped += 1;
+         return false;
+      }
+      entries[curTail & (N - 1)] = item;
+      RPU_RING_BARRIER();
+      tail = curTail + 1;
+      NoteCount(count + 1);
+      return true;
+   }
+
+   bool IsEmpty() const {
+      return head == tail;
+   }
+
+   // The oldest item - only valid if the ring isn't empty. The consumer
+   // can change it in place.
+   T& Front() {
+      RPU_RING_BARRIER();
+      return entries[head & (N - 1)];
+   }
+
+   void PopFront() {
+      RPU_RING_BARRIER();
+      head = head + 1;
+   }
+
+   bool Pop(T* item) {
+      if (IsEmpty()) {
+         return false;
+      }
+      *item = Front();
+      PopFront();
+      return true;
+   }
+
+   // Puts an item in front of everything else. This moves the head, so it
+   // belongs to the consumer side.
+   bool PushFront(const T& item) {
+      uint8_t curHead = head;
+      uint8_t count = tail - curHead;
+      if (count >= N) {
+         numDropped += 1;
+         return false;
+      }
+      entries[(uint8_t)(curHead - 1) & (N - 1)] = item;
+      RPU_RING_BARRIER();
+      head = curHead - 1;
+      NoteCount(count + 1);
+      return true;
+   }
+
+   uint8_t GetCount() const {
+      return (uint8_t)(tail - head);
+   }
+
+   // The item offset places back from the front (0 is the front)
+   const T& Peek(uint8_t offset) const {
+      return entries[(uint8_t)(head + offset) & (N - 1)];
+   }
+
+   uint8_t GetPeakCount() const {
+      return peakCount;
+   }
+   unsigned long GetNumDropped() const {
+      return numDropped;
+   }
+
+ private:
+   void NoteCount(uint8_t count) {
+      if (count > peakCount) {
+         peakCount = count;
+      }
+   }
+
+   T entries[N];
+   volatile uint8_t head;
+   volatile uint8_t tail;
+   uint8_t peakCount;
+   unsigned long numDropped;
+};
+
+#define RPU_RING_H
+#endif
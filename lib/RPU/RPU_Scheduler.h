@@ -0,0 +1,172 @@
+/**************************************************************************
+ *     This file is part of the RPU for Arduino Project.
+
+    RPU is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    RPU is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    See <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef RPU_SCHEDULER_H
+
+#include "RPU_TimedQueue.h"
+#include <Arduino.h>
+#include <stdint.h>
+#include <stdio.h>
+
+typedef void (*RPUTaskFunction)(unsigned long curTime);
+
+// Cooperative scheduler for the main loop. Each task has a period (0 runs
+// it on every pass), a priority (higher runs first when several are due)
+// and a budget in microseconds. Periodic tasks run on multiples of their
+// period, so a 50ms task lines up with the lamp flash phases. A task that
+// runs a whole period late counts a deadline miss and skips ahead rather
+// than running several times to catch up.
+//
+//   RPUScheduler<4> Scheduler;
+//   Scheduler.AddTask("Lamps", RPU_ApplyFlashToLamps, 50, 10, 500);
+//   Scheduler.ResetStats();
+//   ...
+//   Scheduler.Run(CurrentTime);
+//
+// DumpStats reports each task's share of the CPU since the last
+// ResetStats (which has to be within ~70 minutes for the counts to be
+// right), its slowest run and how often it missed its deadline or budget.
+template <uint8_t N> class RPUScheduler {
+   static_assert(N > 0 && N < 32, "RPUScheduler holds 1 to 31 tasks");
+
+ public:
+   RPUScheduler() : numTasks(0), statsStartMicros(0) {}
+
+   // Returns false if there's no room
+   bool AddTask(const char* name, RPUTaskFunction function, unsigned short periodMs, uint8_t priority, unsigned short budgetMicros) {
+      if (numTasks >= N) {
+         return false;
+      }
+
+      // Keep the list sorted by priority (tasks of equal priority run in
+      // the order they were added)
+      uint8_t slot = numTasks;
+      while (slot > 0 && tasks[slot - 1].priority < priority) {
+         tasks[slot] = tasks[slot - 1];
+         slot -= 1;
+      }
+      Task* task = &tasks[slot];
+      task->name = name;
+      task->function = function;
+      task->periodMs = periodMs;
+      task->priority = priority;
+      task->budgetMicros = budgetMicros;
+      task->nextRunTime = 0;
+      task->started = false;
+      ClearTaskStats(task);
+      numTasks += 1;
+      return true;
+   }
+
+   // Runs every task that's due, highest priority first
+   void Run(unsigned long curTime) {
+      for (uint8_t taskNum = 0; taskNum < numTasks; taskNum++) {
+         Task* task = &tasks[taskNum];
+         if (task->periodMs != 0) {
+            if (task->started) {
+               long lateness = RPU_TimeDifference(curTime, task->nextRunTime);
+               if (lateness < 0) {
+                  continue;
+               }
+               if (lateness >= (long)task->periodMs) {
+                  task->deadlineMisses += 1;
+               }
+            }
+            task->started = true;
+            task->nextRunTime = curTime - (curTime % task->periodMs) + task->periodMs;
+         }
+
+         unsigned long startMicros = micros();
+         task->function(curTime);
+         unsigned long runMicros = micros() - startMicros;
+
+         task->runCount += 1;
+         task->totalMicros += runMicros;
+         if (runMicros > task->maxMicros) {
+            task->maxMicros = runMicros;
+         }
+         if (runMicros > task->budgetMicros) {
+            task->budgetOverruns += 1;
+         }
+      }
+   }
+
+   void ResetStats() {
+      for (uint8_t taskNum = 0; taskNum < numTasks; taskNum++) {
+         ClearTaskStats(&tasks[taskNum]);
+      }
+      statsStartMicros = micros();
+   }
+
+   void DumpStats() {
+      char buf[80];
+      unsigned long elapsedMillis = (micros() - statsStartMicros) / 1000;
+      if (elapsedMillis == 0) {
+         elapsedMillis = 1;
+      }
+      Serial.write("Task         runs  cpu(%)  mean(us)   max(us)  over  missed\n");
+      for (uint8_t taskNum = 0; taskNum < numTasks; taskNum++) {
+         const Task* task = &tasks[taskNum];
+         unsigned long meanMicros = task->runCount ? (task->totalMicros / task->runCount) : 0;
+         // Tenths of a percent (us per ms), without floating point
+         unsigned long cpuTenths = task->totalMicros / elapsedMillis;
+         sprintf(buf, "%-10s %6lu %4lu.%lu %9lu %9lu %5u %7u\n", task->name, task->runCount, cpuTenths / 10, cpuTenths % 10, meanMicros,
+                 task->maxMicros, task->budgetOverruns, task->deadlineMisses);
+         Serial.write(buf);
+      }
+   }
+
+   uint8_t GetNumTasks() const {
+      return numTasks;
+   }
+   unsigned short GetDeadlineMisses(uint8_t taskNum) const {
+      return (taskNum < numTasks) ? tasks[taskNum].deadlineMisses : 0;
+   }
+   unsigned short GetBudgetOverruns(uint8_t taskNum) const {
+      return (taskNum < numTasks) ? tasks[taskNum].budgetOverruns : 0;
+   }
+
+ private:
+   struct Task {
+      const char* name;
+      RPUTaskFunction function;
+      unsigned long nextRunTime;
+      unsigned long runCount;
+      unsigned long totalMicros;
+      unsigned long maxMicros;
+      unsigned short periodMs;
+      unsigned short budgetMicros;
+      unsigned short budgetOverruns;
+      unsigned short deadlineMisses;
+      uint8_t priority;
+      bool started;
+   };
+
+   static void ClearTaskStats(Task* task) {
+      task->runCount = 0;
+      task->totalMicros = 0;
+      task->maxMicros = 0;
+      task->budgetOverruns = 0;
+      task->deadlineMisses = 0;
+   }
+
+   Task tasks[N];
+   uint8_t numTasks;
+   unsigned long statsStartMicros;
+};
+
+#define RPU_SCHEDULER_H
+#endif
@@ -0,0 +1,161 @@
+/**************************************************************************
+ *     This file is part of the RPU for Arduino Project.
+
+    RPU is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    RPU is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    See <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef RPU_TIMED_QUEUE_H
+
+#include <stdint.h>
+
+// How far a is after b (negative if it's before), across the millis() rollover
+inline int32_t RPU_TimeDifference(unsigned long a, unsigned long b) {
+   return (int32_t)(uint32_t)(a - b);
+}
+
+// Returns true once curTime has passed dueTime. The subtraction is done
+// unsigned and then read as signed, so this keeps working when millis()
+// wraps around (as long as events are scheduled less than ~24 days out).
+// It's done in 32 bits so a 64-bit host build wraps the same way the AVR does.
+inline bool RPU_TimeHasPassed(unsigned long curTime, unsigned long dueTime) {
+   return RPU_TimeDifference(curTime, dueTime) > 0;
+}
+
+// Fixed-size queue of items that become due at a given time, kept as a
+// binary min-heap on the due time. Checking for due items is O(1) when
+// nothing is due (which is most loops), pushing is O(log N), and
+// servicing costs O(log N) per item that has come due. Items due at the
+// same time come out in the order they were pushed.
+//
+// This is meant for the main loop only - it isn't safe to push from an
+// interrupt.
+//
+//   RPUTimedQueue<MyEvent, 20> events;
+//   events.Push(event, CurrentTime + 500);
+//   ...
+//   MyEvent dueEvent;
+//   while (events.PopDue(CurrentTime, &dueEvent)) {
+//      HandleEvent(dueEvent);
+//   }
+template <typename T, uint8_t N> class RPUTimedQueue {
+   static_assert(N > 0 && N < 128, "RPUTimedQueue holds 1 to 127 items");
+
+ public:
+   RPUTimedQueue() : numEntries(0), nextSequence(0), peakEntries(0), numDropped(0) {}
+
+   void Clear() {
+      numEntries = 0;
+   }
+
+   // Returns false (and counts a drop) if the queue is full
+   bool Push(const T& item, unsigned long dueTime) {
+      if (numEntries >= N) {
+         numDropped += 1;
+         return false;
+      }
+
+      uint8_t slot = numEntries;
+      numEntries += 1;
+      if (numEntries > peakEntries) {
+         peakEntries = numEntries;
+      }
+
+      Entry newEntry;
+      newEntry.dueTime = dueTime;
+      newEntry.sequence = nextSequence;
+      newEntry.item = item;
+      nextSequence += 1;
+
+      // Sift up
+      while (slot > 0) {
+         uint8_t parent = (slot - 1) / 2;
+         if (!ComesBefore(newEntry, entries[parent])) {
+            break;
+         }
+         entries[slot] = entries[parent];
+         slot = parent;
+      }
+      entries[slot] = newEntry;
+      return true;
+   }
+
+   // Removes the earliest item if it's due (dueTime < curTime)
+   bool PopDue(unsigned long curTime, T* item) {
+      if (numEntries == 0 || !RPU_TimeHasPassed(curTime, entries[0].dueTime)) {
+         return false;
+      }
+
+      *item = entries[0].item;
+      numEntries -= 1;
+      if (numEntries == 0) {
+         return true;
+      }
+
+      // Move the last entry to the top and sift it down
+      Entry lastEntry = entries[numEntries];
+      uint8_t slot = 0;
+      while (true) {
+         uint8_t child = slot * 2 + 1;
+         if (child >= numEntries) {
+            break;
+         }
+         if (child + 1 < numEntries && ComesBefore(entries[child + 1], entries[child])) {
+            child += 1;
+         }
+         if (!ComesBefore(entries[child], lastEntry)) {
+            break;
+         }
+         entries[slot] = entries[child];
+         slot = child;
+      }
+      entries[slot] = lastEntry;
+      return true;
+   }
+
+   uint8_t GetCount() const {
+      return numEntries;
+   }
+   uint8_t GetPeakCount() const {
+      return peakEntries;
+   }
+   unsigned long GetNumDropped() const {
+      return numDropped;
+   }
+
+ private:
+   struct Entry {
+      unsigned long dueTime;
+      uint16_t sequence;
+      T item;
+   };
+
+   // Sequence numbers only break ties between equal due times. They wrap
+   // too, so a tie could come out of order if one item waited through
+   // more than 32K pushes, which doesn't happen with game-sized queues.
+   static bool ComesBefore(const Entry& first, const Entry& second) {
+      long timeDifference = RPU_TimeDifference(first.dueTime, second.dueTime);
+      if (timeDifference != 0) {
+         return timeDifference < 0;
+      }
+      return ((int16_t)(first.sequence - second.sequence)) < 0;
+   }
+
+   Entry entries[N];
+   uint8_t numEntries;
+   uint16_t nextSequence;
+   uint8_t peakEntries;
+   unsigned long numDropped;
+};
+
+#define RPU_TIMED_QUEUE_H
+#endif
@@ -72,6 +72,15 @@
 // #define RPU_OS_USE_WTYPE_1_SOUND
 // #define RPU_OS_USE_WTYPE_2_SOUND
 // #define RPU_OS_USE_W11_SOUND
+// #define RPU_OS_CHECK_PIA_SHADOWS   // Cross-check the PIA shadow registers against the bus (debug)
+// #define RPU_OS_PROFILE_INTERRUPTS  // Time the interrupt phases (MEGA 2560 only, uses timer 3)
+// #define RPU_OS_TRACK_SWITCH_LATENCY  // Time how long switch closures wait on the switch stack
+// #define RPU_OS_RECORD_SWITCHES  // Log every switch change the scan sees (see RPU_StartSwitchRecording)
+// #define RPU_OS_DOUBLE_BUFFER_FRAMES  // Show lamp & display changes together at RPU_CommitFrame
+// The EEPROM cache takes ~170 bytes of SRAM, so it's left off for the Nano (rev 1 & 2)
+#if (RPU_OS_HARDWARE_REV > 2)
+#define RPU_OS_USE_EEPROM_CACHE  // Keep settings & audits in RAM and write them back from RPU_Update
+#endif
 
 #if (RPU_MPU_ARCHITECTURE == 1)
 /*******************************************************
@@ -171,5 +180,9 @@
 #define RPU_CPC_CHUTE_2_SELECTION_BYTE 51
 #define RPU_CPC_CHUTE_3_SELECTION_BYTE 52
 
+// Bytes below this are covered by RPU_OS_USE_EEPROM_CACHE (the game's
+// own settings have to fit too, the last is the special score at 144-147)
+#define RPU_EEPROM_CACHE_SIZE 148
+
 #define RPU_CONFIG_H
 #endif
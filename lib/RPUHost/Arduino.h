@@ -0,0 +1,121 @@
+/**************************************************************************
+ *     This file is part of the RPU for Arduino Project.
+
+    RPU is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    RPU is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    See <https://www.gnu.org/licenses/>.
+ */
+
+// Host stand-in for the Arduino core. Only the pieces the RPU library
+// and the game code actually touch are here. Time is simulated: it only
+// moves forward on bus cycles, delays, and the per-loop overhead (see
+// RPUHost.h), and interrupts are dispatched at those points.
+
+#ifndef RPU_HOST_ARDUINO_H
+
+#include "HardwareSerial.h"
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define HIGH 0x1
+#define LOW 0x0
+
+#define INPUT 0x0
+#define OUTPUT 0x1
+#define INPUT_PULLUP 0x2
+
+#define CHANGE 1
+#define FALLING 2
+#define RISING 3
+
+// Everything lives in one address space on the host
+#define PROGMEM
+#define PSTR(s) (s)
+#define F(s) (s)
+#define pgm_read_byte(addr) (*(const uint8_t*)(addr))
+#define pgm_read_word(addr) (*(const uint16_t*)(addr))
+#define pgm_read_dword(addr) (*(const uint32_t*)(addr))
+#define pgm_read_ptr(addr) (*(void* const*)(addr))
+#define memcpy_P memcpy
+#define strlen_P strlen
+
+//   Timing (simulated clock)
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+//   Interrupts
+void noInterrupts();
+void interrupts();
+#define cli() noInterrupts()
+#define sei() interrupts()
+
+#define ISR(vector, ...) extern "C" void vector(void)
+#define TIMER1_COMPA_vect RPUHost_Timer1CompareAVector
+extern "C" void TIMER1_COMPA_vect(void);
+
+#define digitalPinToInterrupt(p) ((p) == 2 ? 0 : ((p) == 3 ? 1 : -1))
+void attachInterrupt(uint8_t interruptNum, void (*userFunc)(void), int mode);
+void detachInterrupt(uint8_t interruptNum);
+
+//   Pins
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int digitalRead(uint8_t pin);
+
+//   Math
+long random(long howBig);
+long random(long howSmall, long howBig);
+void randomSeed(unsigned long seed);
+
+// TCNTn has to count on its own, so it's backed by the simulated clock
+class RPUHostTimerCounter {
+ public:
+   RPUHostTimerCounter(uint8_t timerNum) : timerNum(timerNum) {
+   }
+   operator uint16_t() const;
+   RPUHostTimerCounter& operator=(uint16_t value);
+
+ private:
+   uint8_t timerNum;
+};
+
+//   AVR register file
+// These are plain storage except for the timer registers. Timer 1 is
+// read back to decide when to fire ISR(TIMER1_COMPA_vect); timer 3 only
+// free-runs (normal mode) for code that wants a fine time base.
+extern volatile uint8_t DDRA, DDRB, DDRC, DDRD, DDRE, DDRF, DDRG, DDRH, DDRJ, DDRK, DDRL;
+extern volatile uint8_t PORTA, PORTB, PORTC, PORTD, PORTE, PORTF, PORTG, PORTH, PORTJ, PORTK, PORTL;
+extern volatile uint8_t PINA, PINB, PINC, PIND, PINE, PINF, PING, PINH, PINJ, PINK, PINL;
+extern volatile uint8_t TCCR1A, TCCR1B, TIMSK1;
+extern volatile uint16_t OCR1A;
+extern RPUHostTimerCounter TCNT1;
+extern volatile uint8_t TCCR3A, TCCR3B;
+extern RPUHostTimerCounter TCNT3;
+
+#define CS10 0
+#define CS11 1
+#define CS12 2
+#define CS30 0
+#define CS31 1
+#define CS32 2
+#define WGM12 3
+#define OCIE1A 1
+
+#define RPU_HOST_ARDUINO_H
+#endif
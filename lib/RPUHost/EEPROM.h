@@ -0,0 +1,54 @@
+/**************************************************************************
+ *     This file is part of the RPU for Arduino Project.
+
+    RPU is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    RPU is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    See <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef RPU_HOST_EEPROM_H
+
+#include <stdint.h>
+
+// 4K of erased (0xFF) EEPROM, the size of the MEGA 2560's. Each write
+// costs the simulated clock the same 3.3ms the AVR spends on it.
+class EEPROMClass {
+ public:
+   EEPROMClass();
+
+   uint8_t read(int address);
+   void write(int address, uint8_t value);
+   void update(int address, uint8_t value);
+   uint16_t length() {
+      return EEPROM_SIZE;
+   }
+
+   // Host side
+   bool Load(const char* fileName);
+   bool Save(const char* fileName);
+   unsigned long GetNumWrites() const {
+      return numWrites;
+   }
+
+ private:
+   static constexpr uint16_t EEPROM_SIZE = 4096;
+
+   uint8_t contents[EEPROM_SIZE];
+   unsigned long numWrites;
+};
+
+extern EEPROMClass EEPROM;
+
+// Stands in for the avr-libc macro - false while a write is in progress
+bool eeprom_is_ready();
+
+#define RPU_HOST_EEPROM_H
+#endif
@@ -0,0 +1,78 @@
+/**************************************************************************
+ *     This file is part of the RPU for Arduino Project.
+
+    RPU is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    RPU is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    See <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef RPU_HOST_HARDWARE_SERIAL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Host serial port. Transmitted bytes are counted and, if the port is
+// echoing, copied to stdout. Received bytes come from Inject(). The
+// transmit buffer is modelled (64 bytes, emptied at the baud rate) so
+// availableForWrite() behaves like the AVR core's.
+class HardwareSerial {
+ public:
+   HardwareSerial(uint8_t portNumber);
+
+   void begin(unsigned long baud);
+   void end();
+   int available();
+   int peek();
+   int read();
+   void flush();
+   int availableForWrite();
+
+   size_t write(uint8_t value);
+   size_t write(const char* str);
+   size_t write(const uint8_t* buffer, size_t size);
+   size_t print(const char* str);
+   size_t print(long value);
+   size_t println(const char* str = "");
+   size_t println(long value);
+
+   operator bool() const {
+      return true;
+   }
+
+   // Host side
+   void Inject(const uint8_t* buffer, size_t size);
+   void SetEcho(bool echo);
+   unsigned long GetBytesWritten() const {
+      return bytesWritten;
+   }
+
+ private:
+   static constexpr int RX_BUFFER_SIZE = 256;
+   static constexpr int TX_BUFFER_SIZE = 64;
+
+   void DrainTxBuffer();
+
+   uint8_t port;
+   bool echo;
+   unsigned long baudRate;
+   unsigned long bytesWritten;
+   uint8_t rxBuffer[RX_BUFFER_SIZE];
+   int rxHead;
+   int rxTail;
+   unsigned long txBuffered;
+   unsigned long lastTxDrainMicros;
+};
+
+extern HardwareSerial Serial;
+extern HardwareSerial Serial1;
+
+#define RPU_HOST_HARDWARE_SERIAL_H
+#endif
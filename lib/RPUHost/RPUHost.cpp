@@ -0,0 +1,611 @@
+/**************************************************************************
+ *     This file is part of the RPU for Arduino Project.
+
+    RPU is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    RPU is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    See <https://www.gnu.org/licenses/>.
+ */
+
+#include "RPUHost.h"
+#include "RPU_config.h"
+#include <Arduino.h>
+#include <EEPROM.h>
+
+#if defined(RPU_OS_HOST_SIMULATION)
+
+#define NANOS_PER_MILLI 1000000ULL
+#define NANOS_PER_MICRO 1000ULL
+#define AVR_CLOCK_HZ 16000000ULL
+#define EEPROM_WRITE_NANOS (3300ULL * NANOS_PER_MICRO)
+#define MAX_NESTED_INTERRUPTS 4
+
+static RPUHostOptions Options = {530000, 120, 20000, 0};
+static RPUHostStats Stats;
+
+static uint64_t SimNanos = 0;
+static uint64_t NextZeroCrossingNanos = 0;
+static uint64_t Timer1ReferenceNanos = 0;
+static uint64_t Timer3ReferenceNanos = 0;
+static uint64_t LoopStartNanos = 0;
+static uint64_t NanosInNestedInterrupts = 0;
+static unsigned long TurnaroundsInNestedInterrupts = 0;
+static uint64_t EEPROMBusyUntilNanos = 0;
+
+static bool InterruptsEnabled = true;
+static bool Timer1Pending = false;
+static uint8_t InterruptDepth = 0;
+static void (*ExternalInterrupt0)(void) = NULL;
+static RPUHostInputHook InputHook = NULL;
+
+static uint8_t PinLevels[70];
+
+volatile uint8_t DDRA, DDRB, DDRC, DDRD, DDRE, DDRF, DDRG, DDRH, DDRJ, DDRK, DDRL;
+volatile uint8_t PORTA, PORTB, PORTC, PORTD, PORTE, PORTF, PORTG, PORTH, PORTJ, PORTK, PORTL;
+volatile uint8_t PINA, PINB, PINC, PIND, PINE, PINF, PING, PINH, PINJ, PINK, PINL;
+volatile uint8_t TCCR1A, TCCR1B, TIMSK1;
+volatile uint16_t OCR1A;
+RPUHostTimerCounter TCNT1(1);
+volatile uint8_t TCCR3A, TCCR3B;
+RPUHostTimerCounter TCNT3(3);
+
+HardwareSerial Serial(0);
+HardwareSerial Serial1(1);
+EEPROMClass EEPROM;
+
+/******************************************************
+ *   Timer 1 (CTC mode, as set up by RPU_HookInterrupts)
+ *   and timer 3 (normal mode, free running)
+ */
+
+static uint64_t TimerTickNanos(uint8_t clockSelect) {
+   static const uint16_t prescalers[8] = {0, 1, 8, 64, 256, 1024, 0, 0};
+   uint16_t prescaler = prescalers[clockSelect & 0x07];
+   return (prescaler * 1000000000ULL) / AVR_CLOCK_HZ;
+}
+
+static uint64_t Timer1PeriodNanos() {
+   if (!(TIMSK1 & (1 << OCIE1A))) {
+      return 0;
+   }
+   return ((uint64_t)OCR1A + 1) * TimerTickNanos(TCCR1B);
+}
+
+RPUHostTimerCounter::operator uint16_t() const {
+   uint64_t tick = TimerTickNanos((timerNum == 1) ? TCCR1B : TCCR3B);
+   if (tick == 0) {
+      return 0;
+   }
+   if (timerNum == 1) {
+      return (uint16_t)(((SimNanos - Timer1ReferenceNanos) / tick) % ((uint64_t)OCR1A + 1));
+   }
+   return (uint16_t)((SimNanos - Timer3ReferenceNanos) / tick);
+}
+
+RPUHostTimerCounter& RPUHostTimerCounter::operator=(uint16_t value) {
+   if (timerNum == 1) {
+      Timer1ReferenceNanos = SimNanos - (uint64_t)value * TimerTickNanos(TCCR1B);
+   } else {
+      Timer3ReferenceNanos = SimNanos - (uint64_t)value * TimerTickNanos(TCCR3B);
+   }
+   return *this;
+}
+
+/******************************************************
+ *   Interrupt dispatch
+ */
+
+static void RunInterruptVector(void (*vector)(void), uint64_t* exclusiveNanos, unsigned long* exclusiveTurnarounds) {
+   uint64_t startNanos = SimNanos;
+   uint64_t outerNested = NanosInNestedInterrupts;
+   unsigned long startTurnarounds = Stats.dataBusTurnarounds;
+   unsigned long outerNestedTurnarounds = TurnaroundsInNestedInterrupts;
+   NanosInNestedInterrupts = 0;
+   TurnaroundsInNestedInterrupts = 0;
+
+   // The AVR clears the I bit going in and RETI sets it again
+   InterruptsEnabled = false;
+   InterruptDepth += 1;
+   vector();
+   InterruptDepth -= 1;
+   InterruptsEnabled = true;
+
+   uint64_t elapsed = SimNanos - startNanos;
+   *exclusiveNanos += elapsed - NanosInNestedInterrupts;
+   NanosInNestedInterrupts = outerNested + elapsed;
+
+   unsigned long turnarounds = Stats.dataBusTurnarounds - startTurnarounds;
+   *exclusiveTurnarounds += turnarounds - TurnaroundsInNestedInterrupts;
+   TurnaroundsInNestedInterrupts = outerNestedTurnarounds + turnarounds;
+}
+
+static void DispatchInterrupts() {
+   if (!InterruptsEnabled || InterruptDepth >= MAX_NESTED_INTERRUPTS) {
+      return;
+   }
+
+   // INT0 has the higher priority vector on the AVR. It's level triggered, so
+   // it's taken for as long as a PIA holds IRQ low -- but only once per call
+   // here, so a stuck IRQ slows the simulation down instead of hanging it.
+   if (ExternalInterrupt0 && RPUHost_PIAIrqAsserted()) {
+      Stats.zeroCrossingInterrupts += 1;
+      RunInterruptVector(ExternalInterrupt0, &Stats.nanosInZeroCrossingInterrupt, &Stats.turnaroundsInZeroCrossingInterrupt);
+   }
+
+   if (Timer1Pending) {
+      Timer1Pending = false;
+      Stats.displayInterrupts += 1;
+      RunInterruptVector(TIMER1_COMPA_vect, &Stats.nanosInDisplayInterrupt, &Stats.turnaroundsInDisplayInterrupt);
+   }
+}
+
+static uint64_t NextEventNanos() {
+   uint64_t nextEvent = NextZeroCrossingNanos;
+   uint64_t period = Timer1PeriodNanos();
+   if (period) {
+      uint64_t nextCompare = Timer1ReferenceNanos + period;
+      if (nextCompare < nextEvent) {
+         nextEvent = nextCompare;
+      }
+   }
+   return nextEvent;
+}
+
+static void RaiseTimedEvents() {
+   while (SimNanos >= NextZeroCrossingNanos) {
+      Stats.zeroCrossings += 1;
+      if (RPUHost_PIAZeroCrossing()) {
+         Stats.missedZeroCrossings += 1;
+      }
+      NextZeroCrossingNanos += 1000000000ULL / Options.zeroCrossingHz;
+   }
+
+   uint64_t period = Timer1PeriodNanos();
+   if (period && (SimNanos - Timer1ReferenceNanos) >= period) {
+      // Only one compare match can be pending, no matter how many were missed
+      Timer1Pending = true;
+      Timer1ReferenceNanos += ((SimNanos - Timer1ReferenceNanos) / period) * period;
+   }
+}
+
+static void RunUntil(uint64_t targetNanos, bool countInterruptTime) {
+   // Step event to event so that interrupts taken along the way see the
+   // right time. Cycle-counted waits don't advance while an interrupt runs,
+   // so for those the time the interrupt took is added on top.
+   while (SimNanos < targetNanos) {
+      uint64_t stepTo = NextEventNanos();
+      if (stepTo > targetNanos) {
+         stepTo = targetNanos;
+      }
+      if (stepTo <= SimNanos) {
+         stepTo = SimNanos + 1;
+      }
+      SimNanos = stepTo;
+      if (InputHook) {
+         InputHook(SimNanos);
+      }
+      RaiseTimedEvents();
+      DispatchInterrupts();
+      if (!countInterruptTime) {
+         targetNanos += (SimNanos - stepTo);
+      }
+   }
+}
+
+void RPUHost_AdvanceNanos(uint64_t numNanos) {
+   RunUntil(SimNanos + numNanos, false);
+}
+
+void RPUHost_SetInputHook(RPUHostInputHook hook) {
+   InputHook = hook;
+}
+
+void RPUHost_BusAccess(bool isWrite, uint8_t numCycles) {
+   if (isWrite) {
+      // A lone write turns the data pins around to output and back again.
+      // (Reads leave them as inputs, which is where they rest.)
+      Stats.busWrites += 1;
+      Stats.dataBusTurnarounds += 2;
+   } else {
+      Stats.busReads += 1;
+   }
+   RPUHost_AdvanceNanos(((uint64_t)numCycles * 1000000000ULL) / Options.phi2Hz);
+}
+
+void RPUHost_BusBurst(uint8_t numWrites) {
+   // The whole burst costs one turnaround each way; each of its writes is
+   // then charged through RPUHost_BusAccess like any other, so back out
+   // the turnarounds those would have counted
+   Stats.busBursts += 1;
+   Stats.busBurstWrites += numWrites;
+   Stats.dataBusTurnarounds += 2;
+   Stats.dataBusTurnarounds -= 2 * (unsigned long)numWrites;
+}
+
+void RPUHost_NoteSoundWrite(uint8_t soundByte) {
+   Stats.soundWrites += 1;
+   Stats.lastSoundByte = soundByte;
+}
+
+/******************************************************
+ *   Arduino core
+ */
+
+unsigned long millis() {
+   return (uint32_t)(SimNanos / NANOS_PER_MILLI + Options.startMillis);
+}
+
+unsigned long micros() {
+   return (uint32_t)(SimNanos / NANOS_PER_MICRO + (uint64_t)Options.startMillis * 1000ULL);
+}
+
+void delay(unsigned long ms) {
+   // delay() watches micros(), so interrupt time counts against it
+   RunUntil(SimNanos + ms * NANOS_PER_MILLI, true);
+}
+
+void delayMicroseconds(unsigned int us) {
+   // delayMicroseconds() counts cycles, so interrupt time is added to it
+   RPUHost_AdvanceNanos((uint64_t)us * NANOS_PER_MICRO);
+}
+
+void noInterrupts() {
+   InterruptsEnabled = false;
+}
+
+void interrupts() {
+   InterruptsEnabled = true;
+   DispatchInterrupts();
+}
+
+void attachInterrupt(uint8_t interruptNum, void (*userFunc)(void), int mode) {
+   // Only INT0 (pin 2, the PIA IRQ line) is wired up
+   (void)mode;
+   if (interruptNum == 0) {
+      ExternalInterrupt0 = userFunc;
+   }
+}
+
+void detachInterrupt(uint8_t interruptNum) {
+   if (interruptNum == 0) {
+      ExternalInterrupt0 = NULL;
+   }
+}
+
+void pinMode(uint8_t pin, uint8_t mode) {
+   (void)pin;
+   (void)mode;
+}
+
+void digitalWrite(uint8_t pin, uint8_t val) {
+   if (pin < sizeof(PinLevels)) {
+      PinLevels[pin] = val ? HIGH : LOW;
+   }
+}
+
+int digitalRead(uint8_t pin) {
+   return (pin < sizeof(PinLevels)) ? PinLevels[pin] : LOW;
+}
+
+long random(long howBig) {
+   if (howBig <= 0) {
+      return 0;
+   }
+   return rand() % howBig;
+}
+
+long random(long howSmall, long howBig) {
+   if (howSmall >= howBig) {
+      return howSmall;
+   }
+   return howSmall + random(howBig - howSmall);
+}
+
+void randomSeed(unsigned long seed) {
+   srand((unsigned int)seed);
+}
+
+/******************************************************
+ *   Serial
+ */
+
+HardwareSerial::HardwareSerial(uint8_t portNumber) {
+   port = portNumber;
+   echo = false;
+   baudRate = 0;
+   bytesWritten = 0;
+   rxHead = 0;
+   rxTail = 0;
+   txBuffered = 0;
+   lastTxDrainMicros = 0;
+}
+
+void HardwareSerial::begin(unsigned long baud) {
+   baudRate = baud;
+}
+
+void HardwareSerial::end() {
+   baudRate = 0;
+}
+
+int HardwareSerial::available() {
+   return (rxHead - rxTail + RX_BUFFER_SIZE) % RX_BUFFER_SIZE;
+}
+
+int HardwareSerial::peek() {
+   if (rxHead == rxTail) {
+      return -1;
+   }
+   return rxBuffer[rxTail];
+}
+
+int HardwareSerial::read() {
+   if (rxHead == rxTail) {
+      return -1;
+   }
+   uint8_t value = rxBuffer[rxTail];
+   rxTail = (rxTail + 1) % RX_BUFFER_SIZE;
+   return value;
+}
+
+void HardwareSerial::flush() {
+   fflush(stdout);
+}
+
+void HardwareSerial::DrainTxBuffer() {
+   unsigned long curMicros = micros();
+   if (baudRate == 0) {
+      txBuffered = 0;
+   } else {
+      // 10 bits per byte on the wire
+      unsigned long bytesSent = (unsigned long)(((unsigned long long)(curMicros - lastTxDrainMicros) * baudRate) / 10000000ULL);
+      if (bytesSent == 0) {
+         return;
+      }
+      txBuffered = (bytesSent > txBuffered) ? 0 : (txBuffered - bytesSent);
+   }
+   lastTxDrainMicros = curMicros;
+}
+
+int HardwareSerial::availableForWrite() {
+   DrainTxBuffer();
+   return (txBuffered >= (TX_BUFFER_SIZE - 1)) ? 0 : (int)((TX_BUFFER_SIZE - 1) - txBuffered);
+}
+
+size_t HardwareSerial::write(uint8_t value) {
+   return write(&value, 1);
+}
+
+size_t HardwareSerial::write(const char* str) {
+   return write((const uint8_t*)str, strlen(str));
+}
+
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size) {
+   // The AVR core would block here until the buffer had room
+   DrainTxBuffer();
+   txBuffered += size;
+   if (txBuffered > (TX_BUFFER_SIZE - 1)) {
+      txBuffered = TX_BUFFER_SIZE - 1;
+   }
+   bytesWritten += size;
+   if (echo) {
+      fwrite(buffer, 1, size, stdout);
+   }
+   return size;
+}
+
+size_t HardwareSerial::print(const char* str) {
+   return write(str);
+}
+
+size_t HardwareSerial::print(long value) {
+   char buf[24];
+   snprintf(buf, sizeof(buf), "%ld", value);
+   return write(buf);
+}
+
+size_t HardwareSerial::println(const char* str) {
+   return write(str) + write("\r\n");
+}
+
+size_t HardwareSerial::println(long value) {
+   return print(value) + write("\r\n");
+}
+
+void HardwareSerial::Inject(const uint8_t* buffer, size_t size) {
+   for (size_t count = 0; count < size; count++) {
+      int nextHead = (rxHead + 1) % RX_BUFFER_SIZE;
+      if (nextHead == rxTail) {
+         return;
+      }
+      rxBuffer[rxHead] = buffer[count];
+      rxHead = nextHead;
+   }
+}
+
+void HardwareSerial::SetEcho(bool s_echo) {
+   echo = s_echo;
+}
+
+/******************************************************
+ *   EEPROM
+ */
+
+EEPROMClass::EEPROMClass() {
+   memset(contents, 0xFF, sizeof(contents));
+   numWrites = 0;
+}
+
+static void WaitForEEPROM() {
+   // Like eeprom_busy_wait(), the next access spins until the last write finishes
+   if (SimNanos < EEPROMBusyUntilNanos) {
+      RPUHost_AdvanceNanos(EEPROMBusyUntilNanos - SimNanos);
+   }
+}
+
+bool eeprom_is_ready() {
+   return SimNanos >= EEPROMBusyUntilNanos;
+}
+
+uint8_t EEPROMClass::read(int address) {
+   WaitForEEPROM();
+   return contents[address % EEPROM_SIZE];
+}
+
+void EEPROMClass::write(int address, uint8_t value) {
+   WaitForEEPROM();
+   contents[address % EEPROM_SIZE] = value;
+   numWrites += 1;
+   EEPROMBusyUntilNanos = SimNanos + EEPROM_WRITE_NANOS;
+}
+
+void EEPROMClass::update(int address, uint8_t value) {
+   if (read(address) != value) {
+      write(address, value);
+   }
+}
+
+bool EEPROMClass::Load(const char* fileName) {
+   FILE* eepromFile = fopen(fileName, "rb");
+   if (!eepromFile) {
+      return false;
+   }
+   size_t numRead = fread(contents, 1, sizeof(contents), eepromFile);
+   fclose(eepromFile);
+   return numRead == sizeof(contents);
+}
+
+bool EEPROMClass::Save(const char* fileName) {
+   FILE* eepromFile = fopen(fileName, "wb");
+   if (!eepromFile) {
+      return false;
+   }
+   size_t numWritten = fwrite(contents, 1, sizeof(contents), eepromFile);
+   fclose(eepromFile);
+   return numWritten == sizeof(contents);
+}
+
+/******************************************************
+ *   Host API
+ */
+
+void RPUHost_GetDefaultOptions(RPUHostOptions* options) {
+   options->phi2Hz = 530000;
+   options->zeroCrossingHz = 120;
+   options->loopOverheadNanos = 20000;
+   options->startMillis = 0;
+}
+
+void RPUHost_Configure(const RPUHostOptions* options) {
+   Options = *options;
+   if (Options.phi2Hz == 0) {
+      Options.phi2Hz = 530000;
+   }
+   if (Options.zeroCrossingHz == 0) {
+      Options.zeroCrossingHz = 120;
+   }
+
+   memset(&Stats, 0, sizeof(Stats));
+   SimNanos = 0;
+   LoopStartNanos = 0;
+   NextZeroCrossingNanos = 1000000000ULL / Options.zeroCrossingHz;
+   Timer1ReferenceNanos = 0;
+   Timer3ReferenceNanos = 0;
+   Timer1Pending = false;
+   InterruptsEnabled = true;
+   RPUHost_PIAReset();
+}
+
+uint64_t RPUHost_GetNanos() {
+   return SimNanos;
+}
+
+void RPUHost_EndOfLoop() {
+   RPUHost_AdvanceNanos(Options.loopOverheadNanos);
+
+   uint64_t loopNanos = SimNanos - LoopStartNanos;
+   if (Stats.loopIterations && loopNanos > Stats.longestLoopNanos) {
+      Stats.longestLoopNanos = loopNanos;
+   }
+   Stats.loopIterations += 1;
+   LoopStartNanos = SimNanos;
+}
+
+void RPUHost_PressSelfTest() {
+   RPUHost_PIASelfTestEdge();
+}
+
+void RPUHost_SetPinLevel(uint8_t pin, uint8_t level) {
+   digitalWrite(pin, level);
+}
+
+const RPUHostStats* RPUHost_GetStats() {
+   return &Stats;
+}
+
+void RPUHost_PrintReport() {
+   double seconds = (double)SimNanos / 1e9;
+
+   printf("Simulated time          %.3f s\n", seconds);
+   printf("loop() iterations       %lu (mean %.1f us, longest %.1f us)\n", Stats.loopIterations,
+          Stats.loopIterations ? (double)SimNanos / 1000.0 / Stats.loopIterations : 0.0, (double)Stats.longestLoopNanos / 1000.0);
+   printf("Bus reads / writes      %lu / %lu\n", Stats.busReads, Stats.busWrites);
+   printf("Display ISR             %lu calls, %.2f%% of CPU\n", Stats.displayInterrupts,
+          seconds > 0 ? 100.0 * (double)Stats.nanosInDisplayInterrupt / (double)SimNanos : 0.0);
+   printf("Zero crossing ISR       %lu calls for %lu crossings (%lu missed), %.2f%% of CPU\n", Stats.zeroCrossingInterrupts,
+          Stats.zeroCrossings, Stats.missedZeroCrossings,
+          seconds > 0 ? 100.0 * (double)Stats.nanosInZeroCrossingInterrupt / (double)SimNanos : 0.0);
+   printf("Data bus turnarounds    %lu (%.1f per zero crossing pass, %.1f per display pass)\n", Stats.dataBusTurnarounds,
+          Stats.zeroCrossingInterrupts ? (double)Stats.turnaroundsInZeroCrossingInterrupt / Stats.zeroCrossingInterrupts : 0.0,
+          Stats.displayInterrupts ? (double)Stats.turnaroundsInDisplayInterrupt / Stats.displayInterrupts : 0.0);
+   printf("Burst writes            %lu in %lu bursts (%lu turnarounds saved)\n", Stats.busBurstWrites, Stats.busBursts,
+          2 * (Stats.busBurstWrites - Stats.busBursts));
+   printf("Sound writes            %lu (last 0x%02X)\n", Stats.soundWrites, Stats.lastSoundByte);
+   printf("EEPROM writes           %lu\n", EEPROM.GetNumWrites());
+
+   printf("Displays\n");
+   for (uint8_t displayCount = 0; displayCount < RPU_HOST_NUM_DISPLAYS; displayCount++) {
+      printf("  %d  ", displayCount + 1);
+      for (uint8_t digitCount = 0; digitCount < RPU_OS_NUM_DIGITS; digitCount++) {
+         uint8_t digit = RPUHost_GetDisplayDigit(displayCount, digitCount);
+         putchar((digit == RPU_HOST_DIGIT_BLANK) ? '_' : ('0' + digit));
+      }
+      putchar('\n');
+   }
+
+   printf("Lamps lit              ");
+   for (uint8_t lampCount = 0; lampCount < RPU_HOST_NUM_LAMPS; lampCount++) {
+      if (RPUHost_IsLampLit(lampCount)) {
+         printf(" %d", lampCount);
+      }
+   }
+   printf("\n");
+
+   printf("Lamps partly lit (of 8)");
+   for (uint8_t lampCount = 0; lampCount < RPU_HOST_NUM_LAMPS; lampCount++) {
+      uint8_t passesLit = RPUHost_GetLampPassesLit(lampCount);
+      if (passesLit > 0 && passesLit < 8) {
+         printf(" %d:%d", lampCount, passesLit);
+      }
+   }
+   printf("\n");
+
+   printf("Solenoids (fires/cycles)");
+   for (uint8_t solCount = 0; solCount < RPU_HOST_NUM_SOLENOIDS; solCount++) {
+      if (RPUHost_GetSolenoidFireCount(solCount)) {
+         printf(" %d:%lu/%lu", solCount, RPUHost_GetSolenoidFireCount(solCount), RPUHost_GetSolenoidCycles(solCount));
+      }
+   }
+   printf("\n");
+   printf("Continuous solenoids    0x%02X\n", RPUHost_GetContinuousSolenoids());
+   RPUHost_PIAPrintState();
+}
+
+#endif
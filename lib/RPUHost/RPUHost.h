@@ -0,0 +1,125 @@
+/**************************************************************************
+ *     This file is part of the RPU for Arduino Project.
+
+    RPU is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    RPU is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    See <https://www.gnu.org/licenses/>.
+ */
+
+/******************************************************
+ *   Host-side virtual MPU
+ *
+ *   Built only for the native PlatformIO environment (RPU_OS_HOST_SIMULATION).
+ *   RPU_DataRead/RPU_DataWrite talk to an emulated U10/U11 PIA pair wired
+ *   like a -35 MPU:
+ *
+ *     U10 PA   - switch strobes, lamp address/data, display BCD & latch strobes
+ *     U10 PB   - switch returns (and the four dip switch banks)
+ *     U10 CA1  - self test switch         U10 CB1 - zero crossing
+ *     U10 CA2  - display blanking         U10 CB2 - lamp strobe 1 / dip strobe
+ *     U11 PA   - display digit enables, display 5 latch strobe
+ *     U11 PB   - solenoid data            U11 CA2 - lamp strobe 2
+ *
+ *   Time only moves on bus cycles, delay calls and the per-loop overhead, so
+ *   a run is deterministic and goes as fast as the host can execute it.
+ *   Zero crossings and the timer 1 compare are raised from that clock and
+ *   dispatched to InterruptService3 and ISR(TIMER1_COMPA_vect) whenever the
+ *   firmware has interrupts enabled.
+ */
+
+#ifndef RPU_HOST_H
+
+#include <stdint.h>
+
+#define RPU_HOST_NUM_SWITCH_STROBES 5
+#define RPU_HOST_NUM_DIP_BANKS 4
+#define RPU_HOST_NUM_LAMPS 60
+#define RPU_HOST_NUM_DISPLAYS 5
+#define RPU_HOST_MAX_DIGITS 7
+#define RPU_HOST_NUM_SOLENOIDS 16
+#define RPU_HOST_DIGIT_BLANK 0x0F
+
+struct RPUHostOptions {
+   unsigned long phi2Hz;           // 6800 E clock the bus is synchronised to
+   unsigned long zeroCrossingHz;   // twice the mains frequency
+   unsigned long loopOverheadNanos; // charged once per loop() for the non-bus work
+   unsigned long startMillis;      // lets a run start just short of the millis() rollover
+};
+
+struct RPUHostStats {
+   unsigned long busReads;
+   unsigned long busWrites;
+   unsigned long displayInterrupts;
+   unsigned long zeroCrossings;
+   unsigned long zeroCrossingInterrupts;
+   unsigned long missedZeroCrossings; // edge arrived while the previous one was still flagged
+   unsigned long loopIterations;
+   uint64_t nanosInDisplayInterrupt;
+   uint64_t nanosInZeroCrossingInterrupt;
+   unsigned long busBursts;
+   unsigned long busBurstWrites;
+   unsigned long dataBusTurnarounds;              // data pins switched between input and output
+   unsigned long turnaroundsInDisplayInterrupt;   // (exclusive of any nested interrupt)
+   unsigned long turnaroundsInZeroCrossingInterrupt;
+   uint64_t longestLoopNanos;
+   unsigned long soundWrites;
+   uint8_t lastSoundByte;
+};
+
+//   Clock
+void RPUHost_Configure(const RPUHostOptions* options);
+void RPUHost_GetDefaultOptions(RPUHostOptions* options);
+uint64_t RPUHost_GetNanos();
+void RPUHost_AdvanceNanos(uint64_t numNanos);
+void RPUHost_EndOfLoop();
+
+//   Cabinet & playfield inputs
+// The input hook is called each time simulated time moves on (in the middle
+// of loop() and the interrupts too), so inputs can change between scans
+typedef void (*RPUHostInputHook)(uint64_t nanos);
+void RPUHost_SetInputHook(RPUHostInputHook hook);
+void RPUHost_SetSwitch(uint8_t switchNum, bool closed);
+bool RPUHost_GetSwitch(uint8_t switchNum);
+void RPUHost_SetDipSwitchBank(uint8_t bank, uint8_t value);
+void RPUHost_PressSelfTest();
+void RPUHost_SetPinLevel(uint8_t pin, uint8_t level);
+
+//   Outputs (as seen at the lamp SCRs, display glass and solenoid drivers)
+bool RPUHost_IsLampLit(uint8_t lampNum);
+uint8_t RPUHost_GetLampPassesLit(uint8_t lampNum); // of the last 8 zero crossings
+uint8_t RPUHost_GetDisplayDigit(uint8_t displayNum, uint8_t digitNum);
+unsigned long RPUHost_GetSolenoidFireCount(uint8_t solenoidNum);
+uint64_t RPUHost_GetSolenoidLastFireNanos(uint8_t solenoidNum);
+unsigned long RPUHost_GetSolenoidCycles(uint8_t solenoidNum);
+uint8_t RPUHost_GetContinuousSolenoids();
+const RPUHostStats* RPUHost_GetStats();
+void RPUHost_PrintReport();
+
+//   Playfield load generator (RPUHostLoad.cpp)
+bool RPUHost_AddLoad(const char* spec);
+void RPUHost_SetLoadSeed(uint32_t seed);
+void RPUHost_StartLoad();
+void RPUHost_NoteLoadLoop(uint64_t loopNanos);
+bool RPUHost_HaveLoad();
+void RPUHost_PrintLoadReport();
+
+// Used by the emulated bus (RPUHostPIA.cpp)
+void RPUHost_BusAccess(bool isWrite, uint8_t numCycles);
+void RPUHost_BusBurst(uint8_t numWrites);
+void RPUHost_NoteSoundWrite(uint8_t soundByte);
+void RPUHost_PIAReset();
+bool RPUHost_PIAZeroCrossing();
+bool RPUHost_PIAIrqAsserted();
+void RPUHost_PIASelfTestEdge();
+void RPUHost_PIAPrintState();
+
+#define RPU_HOST_H
+#endif
@@ -0,0 +1,372 @@
+/**************************************************************************
+ *     This file is part of the RPU for Arduino Project.
+
+    RPU is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    RPU is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    See <https://www.gnu.org/licenses/>.
+ */
+
+/******************************************************
+ *   Playfield load generator
+ *
+ *   Drives switch traffic into the emulated switch matrix from the input
+ *   hook, so closures land between scans just like a ball would make them
+ *   and the interrupt has to debounce, trigger and stack every one. A load
+ *   is given as
+ *
+ *     <kind>:<switch>[/<solenoid>][+<switch>[/<solenoid>]...]:<hz>:<start ms>:<length ms>
+ *
+ *     steady - closures at a fixed rate, taking the switches in turn
+ *              (a coin flood, or a ball stuck between two targets)
+ *     spin   - a spinner burst: starts at the rate and slows down to a
+ *              tenth of it by the end, each closure half a vane's turn
+ *     storm  - closures at random (Poisson) times with the rate as the
+ *              average, on a switch picked at random (bumpers & slings)
+ *
+ *   A switch given a solenoid is timed from the closure to the solenoid
+ *   firing, for the triggered (bumper & sling) switches. Random loads are
+ *   repeatable for a given seed.
+ */
+
+#include "RPU.h"
+#include "RPUHost.h"
+#include "RPU_config.h"
+#include <Arduino.h>
+
+#if defined(RPU_OS_HOST_SIMULATION)
+
+#define MAX_LOADS 8
+#define MAX_LOAD_SWITCHES 8
+// A steady or spinner closure is held for half its period, up to 50 ms;
+// a bumper or sling closure is held 8 to 24 ms
+#define MAX_HOLD_NANOS 50000000ULL
+#define STORM_MIN_HOLD_NANOS 8000000ULL
+#define STORM_HOLD_SPREAD_NANOS 16000000ULL
+#define SPIN_END_RATE_PERCENT 10
+
+// Main loop passes are counted in 100 us buckets for the percentiles
+#define LOOP_BUCKET_NANOS 100000ULL
+#define NUM_LOOP_BUCKETS 200
+
+#define NANOS_PER_SECOND 1000000000ULL
+#define NANOS_PER_MILLI 1000000ULL
+
+enum LoadKind {
+   LOAD_STEADY,
+   LOAD_SPIN,
+   LOAD_STORM,
+};
+
+static const char* const LoadKindNames[] = {"steady", "spin", "storm"};
+
+struct LoadSwitch {
+   uint8_t switchNum;
+   uint8_t solenoid; // SOL_NONE if the switch doesn't trigger one
+   bool closed;
+   uint64_t openNanos;
+   bool triggerPending;
+   uint64_t closeNanos;
+   unsigned long firesAtClose;
+};
+
+struct Load {
+   LoadKind kind;
+   LoadSwitch switches[MAX_LOAD_SWITCHES];
+   uint8_t numSwitches;
+   uint8_t nextSwitch;
+   unsigned long hz;
+   uint64_t startNanos;
+   uint64_t endNanos;
+   uint64_t nextCloseNanos;
+
+   unsigned long closures;
+   unsigned long triggers;
+   unsigned long triggerMisses; // closed again before the solenoid fired
+   uint64_t triggerNanosTotal;
+   uint64_t triggerNanosMax;
+};
+
+static Load Loads[MAX_LOADS];
+static int NumLoads = 0;
+static uint64_t NextLoadEventNanos = 0;
+static bool LoadsRunning = false;
+static uint32_t LoadRandomState = 0x2020C0DE;
+
+// Loads can share a switch, so what the game made of the closures is
+// reported by switch
+static unsigned long SwitchClosures[RPU_HOST_NUM_SWITCH_STROBES * 8];
+
+static unsigned long LoopBuckets[NUM_LOOP_BUCKETS + 1];
+static unsigned long NumLoops = 0;
+static uint64_t LoopNanosTotal = 0;
+static uint64_t LoopNanosMax = 0;
+
+static uint32_t LoadRandom() {
+   // xorshift32
+   LoadRandomState ^= LoadRandomState << 13;
+   LoadRandomState ^= LoadRandomState >> 17;
+   LoadRandomState ^= LoadRandomState << 5;
+   return LoadRandomState;
+}
+
+bool RPUHost_AddLoad(const char* spec) {
+   if (NumLoads >= MAX_LOADS) {
+      return false;
+   }
+   Load* load = &Loads[NumLoads];
+   memset(load, 0, sizeof(Load));
+
+   char kindName[16];
+   char switchList[96];
+   unsigned long startMillis, lengthMillis;
+   if (sscanf(spec, "%15[^:]:%95[^:]:%lu:%lu:%lu", kindName, switchList, &load->hz, &startMillis, &lengthMillis) != 5) {
+      return false;
+   }
+
+   bool knownKind = false;
+   for (uint8_t kind = 0; kind < sizeof(LoadKindNames) / sizeof(LoadKindNames[0]); kind++) {
+      if (!strcmp(kindName, LoadKindNames[kind])) {
+         load->kind = (LoadKind)kind;
+         knownKind = true;
+      }
+   }
+   if (!knownKind || load->hz == 0 || lengthMillis == 0) {
+      return false;
+   }
+
+   for (char* item = strtok(switchList, "+"); item != NULL; item = strtok(NULL, "+")) {
+      unsigned int switchNum, solenoid = SOL_NONE;
+      if (load->numSwitches >= MAX_LOAD_SWITCHES || sscanf(item, "%u/%u", &switchNum, &solenoid) < 1 ||
+          switchNum >= RPU_HOST_NUM_SWITCH_STROBES * 8 || solenoid > SOL_NONE) {
+         return false;
+      }
+      load->switches[load->numSwitches].switchNum = switchNum;
+      load->switches[load->numSwitches].solenoid = solenoid;
+      load->numSwitches += 1;
+   }
+   if (load->numSwitches == 0) {
+      return false;
+   }
+
+   load->startNanos = (uint64_t)startMillis * NANOS_PER_MILLI;
+   load->endNanos = load->startNanos + (uint64_t)lengthMillis * NANOS_PER_MILLI;
+   load->nextCloseNanos = load->startNanos;
+   NumLoads += 1;
+   return true;
+}
+
+void RPUHost_SetLoadSeed(uint32_t seed) {
+   // xorshift gets stuck on zero
+   LoadRandomState = seed ? seed : 1;
+}
+
+bool RPUHost_HaveLoad() {
+   return NumLoads > 0;
+}
+
+// Time from a closure to the next time its solenoid came on
+static void CheckTrigger(Load* load, LoadSwitch* sw, bool giveUp) {
+   if (!sw->triggerPending) {
+      return;
+   }
+   if (RPUHost_GetSolenoidFireCount(sw->solenoid) != sw->firesAtClose) {
+      uint64_t latency = RPUHost_GetSolenoidLastFireNanos(sw->solenoid) - sw->closeNanos;
+      load->triggers += 1;
+      load->triggerNanosTotal += latency;
+      if (latency > load->triggerNanosMax) {
+         load->triggerNanosMax = latency;
+      }
+      sw->triggerPending = false;
+   } else if (giveUp) {
+      load->triggerMisses += 1;
+      sw->triggerPending = false;
+   }
+}
+
+static uint64_t NextClosePeriod(Load* load, uint64_t nanos) {
+   if (load->kind == LOAD_SPIN) {
+      // Slow down in a straight line from the full rate to the end rate
+      uint64_t elapsed = nanos - load->startNanos;
+      uint64_t length = load->endNanos - load->startNanos;
+      uint64_t ratePercent = 100 - ((100 - SPIN_END_RATE_PERCENT) * elapsed) / length;
+      return (NANOS_PER_SECOND * 100) / (load->hz * ratePercent);
+   }
+   if (load->kind == LOAD_STORM) {
+      // Exponential gaps make the closures a Poisson process
+      double uniform = ((double)(LoadRandom() >> 8) + 1.0) / 16777216.0;
+      return (uint64_t)(-log(uniform) * (double)NANOS_PER_SECOND / (double)load->hz);
+   }
+   return NANOS_PER_SECOND / load->hz;
+}
+
+static void CloseLoadSwitch(Load* load, uint64_t nanos) {
+   uint64_t period = NextClosePeriod(load, nanos);
+   load->nextCloseNanos += period;
+
+   LoadSwitch* sw;
+   uint64_t holdNanos;
+   if (load->kind == LOAD_STORM) {
+      sw = &load->switches[LoadRandom() % load->numSwitches];
+      holdNanos = STORM_MIN_HOLD_NANOS + LoadRandom() % STORM_HOLD_SPREAD_NANOS;
+   } else {
+      sw = &load->switches[load->nextSwitch];
+      load->nextSwitch = (load->nextSwitch + 1) % load->numSwitches;
+      holdNanos = (period / 2 < MAX_HOLD_NANOS) ? period / 2 : MAX_HOLD_NANOS;
+   }
+   if (sw->closed) {
+      // The ball can't hit a switch that's still closed
+      return;
+   }
+
+   if (sw->solenoid != SOL_NONE) {
+      CheckTrigger(load, sw, true);
+      sw->triggerPending = true;
+      sw->closeNanos = nanos;
+      sw->firesAtClose = RPUHost_GetSolenoidFireCount(sw->solenoid);
+   }
+   RPUHost_SetSwitch(sw->switchNum, true);
+   sw->closed = true;
+   sw->openNanos = nanos + holdNanos;
+   load->closures += 1;
+   SwitchClosures[sw->switchNum] += 1;
+}
+
+static void RunLoads(uint64_t nanos) {
+   if (nanos < NextLoadEventNanos) {
+      return;
+   }
+#if defined(RPU_OS_TRACK_SWITCH_LATENCY)
+   if (!LoadsRunning) {
+      // Only count what the loads put on the stack
+      RPU_ResetSwitchLatency();
+   }
+#endif
+   LoadsRunning = true;
+
+   NextLoadEventNanos = UINT64_MAX;
+   for (int loadNum = 0; loadNum < NumLoads; loadNum++) {
+      Load* load = &Loads[loadNum];
+
+      for (uint8_t switchNum = 0; switchNum < load->numSwitches; switchNum++) {
+         LoadSwitch* sw = &load->switches[switchNum];
+         if (sw->closed && nanos >= sw->openNanos) {
+            RPUHost_SetSwitch(sw->switchNum, false);
+            sw->closed = false;
+         }
+      }
+
+      while (load->nextCloseNanos <= nanos && load->nextCloseNanos < load->endNanos) {
+         CloseLoadSwitch(load, nanos);
+      }
+
+      if (load->nextCloseNanos < load->endNanos && load->nextCloseNanos < NextLoadEventNanos) {
+         NextLoadEventNanos = load->nextCloseNanos;
+      }
+      for (uint8_t switchNum = 0; switchNum < load->numSwitches; switchNum++) {
+         LoadSwitch* sw = &load->switches[switchNum];
+         if (sw->closed && sw->openNanos < NextLoadEventNanos) {
+            NextLoadEventNanos = sw->openNanos;
+         }
+      }
+   }
+}
+
+void RPUHost_StartLoad() {
+   if (NumLoads == 0) {
+      return;
+   }
+   NextLoadEventNanos = UINT64_MAX;
+   for (int loadNum = 0; loadNum < NumLoads; loadNum++) {
+      if (Loads[loadNum].startNanos < NextLoadEventNanos) {
+         NextLoadEventNanos = Loads[loadNum].startNanos;
+      }
+   }
+   RPUHost_SetInputHook(RunLoads);
+}
+
+void RPUHost_NoteLoadLoop(uint64_t loopNanos) {
+   NumLoops += 1;
+   LoopNanosTotal += loopNanos;
+   if (loopNanos > LoopNanosMax) {
+      LoopNanosMax = loopNanos;
+   }
+   uint64_t bucket = loopNanos / LOOP_BUCKET_NANOS;
+   LoopBuckets[(bucket < NUM_LOOP_BUCKETS) ? bucket : NUM_LOOP_BUCKETS] += 1;
+
+   for (int loadNum = 0; loadNum < NumLoads; loadNum++) {
+      for (uint8_t switchNum = 0; switchNum < Loads[loadNum].numSwitches; switchNum++) {
+         CheckTrigger(&Loads[loadNum], &Loads[loadNum].switches[switchNum], false);
+      }
+   }
+}
+
+// Upper edge of the bucket the given share of loop passes fit under
+static double LoopPercentileMicros(unsigned long perThousand) {
+   unsigned long target = (NumLoops * perThousand + 999) / 1000;
+   unsigned long count = 0;
+   for (int bucket = 0; bucket < NUM_LOOP_BUCKETS; bucket++) {
+      count += LoopBuckets[bucket];
+      if (count >= target) {
+         return (double)((bucket + 1) * LOOP_BUCKET_NANOS) / 1000.0;
+      }
+   }
+   return (double)LoopNanosMax / 1000.0;
+}
+
+// One key=value per line so a CI job can diff or graph them run to run
+void RPUHost_PrintLoadReport() {
+   const RPUHostStats* stats = RPUHost_GetStats();
+
+   for (int loadNum = 0; loadNum < NumLoads; loadNum++) {
+      Load* load = &Loads[loadNum];
+      bool hasTriggers = false;
+      for (uint8_t switchNum = 0; switchNum < load->numSwitches; switchNum++) {
+         CheckTrigger(load, &load->switches[switchNum], false);
+         hasTriggers |= (load->switches[switchNum].solenoid != SOL_NONE);
+      }
+
+      printf("load.%d.kind=%s\n", loadNum, LoadKindNames[load->kind]);
+      printf("load.%d.closures=%lu\n", loadNum, load->closures);
+      if (hasTriggers) {
+         printf("load.%d.triggers=%lu\n", loadNum, load->triggers);
+         printf("load.%d.trigger_misses=%lu\n", loadNum, load->triggerMisses);
+         printf("load.%d.trigger_latency_mean_us=%.1f\n", loadNum,
+                load->triggers ? (double)load->triggerNanosTotal / load->triggers / 1000.0 : 0.0);
+         printf("load.%d.trigger_latency_max_us=%.1f\n", loadNum, (double)load->triggerNanosMax / 1000.0);
+      }
+   }
+
+   for (uint8_t switchNum = 0; switchNum < RPU_HOST_NUM_SWITCH_STROBES * 8; switchNum++) {
+      if (SwitchClosures[switchNum] == 0) {
+         continue;
+      }
+      printf("switch.%d.closures=%lu\n", switchNum, SwitchClosures[switchNum]);
+#if defined(RPU_OS_TRACK_SWITCH_LATENCY)
+      // Closures the debounce let through, as the game pulled them off the stack
+      uint16_t stackWaitMax;
+      printf("switch.%d.stacked=%u\n", switchNum, RPU_GetSwitchLatency(switchNum, &stackWaitMax));
+      printf("switch.%d.stack_wait_max_us=%u\n", switchNum, stackWaitMax);
+#endif
+   }
+
+   printf("soak.switch_stack_drops=%lu\n", RPU_GetSwitchStackDrops());
+   printf("soak.switch_stack_peak=%d\n", RPU_GetSwitchStackPeak());
+   printf("soak.solenoid_stack_drops=%lu\n", RPU_GetSolenoidStackDrops());
+   printf("soak.timed_solenoid_stack_drops=%lu\n", RPU_GetTimedSolenoidStackDrops());
+   printf("soak.solenoid_stack_peak=%d\n", RPU_GetSolenoidStackPeak());
+   printf("soak.missed_zero_crossings=%lu\n", stats->missedZeroCrossings);
+   printf("soak.loops=%lu\n", NumLoops);
+   printf("soak.loop_period_mean_us=%.1f\n", NumLoops ? (double)LoopNanosTotal / NumLoops / 1000.0 : 0.0);
+   printf("soak.loop_period_p99_us=%.1f\n", LoopPercentileMicros(990));
+   printf("soak.loop_period_max_us=%.1f\n", (double)LoopNanosMax / 1000.0);
+}
+
+#endif
@@ -0,0 +1,398 @@
+/**************************************************************************
+ *     This file is part of the RPU for Arduino Project.
+
+    RPU is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    RPU is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    See <https://www.gnu.org/licenses/>.
+ */
+
+#include "RPU.h"
+#include "RPUHost.h"
+#include "RPU_config.h"
+#include <Arduino.h>
+#include <EEPROM.h>
+
+#if defined(RPU_OS_HOST_SIMULATION)
+
+// Provided by the game (src/main.cpp)
+void setup();
+void loop();
+
+#define MAX_SCHEDULED_SWITCHES 64
+#define DEFAULT_SWITCH_HOLD_MS 50
+
+struct ScheduledSwitch {
+   unsigned long closeMillis;
+   unsigned long openMillis;
+   uint8_t switchNum;
+   bool closed;
+};
+
+static ScheduledSwitch ScheduledSwitches[MAX_SCHEDULED_SWITCHES];
+static int NumScheduledSwitches = 0;
+
+static void PrintUsage(const char* programName) {
+   printf("Usage: %s [options]\n", programName);
+   printf("  --run-ms <ms>                 simulated run time (default 10000)\n");
+   printf("  --phi2-hz <hz>                6800 E clock (default 530000)\n");
+   printf("  --mains-hz <hz>               line frequency, 50 or 60 (default 60)\n");
+   printf("  --loop-ns <ns>                non-bus time charged per loop() (default 20000)\n");
+   printf("  --start-ms <ms>               starting millis(), e.g. 4294960000 to cross the rollover\n");
+   printf("  --eeprom <file>               load EEPROM from (and save it back to) a file\n");
+   printf("  --serial                      echo Serial output to stdout\n");
+   printf("  --switch <ms>:<num>[:<hold>]  close a switch at a time for hold ms (default 50)\n");
+   printf("  --self-test <ms>              press the self test button at a time\n");
+   printf("  --dip <bank>:<value>          set a dip switch bank (0-3)\n");
+   printf("  --load <kind>:<switches>:<hz>:<start>:<ms>\n");
+   printf("                                drive switch traffic (see RPUHostLoad.cpp) and print a\n");
+   printf("                                key=value soak report, e.g. spin:4:60:5000:3000 or\n");
+   printf("                                storm:14/0+15/1:20:5000:10000 (switch/solenoid)\n");
+   printf("  --load-seed <n>               seed for the random (storm) loads\n");
+#if defined(RPU_OS_RECORD_SWITCHES)
+   printf("  --record <file>               record the switch matrix (from the end of setup)\n");
+   printf("  --replay <file>               play a switch recording back into the matrix\n");
+#endif
+}
+
+static bool ScheduleSwitch(const char* spec) {
+   unsigned long closeMillis, switchNum, holdMillis = DEFAULT_SWITCH_HOLD_MS;
+   int numFields = sscanf(spec, "%lu:%lu:%lu", &closeMillis, &switchNum, &holdMillis);
+   if (numFields < 2 || NumScheduledSwitches >= MAX_SCHEDULED_SWITCHES) {
+      return false;
+   }
+   ScheduledSwitches[NumScheduledSwitches].closeMillis = closeMillis;
+   ScheduledSwitches[NumScheduledSwitches].openMillis = closeMillis + holdMillis;
+   ScheduledSwitches[NumScheduledSwitches].switchNum = (uint8_t)switchNum;
+   ScheduledSwitches[NumScheduledSwitches].closed = false;
+   NumScheduledSwitches += 1;
+   return true;
+}
+
+static void ApplyScheduledSwitches(unsigned long runMillis) {
+   for (int count = 0; count < NumScheduledSwitches; count++) {
+      ScheduledSwitch* sw = &ScheduledSwitches[count];
+      bool shouldBeClosed = (runMillis >= sw->closeMillis && runMillis < sw->openMillis);
+      if (shouldBeClosed != sw->closed) {
+         sw->closed = shouldBeClosed;
+         RPUHost_SetSwitch(sw->switchNum, shouldBeClosed);
+      }
+   }
+}
+
+#if defined(RPU_OS_RECORD_SWITCHES)
+/******************************************************
+ *   Switch recording & replay
+ *
+ *   A recording (see RPU_StartSwitchRecording) is played back into the
+ *   switch matrix from the firmware's scan hook, so every change lands on
+ *   the same scan it was recorded on and the interrupt debounces, triggers
+ *   solenoids and stacks switches just like it did the first time.
+ *   Events are kept as scans after the recording started, and replay
+ *   starts counting at the end of setup (where the host starts recording),
+ *   so it doesn't matter how many scans either run took to boot.
+ */
+struct ReplayEvent {
+   unsigned long scanNumber; // since the start of the recording
+   uint8_t switchCode;
+   unsigned long loops;      // from this event to the next one
+   uint64_t longestLoopNanos;
+   uint64_t interruptNanos;
+};
+
+static FILE* RecordFile = NULL;
+static ReplayEvent* ReplayEvents = NULL;
+static int NumReplayEvents = 0;
+static int NextReplayEvent = 0;
+static unsigned long ReplayScanNumber = 0;
+static uint16_t ReplayLastScan = 0;
+
+static uint64_t InterruptNanos() {
+   const RPUHostStats* stats = RPUHost_GetStats();
+   return stats->nanosInDisplayInterrupt + stats->nanosInZeroCrossingInterrupt;
+}
+
+static void WriteRecording(const uint8_t* data, uint8_t numBytes) {
+   fwrite(data, 1, numBytes, RecordFile);
+}
+
+static bool LoadReplay(const char* fileName) {
+   FILE* file = fopen(fileName, "rb");
+   if (file == NULL) {
+      return false;
+   }
+   fseek(file, 0, SEEK_END);
+   long numBytes = ftell(file);
+   fseek(file, 0, SEEK_SET);
+   uint8_t* data = (uint8_t*)malloc(numBytes > 0 ? numBytes : 1);
+   bool readAll = (numBytes > 0 && fread(data, 1, numBytes, file) == (size_t)numBytes);
+   fclose(file);
+
+   if (!readAll || numBytes < 5 || data[0] != 'R' || data[1] != 'S' || data[2] != 1) {
+      free(data);
+      return false;
+   }
+
+   ReplayEvents = (ReplayEvent*)calloc(numBytes / 2, sizeof(ReplayEvent));
+   // data[3] & data[4] are the recorder's own scan count at the start,
+   // which only matters to that run
+   unsigned long scanNumber = 0;
+   for (long pos = 5; pos < numBytes; pos++) {
+      if (data[pos] == 0xFF) {
+         scanNumber += 0xFF;
+         continue;
+      }
+      if (pos + 1 >= numBytes) {
+         // Cut off in the middle of an event
+         break;
+      }
+      scanNumber += data[pos];
+      ReplayEvents[NumReplayEvents].scanNumber = scanNumber;
+      ReplayEvents[NumReplayEvents].switchCode = data[pos + 1];
+      NumReplayEvents += 1;
+      pos += 1;
+   }
+   free(data);
+   return true;
+}
+
+// Called from the interrupt just before each switch scan
+static void ReplaySwitchScan(uint16_t scanNumber) {
+   ReplayScanNumber += (uint16_t)(scanNumber - ReplayLastScan);
+   ReplayLastScan = scanNumber;
+
+   while (NextReplayEvent < NumReplayEvents) {
+      ReplayEvent* event = &ReplayEvents[NextReplayEvent];
+      // The self test switch is checked before the scan, so it has to be
+      // pressed during the scan before
+      bool selfTest = (event->switchCode == SW_SELF_TEST_SWITCH);
+      unsigned long dueScan = event->scanNumber;
+      if (selfTest && dueScan > 0) {
+         dueScan -= 1;
+      }
+      if (ReplayScanNumber < dueScan) {
+         break;
+      }
+      if (selfTest) {
+         RPUHost_PressSelfTest();
+      } else {
+         RPUHost_SetSwitch(event->switchCode & 0x7F, (event->switchCode & 0x80) == 0);
+      }
+      event->interruptNanos = InterruptNanos();
+      NextReplayEvent += 1;
+   }
+}
+
+static void NoteReplayLoop(uint64_t loopNanos) {
+   if (NextReplayEvent == 0) {
+      return;
+   }
+   ReplayEvent* event = &ReplayEvents[NextReplayEvent - 1];
+   event->loops += 1;
+   if (loopNanos > event->longestLoopNanos) {
+      event->longestLoopNanos = loopNanos;
+   }
+}
+
+static void PrintReplayReport() {
+   printf("Replayed switches       %d of %d\n", NextReplayEvent, NumReplayEvents);
+   printf("      scan  switch    loops  longest(us)  interrupts(us)\n");
+   for (int eventNum = 0; eventNum < NextReplayEvent; eventNum++) {
+      ReplayEvent* event = &ReplayEvents[eventNum];
+      // Each event's window runs until the next one
+      uint64_t windowEnd = (eventNum + 1 < NextReplayEvent) ? ReplayEvents[eventNum + 1].interruptNanos : InterruptNanos();
+      char switchName[8];
+      if (event->switchCode == SW_SELF_TEST_SWITCH) {
+         sprintf(switchName, "test");
+      } else {
+         sprintf(switchName, "%d %s", event->switchCode & 0x7F, (event->switchCode & 0x80) ? "off" : "on");
+      }
+      printf("%10lu  %-7s %8lu %12.1f %15.1f\n", event->scanNumber, switchName, event->loops, (double)event->longestLoopNanos / 1000.0,
+             (double)(windowEnd - event->interruptNanos) / 1000.0);
+   }
+}
+#endif
+
+int main(int argc, char** argv) {
+   RPUHostOptions options;
+   RPUHost_GetDefaultOptions(&options);
+
+   unsigned long runMillis = 10000;
+   unsigned long selfTestMillis = 0xFFFFFFFF;
+   const char* eepromFile = NULL;
+#if defined(RPU_OS_RECORD_SWITCHES)
+   const char* recordFile = NULL;
+   const char* replayFile = NULL;
+#endif
+   bool echoSerial = false;
+   uint8_t dipBanks[RPU_HOST_NUM_DIP_BANKS] = {0, 0, 0, 0};
+
+   for (int argNum = 1; argNum < argc; argNum++) {
+      const char* arg = argv[argNum];
+      const char* value = (argNum + 1 < argc) ? argv[argNum + 1] : NULL;
+      bool usedValue = true;
+
+      if (!strcmp(arg, "--serial")) {
+         echoSerial = true;
+         usedValue = false;
+      } else if (value == NULL) {
+         PrintUsage(argv[0]);
+         return 1;
+      } else if (!strcmp(arg, "--run-ms")) {
+         runMillis = strtoul(value, NULL, 0);
+      } else if (!strcmp(arg, "--phi2-hz")) {
+         options.phi2Hz = strtoul(value, NULL, 0);
+      } else if (!strcmp(arg, "--mains-hz")) {
+         options.zeroCrossingHz = 2 * strtoul(value, NULL, 0);
+      } else if (!strcmp(arg, "--loop-ns")) {
+         options.loopOverheadNanos = strtoul(value, NULL, 0);
+      } else if (!strcmp(arg, "--start-ms")) {
+         options.startMillis = strtoul(value, NULL, 0);
+      } else if (!strcmp(arg, "--eeprom")) {
+         eepromFile = value;
+      } else if (!strcmp(arg, "--switch")) {
+         if (!ScheduleSwitch(value)) {
+            PrintUsage(argv[0]);
+            return 1;
+         }
+#if defined(RPU_OS_RECORD_SWITCHES)
+      } else if (!strcmp(arg, "--record")) {
+         recordFile = value;
+      } else if (!strcmp(arg, "--replay")) {
+         replayFile = value;
+#else
+      } else if (!strcmp(arg, "--record") || !strcmp(arg, "--replay")) {
+         fprintf(stderr, "%s needs RPU_OS_RECORD_SWITCHES (build the rpu_os_host_record environment)\n", arg);
+         return 1;
+#endif
+      } else if (!strcmp(arg, "--self-test")) {
+         selfTestMillis = strtoul(value, NULL, 0);
+      } else if (!strcmp(arg, "--dip")) {
+         unsigned int bank, bankValue;
+         if (sscanf(value, "%u:%i", &bank, &bankValue) != 2 || bank >= RPU_HOST_NUM_DIP_BANKS) {
+            PrintUsage(argv[0]);
+            return 1;
+         }
+         dipBanks[bank] = (uint8_t)bankValue;
+      } else if (!strcmp(arg, "--load")) {
+         if (!RPUHost_AddLoad(value)) {
+            PrintUsage(argv[0]);
+            return 1;
+         }
+      } else if (!strcmp(arg, "--load-seed")) {
+         RPUHost_SetLoadSeed(strtoul(value, NULL, 0));
+      } else {
+         PrintUsage(argv[0]);
+         return 1;
+      }
+
+      if (usedValue) {
+         argNum += 1;
+      }
+   }
+
+   RPUHost_Configure(&options);
+   for (uint8_t bank = 0; bank < RPU_HOST_NUM_DIP_BANKS; bank++) {
+      RPUHost_SetDipSwitchBank(bank, dipBanks[bank]);
+   }
+   if (eepromFile && !EEPROM.Load(eepromFile)) {
+      printf("Starting with an erased EEPROM (couldn't read %s)\n", eepromFile);
+   }
+   Serial.SetEcho(echoSerial);
+
+#if defined(RPU_OS_RECORD_SWITCHES)
+   if (replayFile != NULL) {
+      if (!LoadReplay(replayFile)) {
+         fprintf(stderr, "Can't read switch recording %s\n", replayFile);
+         return 1;
+      }
+   }
+#endif
+
+   setup();
+
+#if defined(RPU_OS_RECORD_SWITCHES)
+   if (ReplayEvents != NULL) {
+      ReplayLastScan = RPU_GetSwitchScanNumber();
+      RPU_SetSwitchScanHook(ReplaySwitchScan);
+   }
+
+   if (recordFile != NULL) {
+      RecordFile = fopen(recordFile, "wb");
+      if (RecordFile == NULL) {
+         fprintf(stderr, "Can't write switch recording %s\n", recordFile);
+         return 1;
+      }
+      RPU_StartSwitchRecording(WriteRecording);
+   }
+#endif
+   RPUHost_StartLoad();
+
+   uint64_t runNanos = (uint64_t)runMillis * 1000000ULL;
+   while (RPUHost_GetNanos() < runNanos) {
+      unsigned long elapsedMillis = (unsigned long)(RPUHost_GetNanos() / 1000000ULL);
+      ApplyScheduledSwitches(elapsedMillis);
+      if (elapsedMillis >= selfTestMillis) {
+         RPUHost_PressSelfTest();
+         selfTestMillis = 0xFFFFFFFF;
+      }
+      uint64_t loopStart = RPUHost_GetNanos();
+      loop();
+      RPUHost_EndOfLoop();
+      uint64_t loopNanos = RPUHost_GetNanos() - loopStart;
+      if (RPUHost_HaveLoad()) {
+         RPUHost_NoteLoadLoop(loopNanos);
+      }
+#if defined(RPU_OS_RECORD_SWITCHES)
+      NoteReplayLoop(loopNanos);
+#endif
+   }
+
+   RPUHost_PrintReport();
+   printf("Solenoid stack drops    %lu (peak %d entries)\n", RPU_GetSolenoidStackDrops(), RPU_GetSolenoidStackPeak());
+   printf("Switch stack peak       %d\n", RPU_GetSwitchStackPeak());
+#if defined(RPU_OS_CHECK_PIA_SHADOWS)
+   printf("PIA shadow mismatches   %lu\n", RPU_GetPIAShadowMismatches());
+#endif
+#if defined(RPU_OS_PROFILE_INTERRUPTS)
+   Serial.SetEcho(true);
+   RPU_DumpInterruptProfile();
+#endif
+#if defined(RPU_OS_TRACK_SWITCH_LATENCY)
+   Serial.SetEcho(true);
+   RPU_DumpSwitchLatency();
+#endif
+#if defined(RPU_OS_RECORD_SWITCHES)
+   if (RecordFile != NULL) {
+      RPU_UpdateSwitchRecording();
+      RPU_StopSwitchRecording();
+      fclose(RecordFile);
+      printf("Switch record drops     %lu\n", RPU_GetSwitchRecordDrops());
+   }
+   if (ReplayEvents != NULL) {
+      PrintReplayReport();
+   }
+#endif
+   if (RPUHost_HaveLoad()) {
+      RPUHost_PrintLoadReport();
+   }
+
+#if defined(RPU_OS_USE_EEPROM_CACHE)
+   printf("EEPROM bytes pending    %u\n", RPU_GetEEPromCacheNumDirty());
+   RPU_FlushEEPromCache();
+#endif
+   if (eepromFile && !EEPROM.Save(eepromFile)) {
+      printf("Couldn't write %s\n", eepromFile);
+      return 1;
+   }
+   return 0;
+}
+
+#endif
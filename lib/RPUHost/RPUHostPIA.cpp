@@ -0,0 +1,442 @@
+/**************************************************************************
+ *     This file is part of the RPU for Arduino Project.
+
+    RPU is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    RPU is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    See <https://www.gnu.org/licenses/>.
+ */
+
+#include "OsHardware.h"
+#include "RPU.h"
+#include "RPUHost.h"
+#include "RPU_config.h"
+#include <Arduino.h>
+
+#if defined(RPU_OS_HOST_SIMULATION)
+
+// The MC6821 register select lines sit on A0 & A1
+#define PIA_REGISTER_MASK 0x03
+#define PIA_SIDE_A 0
+#define PIA_SIDE_B 1
+
+// Control register bits
+#define PIA_CR_C1_IRQ_ENABLE 0x01
+#define PIA_CR_C1_RISING_EDGE 0x02
+#define PIA_CR_DATA_ACCESS 0x04
+#define PIA_CR_C2_LEVEL 0x08
+#define PIA_CR_C2_OUTPUT_MANUAL 0x30
+#define PIA_CR_IRQ1_FLAG 0x80
+#define PIA_CR_IRQ2_FLAG 0x40
+
+// Approximate E cycles per access for the Arduino's bit-banged bus
+// (a write waits out about two edges, a read waits an extra cycle for data)
+#define BUS_CYCLES_PER_WRITE 2
+#define BUS_CYCLES_PER_READ 3
+
+struct PIASide {
+   uint8_t dataDirection;
+   uint8_t output;
+   uint8_t control;
+   bool c2Level;
+};
+
+struct PIA {
+   PIASide side[2];
+};
+
+static PIA U10;
+static PIA U11;
+
+static uint8_t SwitchStrobeReturns[RPU_HOST_NUM_SWITCH_STROBES];
+static uint8_t DipSwitchBanks[RPU_HOST_NUM_DIP_BANKS];
+
+// Four 4514 decoders share one latched address. A lamp SCR that gets gated
+// stays on until the next zero crossing.
+static uint8_t LampAddressLatch = 0x0F;
+static uint8_t LampsGated[(RPU_HOST_NUM_LAMPS + 7) / 8];
+static uint8_t LampsLit[(RPU_HOST_NUM_LAMPS + 7) / 8];
+// One bit per zero crossing for the last 8 (one lamp brightness frame)
+static uint8_t LampHistory[RPU_HOST_NUM_LAMPS];
+
+// One BCD latch per display, multiplexed across the digits by U11 PA
+static uint8_t DisplayLatch[RPU_HOST_NUM_DISPLAYS];
+static uint8_t DisplayGlass[RPU_HOST_NUM_DISPLAYS][RPU_HOST_MAX_DIGITS];
+
+static uint8_t MomentarySolenoid = SOL_NONE;
+static uint8_t ContinuousSolenoids = 0;
+static unsigned long SolenoidFires[RPU_HOST_NUM_SOLENOIDS];
+static unsigned long SolenoidCycles[RPU_HOST_NUM_SOLENOIDS];
+static uint64_t SolenoidLastFireNanos[RPU_HOST_NUM_SOLENOIDS];
+
+/******************************************************
+ *   Board wiring
+ */
+
+static uint8_t PortPins(const PIASide& side) {
+   // Pins programmed as inputs float high
+   return (side.output & side.dataDirection) | (~side.dataDirection & 0xFF);
+}
+
+static uint8_t ReadSwitchReturns() {
+   uint8_t strobes = PortPins(U10.side[PIA_SIDE_A]);
+   uint8_t returns = 0x00;
+
+   for (uint8_t count = 0; count < RPU_HOST_NUM_SWITCH_STROBES; count++) {
+      if (strobes & (0x01 << count)) {
+         returns |= SwitchStrobeReturns[count];
+      }
+   }
+   // PA5-PA7 and CB2 strobe the four dip switch banks
+   for (uint8_t count = 0; count < 3; count++) {
+      if (strobes & (0x20 << count)) {
+         returns |= DipSwitchBanks[count];
+      }
+   }
+   if (U10.side[PIA_SIDE_B].c2Level) {
+      returns |= DipSwitchBanks[3];
+   }
+
+   return returns;
+}
+
+static void GateLamps() {
+   if (LampAddressLatch >= 0x0F) {
+      // Address 15 is where the OS parks the decoders
+      return;
+   }
+
+   uint8_t lampData = PortPins(U10.side[PIA_SIDE_A]);
+   for (uint8_t decoder = 0; decoder < 4; decoder++) {
+      // Data lines are the decoder inhibits (active low)
+      if (!(lampData & (0x10 << decoder))) {
+         uint8_t lampNum = LampAddressLatch * 4 + decoder;
+         if (lampNum < RPU_HOST_NUM_LAMPS) {
+            LampsGated[lampNum / 8] |= (0x01 << (lampNum % 8));
+         }
+      }
+   }
+}
+
+static void LatchScoreDisplays() {
+   // U10 CA2 is NOR'd with the four latch strobes, so they only work while blanked
+   if (U10.side[PIA_SIDE_A].c2Level) {
+      return;
+   }
+
+   uint8_t displayData = PortPins(U10.side[PIA_SIDE_A]);
+   for (uint8_t displayCount = 0; displayCount < 4; displayCount++) {
+      if (!(displayData & (0x01 << displayCount))) {
+         DisplayLatch[displayCount] = displayData >> 4;
+      }
+   }
+}
+
+static void RefreshDisplayGlass() {
+   uint8_t digitEnables = PortPins(U11.side[PIA_SIDE_A]);
+
+   for (uint8_t digitCount = 0; digitCount < RPU_OS_NUM_DIGITS; digitCount++) {
+#ifdef RPU_OS_USE_7_DIGIT_DISPLAYS
+      uint8_t digitBit = (0x02 << digitCount);
+#else
+      uint8_t digitBit = (0x04 << digitCount);
+#endif
+      if (!(digitEnables & digitBit)) {
+         continue;
+      }
+      for (uint8_t displayCount = 0; displayCount < RPU_HOST_NUM_DISPLAYS; displayCount++) {
+         uint8_t bcd = DisplayLatch[displayCount];
+         DisplayGlass[displayCount][digitCount] = (bcd > 9) ? RPU_HOST_DIGIT_BLANK : bcd;
+      }
+   }
+}
+
+static void U10PortAChanged() {
+   if (U10.side[PIA_SIDE_B].c2Level) {
+      // Lamp strobe high means the address latches are transparent
+      LampAddressLatch = PortPins(U10.side[PIA_SIDE_A]) & 0x0F;
+   }
+   GateLamps();
+   LatchScoreDisplays();
+}
+
+static void U10C2Changed(uint8_t sideNum, bool level) {
+   if (sideNum == PIA_SIDE_B) {
+      if (level) {
+         LampAddressLatch = PortPins(U10.side[PIA_SIDE_A]) & 0x0F;
+      }
+      GateLamps();
+   } else {
+      if (level) {
+         // Coming out of blanking lights the enabled digit
+         RefreshDisplayGlass();
+      } else {
+         LatchScoreDisplays();
+      }
+   }
+}
+
+static void U11PortAChanged() {
+   // Display 5 (credit/ball in play) latches off U11 PA0 instead of U10
+   if (!(PortPins(U11.side[PIA_SIDE_A]) & 0x01)) {
+      DisplayLatch[4] = PortPins(U10.side[PIA_SIDE_A]) >> 4;
+   }
+}
+
+static void U11PortBChanged() {
+   uint8_t solenoidData = PortPins(U11.side[PIA_SIDE_B]);
+   uint8_t momentary = solenoidData & 0x0F;
+
+   if (momentary != SOL_NONE && momentary != MomentarySolenoid) {
+      SolenoidFires[momentary] += 1;
+      SolenoidLastFireNanos[momentary] = RPUHost_GetNanos();
+   }
+   MomentarySolenoid = momentary;
+   ContinuousSolenoids = solenoidData & 0xF0;
+}
+
+static void PortChanged(PIA* pia, uint8_t sideNum) {
+   if (pia == &U10 && sideNum == PIA_SIDE_A) {
+      U10PortAChanged();
+   } else if (pia == &U11 && sideNum == PIA_SIDE_A) {
+      U11PortAChanged();
+   } else if (pia == &U11 && sideNum == PIA_SIDE_B) {
+      U11PortBChanged();
+   }
+}
+
+static void C2Changed(PIA* pia, uint8_t sideNum, bool level) {
+   if (pia == &U10) {
+      U10C2Changed(sideNum, level);
+   }
+   // U11 CA2 (lamp strobe 2 / test LED) and CB2 (solenoid bank select) aren't modelled
+}
+
+/******************************************************
+ *   MC6821
+ */
+
+static uint8_t PIARead(PIA* pia, uint8_t registerNum) {
+   PIASide& side = pia->side[registerNum >> 1];
+
+   if (registerNum & 0x01) {
+      return side.control;
+   }
+
+   if (!(side.control & PIA_CR_DATA_ACCESS)) {
+      return side.dataDirection;
+   }
+
+   uint8_t inputs = 0xFF;
+   if (pia == &U10 && (registerNum >> 1) == PIA_SIDE_B) {
+      inputs = ReadSwitchReturns();
+   }
+
+   // Reading the peripheral register clears both interrupt flags
+   side.control &= ~(PIA_CR_IRQ1_FLAG | PIA_CR_IRQ2_FLAG);
+   return (side.output & side.dataDirection) | (inputs & ~side.dataDirection);
+}
+
+static void PIAWrite(PIA* pia, uint8_t registerNum, uint8_t data) {
+   uint8_t sideNum = registerNum >> 1;
+   PIASide& side = pia->side[sideNum];
+
+   if (registerNum & 0x01) {
+      // The two flag bits are read-only
+      side.control = (side.control & (PIA_CR_IRQ1_FLAG | PIA_CR_IRQ2_FLAG)) | (data & 0x3F);
+      if ((data & PIA_CR_C2_OUTPUT_MANUAL) == PIA_CR_C2_OUTPUT_MANUAL) {
+         bool level = (data & PIA_CR_C2_LEVEL) ? true : false;
+         if (level != side.c2Level) {
+            side.c2Level = level;
+            C2Changed(pia, sideNum, level);
+         }
+      }
+      return;
+   }
+
+   if (side.control & PIA_CR_DATA_ACCESS) {
+      side.output = data;
+   } else {
+      side.dataDirection = data;
+   }
+   PortChanged(pia, sideNum);
+}
+
+static PIA* DecodePIA(int address) {
+   if ((address & ~PIA_REGISTER_MASK) == ADDRESS_U10_A) {
+      return &U10;
+   }
+   if ((address & ~PIA_REGISTER_MASK) == ADDRESS_U11_A) {
+      return &U11;
+   }
+   return NULL;
+}
+
+/******************************************************
+ *   Bus entry points (replace the per-rev versions in RPU.cpp)
+ */
+
+void RPU_DataWrite(int address, uint8_t data) {
+   PIA* pia = DecodePIA(address);
+   if (pia) {
+      PIAWrite(pia, address & PIA_REGISTER_MASK, data);
+   } else if (address >= ADDRESS_SB100) {
+      RPUHost_NoteSoundWrite(data);
+   }
+   RPUHost_BusAccess(true, BUS_CYCLES_PER_WRITE);
+}
+
+void RPU_DataWriteBurst(const BusOp* ops, uint8_t numOps) {
+   RPUHost_BusBurst(numOps);
+   for (uint8_t opCount = 0; opCount < numOps; opCount++) {
+      RPU_DataWrite(ops[opCount].address, ops[opCount].data);
+   }
+}
+
+uint8_t RPU_DataRead(int address) {
+   uint8_t data = 0x00;
+   PIA* pia = DecodePIA(address);
+   if (pia) {
+      data = PIARead(pia, address & PIA_REGISTER_MASK);
+   }
+   RPUHost_BusAccess(false, BUS_CYCLES_PER_READ);
+   return data;
+}
+
+/******************************************************
+ *   Host side
+ */
+
+void RPUHost_PIAReset() {
+   memset(&U10, 0, sizeof(U10));
+   memset(&U11, 0, sizeof(U11));
+   LampAddressLatch = 0x0F;
+   memset(LampsGated, 0, sizeof(LampsGated));
+   memset(LampsLit, 0, sizeof(LampsLit));
+   memset(LampHistory, 0, sizeof(LampHistory));
+   memset(DisplayLatch, 0x0F, sizeof(DisplayLatch));
+   memset(DisplayGlass, RPU_HOST_DIGIT_BLANK, sizeof(DisplayGlass));
+   MomentarySolenoid = SOL_NONE;
+   ContinuousSolenoids = 0;
+   memset(SolenoidFires, 0, sizeof(SolenoidFires));
+   memset(SolenoidCycles, 0, sizeof(SolenoidCycles));
+   memset(SolenoidLastFireNanos, 0, sizeof(SolenoidLastFireNanos));
+}
+
+bool RPUHost_PIAZeroCrossing() {
+   // The SCRs drop out as the AC crosses zero
+   memcpy(LampsLit, LampsGated, sizeof(LampsLit));
+   memset(LampsGated, 0, sizeof(LampsGated));
+   for (uint8_t lampNum = 0; lampNum < RPU_HOST_NUM_LAMPS; lampNum++) {
+      LampHistory[lampNum] = (LampHistory[lampNum] << 1) | RPUHost_IsLampLit(lampNum);
+   }
+
+   if (MomentarySolenoid != SOL_NONE) {
+      SolenoidCycles[MomentarySolenoid] += 1;
+   }
+
+   PIASide& cb = U10.side[PIA_SIDE_B];
+   bool stillPending = (cb.control & PIA_CR_IRQ1_FLAG) ? true : false;
+   cb.control |= PIA_CR_IRQ1_FLAG;
+   return stillPending;
+}
+
+void RPUHost_PIASelfTestEdge() {
+   U10.side[PIA_SIDE_A].control |= PIA_CR_IRQ1_FLAG;
+}
+
+bool RPUHost_PIAIrqAsserted() {
+   const PIA* pias[2] = {&U10, &U11};
+   for (uint8_t piaCount = 0; piaCount < 2; piaCount++) {
+      for (uint8_t sideNum = 0; sideNum < 2; sideNum++) {
+         uint8_t control = pias[piaCount]->side[sideNum].control;
+         if ((control & PIA_CR_IRQ1_FLAG) && (control & PIA_CR_C1_IRQ_ENABLE)) {
+            return true;
+         }
+      }
+   }
+   return false;
+}
+
+void RPUHost_SetSwitch(uint8_t switchNum, bool closed) {
+   if (switchNum >= RPU_HOST_NUM_SWITCH_STROBES * 8) {
+      return;
+   }
+   uint8_t switchBit = 0x01 << (switchNum % 8);
+   if (closed) {
+      SwitchStrobeReturns[switchNum / 8] |= switchBit;
+   } else {
+      SwitchStrobeReturns[switchNum / 8] &= ~switchBit;
+   }
+}
+
+bool RPUHost_GetSwitch(uint8_t switchNum) {
+   if (switchNum >= RPU_HOST_NUM_SWITCH_STROBES * 8) {
+      return false;
+   }
+   return (SwitchStrobeReturns[switchNum / 8] >> (switchNum % 8)) & 0x01;
+}
+
+void RPUHost_SetDipSwitchBank(uint8_t bank, uint8_t value) {
+   if (bank < RPU_HOST_NUM_DIP_BANKS) {
+      DipSwitchBanks[bank] = value;
+   }
+}
+
+bool RPUHost_IsLampLit(uint8_t lampNum) {
+   if (lampNum >= RPU_HOST_NUM_LAMPS) {
+      return false;
+   }
+   return (LampsLit[lampNum / 8] >> (lampNum % 8)) & 0x01;
+}
+
+uint8_t RPUHost_GetLampPassesLit(uint8_t lampNum) {
+   if (lampNum >= RPU_HOST_NUM_LAMPS) {
+      return 0;
+   }
+   uint8_t passesLit = 0;
+   for (uint8_t history = LampHistory[lampNum]; history; history >>= 1) {
+      passesLit += history & 0x01;
+   }
+   return passesLit;
+}
+
+uint8_t RPUHost_GetDisplayDigit(uint8_t displayNum, uint8_t digitNum) {
+   if (displayNum >= RPU_HOST_NUM_DISPLAYS || digitNum >= RPU_HOST_MAX_DIGITS) {
+      return RPU_HOST_DIGIT_BLANK;
+   }
+   return DisplayGlass[displayNum][digitNum];
+}
+
+unsigned long RPUHost_GetSolenoidFireCount(uint8_t solenoidNum) {
+   return (solenoidNum < RPU_HOST_NUM_SOLENOIDS) ? SolenoidFires[solenoidNum] : 0;
+}
+
+uint64_t RPUHost_GetSolenoidLastFireNanos(uint8_t solenoidNum) {
+   return (solenoidNum < RPU_HOST_NUM_SOLENOIDS) ? SolenoidLastFireNanos[solenoidNum] : 0;
+}
+
+unsigned long RPUHost_GetSolenoidCycles(uint8_t solenoidNum) {
+   return (solenoidNum < RPU_HOST_NUM_SOLENOIDS) ? SolenoidCycles[solenoidNum] : 0;
+}
+
+uint8_t RPUHost_GetContinuousSolenoids() {
+   return ContinuousSolenoids;
+}
+
+void RPUHost_PIAPrintState() {
+   printf("PIA     CRA  CRB  ORA  ORB\n");
+   printf("U10    0x%02X 0x%02X 0x%02X 0x%02X\n", U10.side[PIA_SIDE_A].control, U10.side[PIA_SIDE_B].control,
+          U10.side[PIA_SIDE_A].output, U10.side[PIA_SIDE_B].output);
+   printf("U11    0x%02X 0x%02X 0x%02X 0x%02X\n", U11.side[PIA_SIDE_A].control, U11.side[PIA_SIDE_B].control,
+          U11.side[PIA_SIDE_A].output, U11.side[PIA_SIDE_B].output);
+}
+
+#endif
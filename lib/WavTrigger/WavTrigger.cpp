@@ -41,28 +41,16 @@ constexpr uint8_t EOM = 0x55;
 
 // **************************************************************
 void WavTrigger::start(void) {
-   uint8_t txbuf[5];
-
    versionRcvd = false;
    sysinfoRcvd = false;
+   txHead = 0;
+   txCount = 0;
    WTSerial.begin(57600);
    flush();
 
-   // Request version string
-   txbuf[0] = SOM1;
-   txbuf[1] = SOM2;
-   txbuf[2] = 0x05;
-   txbuf[3] = CMD_GET_VERSION;
-   txbuf[4] = EOM;
-   WTSerial.write(txbuf, 5);
-
-   // Request system info
-   txbuf[0] = SOM1;
-   txbuf[1] = SOM2;
-   txbuf[2] = 0x05;
-   txbuf[3] = CMD_GET_SYS_INFO;
-   txbuf[4] = EOM;
-   WTSerial.write(txbuf, 5);
+   // Request version string & system info
+   queueCommand(CMD_GET_VERSION);
+   queueCommand(CMD_GET_SYS_INFO);
 }
 
 // **************************************************************
@@ -75,6 +63,10 @@ void WavTrigger::flush(void) {
    for (i = 0; i < MAX_NUM_VOICES; i++) {
       voiceTable[i] = 0xffff;
    }
+   for (i = 0; i < (int)sizeof(playingTrackFilter); i++) {
+      playingTrackFilter[i] = 0;
+   }
+   voiceGeneration += 1;
    while (WTSerial.available()) {
       WTSerial.read();
    }
@@ -82,6 +74,17 @@ void WavTrigger::flush(void) {
 
 // **************************************************************
 void WavTrigger::update(void) {
+   // Send whatever the serial port has room for
+   while (sendNextCommand(false)) {
+   }
+
+   unsigned long currentTime = millis();
+   if ((currentTime - txSecondStart) >= 1000) {
+      txBytesPerSecond = txBytesThisSecond;
+      txBytesThisSecond = 0;
+      txSecondStart = currentTime;
+   }
+
    if (RPU_OS_HARDWARE_REV <= 3) {
       return;
    }
@@ -131,10 +134,10 @@ void WavTrigger::update(void) {
             if (voice < MAX_NUM_VOICES) {
                if (rxMessage[4] == 0) {
                   if (track == voiceTable[voice]) {
-                     voiceTable[voice] = 0xffff;
+                     setVoiceTrack(voice, 0xffff);
                   }
                } else {
-                  voiceTable[voice] = track;
+                  setVoiceTrack(voice, track);
                }
             }
             break;
@@ -162,18 +165,198 @@ void WavTrigger::update(void) {
 }
 
 // **************************************************************
-bool WavTrigger::isTrackPlaying(int trk) {
-   int i;
-   bool fResult = false;
+void WavTrigger::flushTx(void) {
+   while (sendNextCommand(true)) {
+   }
+}
 
-   update();
-   for (i = 0; i < MAX_NUM_VOICES; i++) {
-      if (voiceTable[i] == ((uint16_t)trk)) {
-         fResult = true;
+// **************************************************************
+void WavTrigger::queueCommand(uint8_t command, uint8_t code, uint16_t track, uint16_t value, uint16_t time, bool lock) {
+   TxCommand txCommand;
+   txCommand.command = command;
+   txCommand.code = code;
+   txCommand.lock = lock;
+   txCommand.track = track;
+   txCommand.value = value;
+   txCommand.time = time;
+
+   if (!mergeCommand(txCommand)) {
+      if (txCount >= TX_QUEUE_SIZE) {
+         // Full, so make room the old (blocking) way
+         txStalls += 1;
+         sendNextCommand(true);
+      }
+      uint8_t txTail = txHead + txCount;
+      if (txTail >= TX_QUEUE_SIZE) {
+         txTail -= TX_QUEUE_SIZE;
+      }
+      txQueue[txTail] = txCommand;
+      txCount += 1;
+      if (txCount > txPeakCount) {
+         txPeakCount = txCount;
+      }
+   }
+
+   // Start sending now if the port isn't backed up
+   while (sendNextCommand(false)) {
+   }
+}
+
+// **************************************************************
+// A gain or fade that's still waiting to be sent gets replaced by a
+// newer one for the same track, as long as nothing else for that track
+// is queued after it.
+bool WavTrigger::mergeCommand(const TxCommand& txCommand) {
+   if (txCommand.command != CMD_TRACK_VOLUME && txCommand.command != CMD_TRACK_FADE && txCommand.command != CMD_MASTER_VOLUME) {
+      return false;
+   }
+
+   for (uint8_t queueCount = txCount; queueCount > 0; queueCount--) {
+      uint8_t slot = txHead + queueCount - 1;
+      if (slot >= TX_QUEUE_SIZE) {
+         slot -= TX_QUEUE_SIZE;
+      }
+      TxCommand& queuedCommand = txQueue[slot];
+      switch (queuedCommand.command) {
+      case CMD_TRACK_VOLUME:
+      case CMD_TRACK_FADE:
+      case CMD_TRACK_CONTROL:
+      case CMD_TRACK_CONTROL_EX:
+         if (txCommand.command == CMD_MASTER_VOLUME || queuedCommand.track != txCommand.track) {
+            continue;
+         }
+         break;
+      case CMD_MASTER_VOLUME:
+         if (txCommand.command != CMD_MASTER_VOLUME) {
+            continue;
+         }
+         break;
+      case CMD_STOP_ALL:
+      case CMD_RESUME_ALL_SYNC:
+         return false;
+      default:
+         continue;
+      }
+
+      // The newest queued command for this track
+      if (queuedCommand.command != txCommand.command) {
+         return false;
+      }
+      queuedCommand = txCommand;
+      return true;
+   }
+   return false;
+}
+
+// **************************************************************
+bool WavTrigger::sendNextCommand(bool wait) {
+   if (txCount == 0) {
+      return false;
+   }
+
+   const TxCommand& txCommand = txQueue[txHead];
+   uint8_t txbuf[12];
+   uint8_t len;
+
+   txbuf[0] = SOM1;
+   txbuf[1] = SOM2;
+   txbuf[3] = txCommand.command;
+   switch (txCommand.command) {
+   case CMD_TRACK_CONTROL:
+   case CMD_TRACK_CONTROL_EX:
+      txbuf[4] = txCommand.code;
+      txbuf[5] = (uint8_t)txCommand.track;
+      txbuf[6] = (uint8_t)(txCommand.track >> 8);
+      len = 7;
+      if (txCommand.command == CMD_TRACK_CONTROL_EX) {
+         txbuf[7] = txCommand.lock;
+         len = 8;
+      }
+      break;
+   case CMD_MASTER_VOLUME:
+   case CMD_SAMPLERATE_OFFSET:
+      txbuf[4] = (uint8_t)txCommand.value;
+      txbuf[5] = (uint8_t)(txCommand.value >> 8);
+      len = 6;
+      break;
+   case CMD_AMP_POWER:
+   case CMD_SET_REPORTING:
+   case CMD_SET_TRIGGER_BANK:
+      txbuf[4] = txCommand.code;
+      len = 5;
+      break;
+   case CMD_TRACK_VOLUME:
+   case CMD_TRACK_FADE:
+      txbuf[4] = (uint8_t)txCommand.track;
+      txbuf[5] = (uint8_t)(txCommand.track >> 8);
+      txbuf[6] = (uint8_t)txCommand.value;
+      txbuf[7] = (uint8_t)(txCommand.value >> 8);
+      len = 8;
+      if (txCommand.command == CMD_TRACK_FADE) {
+         txbuf[8] = (uint8_t)txCommand.time;
+         txbuf[9] = (uint8_t)(txCommand.time >> 8);
+         txbuf[10] = txCommand.code;
+         len = 11;
+      }
+      break;
+   default:
+      len = 4;
+      break;
+   }
+   txbuf[len] = EOM;
+   len += 1;
+   txbuf[2] = len;
+
+   if (!wait && WTSerial.availableForWrite() < len) {
+      return false;
+   }
+   WTSerial.write(txbuf, len);
+   txBytesThisSecond += len;
+
+   txHead += 1;
+   if (txHead >= TX_QUEUE_SIZE) {
+      txHead = 0;
+   }
+   txCount -= 1;
+   return true;
+}
+
+// **************************************************************
+void WavTrigger::setVoiceTrack(uint8_t voice, uint16_t track) {
+   uint16_t oldTrack = voiceTable[voice];
+   if (oldTrack == track) {
+      return;
+   }
+   voiceTable[voice] = track;
+   voiceGeneration += 1;
+
+   if (track != 0xffff) {
+      playingTrackFilter[(track & 0xFF) >> 3] |= (1 << (track & 0x07));
+   }
+   if (oldTrack != 0xffff) {
+      // Only clear the old track's bit if no other voice shares it
+      for (uint8_t i = 0; i < MAX_NUM_VOICES; i++) {
+         if (voiceTable[i] != 0xffff && (voiceTable[i] & 0xFF) == (oldTrack & 0xFF)) {
+            return;
+         }
       }
+      playingTrackFilter[(oldTrack & 0xFF) >> 3] &= ~(1 << (oldTrack & 0x07));
    }
+}
 
-   return fResult;
+// **************************************************************
+bool WavTrigger::isTrackPlaying(int trk) {
+   uint16_t track = (uint16_t)trk;
+   if ((playingTrackFilter[(track & 0xFF) >> 3] & (1 << (track & 0x07))) == 0) {
+      return false;
+   }
+
+   for (uint8_t i = 0; i < MAX_NUM_VOICES; i++) {
+      if (voiceTable[i] == track) {
+         return true;
+      }
+   }
+   return false;
 }
 
 int WavTrigger::getPlayingTrack(int voiceNum) {
@@ -185,44 +368,17 @@ int WavTrigger::getPlayingTrack(int voiceNum) {
 
 // **************************************************************
 void WavTrigger::masterGain(int gain) {
-   uint8_t txbuf[7];
-   uint16_t vol;
-
-   txbuf[0] = SOM1;
-   txbuf[1] = SOM2;
-   txbuf[2] = 0x07;
-   txbuf[3] = CMD_MASTER_VOLUME;
-   vol = (uint16_t)gain;
-   txbuf[4] = (uint8_t)vol;
-   txbuf[5] = (uint8_t)(vol >> 8);
-   txbuf[6] = EOM;
-   WTSerial.write(txbuf, 7);
+   queueCommand(CMD_MASTER_VOLUME, 0, 0, (uint16_t)gain);
 }
 
 // **************************************************************
 void WavTrigger::setAmpPwr(bool enable) {
-   uint8_t txbuf[6];
-
-   txbuf[0] = SOM1;
-   txbuf[1] = SOM2;
-   txbuf[2] = 0x06;
-   txbuf[3] = CMD_AMP_POWER;
-   txbuf[4] = enable;
-   txbuf[5] = EOM;
-   WTSerial.write(txbuf, 6);
+   queueCommand(CMD_AMP_POWER, enable);
 }
 
 // **************************************************************
 void WavTrigger::setReporting(bool enable) {
-   uint8_t txbuf[6];
-
-   txbuf[0] = SOM1;
-   txbuf[1] = SOM2;
-   txbuf[2] = 0x06;
-   txbuf[3] = CMD_SET_REPORTING;
-   txbuf[4] = enable;
-   txbuf[5] = EOM;
-   WTSerial.write(txbuf, 6);
+   queueCommand(CMD_SET_REPORTING, enable);
 }
 
 // **************************************************************
@@ -305,124 +461,41 @@ void WavTrigger::trackLoop(int trk, bool enable) {
 
 // **************************************************************
 void WavTrigger::trackControl(int trk, uint8_t code) {
-   uint8_t txbuf[8];
-
-   txbuf[0] = SOM1;
-   txbuf[1] = SOM2;
-   txbuf[2] = 0x08;
-   txbuf[3] = CMD_TRACK_CONTROL;
-   txbuf[4] = (uint8_t)code;
-   txbuf[5] = (uint8_t)trk;
-   txbuf[6] = (uint8_t)(trk >> 8);
-   txbuf[7] = EOM;
-   WTSerial.write(txbuf, 8);
+   queueCommand(CMD_TRACK_CONTROL, code, (uint16_t)trk);
 }
 
 // **************************************************************
 void WavTrigger::trackControl(int trk, uint8_t code, bool lock) {
-   uint8_t txbuf[9];
-
-   txbuf[0] = SOM1;
-   txbuf[1] = SOM2;
-   txbuf[2] = 0x09;
-   txbuf[3] = CMD_TRACK_CONTROL_EX;
-   txbuf[4] = (uint8_t)code;
-   txbuf[5] = (uint8_t)trk;
-   txbuf[6] = (uint8_t)(trk >> 8);
-   txbuf[7] = lock;
-   txbuf[8] = EOM;
-   WTSerial.write(txbuf, 9);
+   queueCommand(CMD_TRACK_CONTROL_EX, code, (uint16_t)trk, 0, 0, lock);
 }
 
 // **************************************************************
 void WavTrigger::stopAllTracks(void) {
-   uint8_t txbuf[5];
-
-   txbuf[0] = SOM1;
-   txbuf[1] = SOM2;
-   txbuf[2] = 0x05;
-   txbuf[3] = CMD_STOP_ALL;
-   txbuf[4] = EOM;
-   WTSerial.write(txbuf, 5);
+   queueCommand(CMD_STOP_ALL);
 }
 
 // **************************************************************
 void WavTrigger::resumeAllInSync(void) {
-   uint8_t txbuf[5];
-
-   txbuf[0] = SOM1;
-   txbuf[1] = SOM2;
-   txbuf[2] = 0x05;
-   txbuf[3] = CMD_RESUME_ALL_SYNC;
-   txbuf[4] = EOM;
-   WTSerial.write(txbuf, 5);
+   queueCommand(CMD_RESUME_ALL_SYNC);
 }
 
 // **************************************************************
 void WavTrigger::trackGain(int trk, int gain) {
-   uint8_t txbuf[9];
-   uint16_t vol;
-
-   txbuf[0] = SOM1;
-   txbuf[1] = SOM2;
-   txbuf[2] = 0x09;
-   txbuf[3] = CMD_TRACK_VOLUME;
-   txbuf[4] = (uint8_t)trk;
-   txbuf[5] = (uint8_t)(trk >> 8);
-   vol = (uint16_t)gain;
-   txbuf[6] = (uint8_t)vol;
-   txbuf[7] = (uint8_t)(vol >> 8);
-   txbuf[8] = EOM;
-   WTSerial.write(txbuf, 9);
+   queueCommand(CMD_TRACK_VOLUME, 0, (uint16_t)trk, (uint16_t)gain);
 }
 
 // **************************************************************
 void WavTrigger::trackFade(int trk, int gain, int time, bool stopFlag) {
-   uint8_t txbuf[12];
-   uint16_t vol;
-
-   txbuf[0] = SOM1;
-   txbuf[1] = SOM2;
-   txbuf[2] = 0x0c;
-   txbuf[3] = CMD_TRACK_FADE;
-   txbuf[4] = (uint8_t)trk;
-   txbuf[5] = (uint8_t)(trk >> 8);
-   vol = (uint16_t)gain;
-   txbuf[6] = (uint8_t)vol;
-   txbuf[7] = (uint8_t)(vol >> 8);
-   txbuf[8] = (uint8_t)time;
-   txbuf[9] = (uint8_t)(time >> 8);
-   txbuf[10] = stopFlag;
-   txbuf[11] = EOM;
-   WTSerial.write(txbuf, 12);
+   queueCommand(CMD_TRACK_FADE, stopFlag, (uint16_t)trk, (uint16_t)gain, (uint16_t)time);
 }
 
 // **************************************************************
 void WavTrigger::samplerateOffset(int offset) {
-   uint8_t txbuf[7];
-   uint16_t off;
-
-   txbuf[0] = SOM1;
-   txbuf[1] = SOM2;
-   txbuf[2] = 0x07;
-   txbuf[3] = CMD_SAMPLERATE_OFFSET;
-   off = (uint16_t)offset;
-   txbuf[4] = (uint8_t)off;
-   txbuf[5] = (uint8_t)(off >> 8);
-   txbuf[6] = EOM;
-   WTSerial.write(txbuf, 7);
+   queueCommand(CMD_SAMPLERATE_OFFSET, 0, 0, (uint16_t)offset);
 }
 
 // **************************************************************
 void WavTrigger::setTriggerBank(int bank) {
-   uint8_t txbuf[6];
-
-   txbuf[0] = SOM1;
-   txbuf[1] = SOM2;
-   txbuf[2] = 0x06;
-   txbuf[3] = CMD_SET_TRIGGER_BANK;
-   txbuf[4] = (uint8_t)bank;
-   txbuf[5] = EOM;
-   WTSerial.write(txbuf, 6);
+   queueCommand(CMD_SET_TRIGGER_BANK, (uint8_t)bank);
 }
 
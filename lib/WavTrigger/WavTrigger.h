@@ -7,18 +7,28 @@
 
 class WavTrigger {
  public:
-   WavTrigger() {}
+   WavTrigger()
+       : txHead(0), txCount(0), txPeakCount(0), txStalls(0), txBytesThisSecond(0), txBytesPerSecond(0), txSecondStart(0),
+         voiceGeneration(0) {}
    virtual ~WavTrigger() {}
 
    void start(void);
    void update(void);
    void flush(void);
+   void flushTx(void); // Blocks until every queued command has gone to the serial port
    void setReporting(bool enable);
    void setAmpPwr(bool enable);
    bool getVersion(char* pDst, int len);
    int getNumTracks(void);
+   // These only look at the voice table that update() keeps from the
+   // track reports - they don't touch the serial port
    bool isTrackPlaying(int trk);
    int getPlayingTrack(int voiceNum);
+   // Changes whenever a voice starts or stops, so callers can skip
+   // work when it's the same as last time
+   uint8_t getVoiceGeneration() const {
+      return voiceGeneration;
+   }
    void masterGain(int gain);
    void stopAllTracks(void);
    void resumeAllInSync(void);
@@ -41,15 +51,67 @@ class WavTrigger {
       return MAX_NUM_VOICES;
    }
 
+   // Commands are queued and sent from update() as the serial port has
+   // room, so they don't hold up the main loop at 57600 baud.
+   uint8_t getTxQueueDepth() const {
+      return txCount;
+   }
+   uint8_t getTxQueuePeak() const {
+      return txPeakCount;
+   }
+   // Commands that had to be sent the blocking way because the queue was full
+   unsigned long getTxStalls() const {
+      return txStalls;
+   }
+   // Bytes sent in the last full second
+   unsigned int getTxBytesPerSecond() const {
+      return txBytesPerSecond;
+   }
+
  private:
    static constexpr int MAX_MESSAGE_LEN = 32;
    static constexpr int MAX_NUM_VOICES = 14;
    static constexpr int VERSION_STRING_LEN = 21;
+#if (RPU_OS_HARDWARE_REV > 2)
+   static constexpr uint8_t TX_QUEUE_SIZE = 24;
+#else
+   // The Nano (rev 1 & 2) only has 2K of SRAM
+   static constexpr uint8_t TX_QUEUE_SIZE = 12;
+#endif
+
+   // One outbound command, kept unencoded so a later gain or fade for
+   // the same track can be merged into it
+   struct TxCommand {
+      uint8_t command;
+      uint8_t code; // track control code, on/off flag, bank or fade stop flag
+      bool lock;
+      uint16_t track;
+      uint16_t value; // gain or offset
+      uint16_t time;
+   };
 
    void trackControl(int trk, uint8_t code);
    void trackControl(int trk, uint8_t code, bool lock);
+   void queueCommand(uint8_t command, uint8_t code = 0, uint16_t track = 0, uint16_t value = 0, uint16_t time = 0, bool lock = false);
+   bool mergeCommand(const TxCommand& txCommand);
+   bool sendNextCommand(bool wait);
+   void setVoiceTrack(uint8_t voice, uint16_t track);
+
+   TxCommand txQueue[TX_QUEUE_SIZE];
+   uint8_t txHead;
+   uint8_t txCount;
+   uint8_t txPeakCount;
+   unsigned long txStalls;
+   unsigned int txBytesThisSecond;
+   unsigned int txBytesPerSecond;
+   unsigned long txSecondStart;
 
    uint16_t voiceTable[MAX_NUM_VOICES];
+   // One bit per value of a track number's low byte, set if a voice might
+   // be playing a track with that low byte. Tracks go up to 4096, so this
+   // stands in for a full track-to-voice index in 32 bytes.
+   uint8_t playingTrackFilter[32];
+   uint8_t voiceGeneration;
    uint8_t rxMessage[MAX_MESSAGE_LEN];
    char version[VERSION_STRING_LEN];
    uint16_t numTracks;
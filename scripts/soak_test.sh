@@ -0,0 +1,27 @@
+#!/bin/sh
+# Soak test for the switch path: starts a game on the host build and throws
+# field-style switch traffic at it -- spinner bursts on both spinners, a
+# bumper & sling storm and a coin flood, some of them at once -- then prints
+# the key=value report (see lib/RPUHost/RPUHostLoad.cpp) for CI to track.
+#
+# Usage: scripts/soak_test.sh [report file]
+
+set -e
+
+cd "$(dirname "$0")/.."
+pio run -s -e rpu_os_host_soak
+
+# Trident switches: 0-2 coins, 3 & 4 spinners, 5 credit/start,
+# 10-13 slings and 14 & 15 bumpers (with their solenoids)
+TRIGGERED="14/0+15/1+11/2+13/6+10/8+12/9"
+
+.pio/build/rpu_os_host_soak/program --run-ms 60000 --load-seed 2020 \
+   --switch 500:1 --switch 1000:5 \
+   --load spin:4:60:5000:3000 \
+   --load spin:3:80:10000:2500 \
+   --load storm:$TRIGGERED:15:15000:20000 \
+   --load spin:4:100:20000:2000 \
+   --load spin:3:100:20500:2000 \
+   --load steady:0+1+2:20:40000:5000 \
+   --load storm:$TRIGGERED:40:50000:5000 |
+   grep -E '^(load|switch|soak)\.' > "${1:-/dev/stdout}"
@@ -0,0 +1,58 @@
+# PlatformIO post-build script: prints an SRAM budget for the firmware.
+#
+# .data and .bss are fixed at link time; whatever is left over has to hold
+# the stack (and the heap, if anything uses it). The report lists the
+# biggest RAM users so it's obvious what to trim, and warns if the
+# headroom left for the stack drops below custom_sram_headroom (bytes,
+# set per environment in platformio.ini).
+#
+# Add it to an environment with:
+#   extra_scripts = post:scripts/sram_report.py
+#   custom_sram_headroom = 512
+
+import subprocess
+
+Import("env")  # noqa: F821  (provided by PlatformIO/SCons)
+
+NUM_SYMBOLS_TO_LIST = 15
+
+
+def read_ram_symbols(nm_tool, elf_path):
+    # nm -S gives "address size type name"; b/B is .bss, d/D is .data
+    output = subprocess.check_output([nm_tool, "-S", "-C", "--size-sort", elf_path]).decode()
+    symbols = []
+    for line in output.splitlines():
+        fields = line.split(None, 3)
+        if len(fields) < 4 or fields[2] not in ("b", "B", "d", "D"):
+            continue
+        symbols.append((int(fields[1], 16), fields[2].upper(), fields[3]))
+    return symbols
+
+
+def sram_report(source, target, env):
+    elf_path = str(target[0])
+    nm_tool = env.subst("$NM") or "avr-nm"
+    ram_size = int(env.BoardConfig().get("upload.maximum_ram_size", 0))
+    headroom_needed = int(env.GetProjectOption("custom_sram_headroom", "0"))
+
+    symbols = read_ram_symbols(nm_tool, elf_path)
+    data_bytes = sum(size for size, kind, _ in symbols if kind == "D")
+    bss_bytes = sum(size for size, kind, _ in symbols if kind == "B")
+    used_bytes = data_bytes + bss_bytes
+
+    print("SRAM budget for %s" % env["PIOENV"])
+    print("  .data %5d bytes" % data_bytes)
+    print("  .bss  %5d bytes" % bss_bytes)
+    if ram_size:
+        print("  left for the stack %d of %d bytes" % (ram_size - used_bytes, ram_size))
+    print("  biggest RAM users:")
+    for size, kind, name in sorted(symbols, reverse=True)[:NUM_SYMBOLS_TO_LIST]:
+        section = ".data" if kind == "D" else ".bss"
+        print("    %5d %-5s %s" % (size, section, name))
+
+    if ram_size and headroom_needed and (ram_size - used_bytes) < headroom_needed:
+        print("Warning: only %d bytes of SRAM left for the stack (custom_sram_headroom is %d)" %
+              (ram_size - used_bytes, headroom_needed))
+
+
+env.AddPostAction("$BUILD_DIR/${PROGNAME}.elf", sram_report)  # noqa: F821
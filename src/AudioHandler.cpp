@@ -36,6 +36,7 @@
  *    Audio.PlayBackgroundSong(songNum, true); // loop a background song
  *    Audio.PlaySound(soundEffectNum, AUDIO_PLAY_TYPE_WAV_TRIGGER); // play sound effect through wav trigger
  *    Audio.QueueSound(0x02, AUDIO_PLAY_TYPE_ORIGINAL_SOUNDS, CurrentTime); // Queue sound card command for now
+ *    Audio.PlaySoundSequence(ChimeSequence, CurrentTime, numChimes); // play a PROGMEM sequence of sound card commands
  *    Audio.QueueNotification(soundEffectNum, VoiceNotificationDurations[soundEffectNum-SOUND_EFFECT_VP_VOICE_NOTIFICATIONS_START],
  * priority, CurrentTime); // Queue notification
  *
@@ -52,9 +53,10 @@
 constexpr uint16_t VOICE_NOTIFICATION_STACK_EMPTY = 0xFFFF;
 constexpr uint16_t BACKGROUND_TRACK_NONE = 0xFFFF;
 
-const int volumeToGainConversion[11] = {-70, -18, -16, -14, -12, -10, -8, -6, -4, -2, 0};
+const int volumeToGainConversion[11] PROGMEM = {-70, -18, -16, -14, -12, -10, -8, -6, -4, -2, 0};
 
 AudioHandler::AudioHandler() {
+   soundSequence = NULL;
    curSoundtrack = NULL;
    curSoundtrackEntries = 0;
    soundFXGain = 0;
@@ -114,7 +116,7 @@ int AudioHandler::ConvertVolumeSettingToGain(uint8_t volumeSetting) {
    if (volumeSetting > 10) {
       return 0;
    }
-   return volumeToGainConversion[volumeSetting];
+   return (int)pgm_read_word(&volumeToGainConversion[volumeSetting]);
 }
 
 void AudioHandler::SetSoundFXVolume(uint8_t s_volume) {
@@ -449,16 +451,38 @@ void AudioHandler::PlaySB300StartupBeep() {
 
 void AudioHandler::ClearSoundCardQueue() {
 #ifdef RPU_OS_USE_SB300
-   for (int count = 0; count < SOUND_CARD_QUEUE_SIZE; count++) {
-      soundCardQueue[count].playTime = 0;
-   }
+   soundCardQueue.Clear();
+#endif
+}
+
+unsigned long AudioHandler::GetSoundCardQueueDrops() const {
+#if defined(RPU_OS_USE_SB300)
+   return soundCardQueue.GetNumDropped();
+#elif defined(RPU_OS_USE_WTYPE_1_SOUND) || defined(RPU_OS_USE_WTYPE_2_SOUND)
+   return soundEffectQueueDrops;
+#else
+   return 0;
 #endif
 }
 
 void AudioHandler::ClearSoundQueue() {
-   for (int count = 0; count < SOUND_QUEUE_SIZE; count++) {
-      soundQueue[count].playTime = 0;
+   soundQueue.Clear();
+   StopSoundSequence();
+}
+
+bool AudioHandler::PlaySoundSequence(const SoundSequenceStep* sequence, unsigned long startTime, uint8_t repeatCount) {
+   if (sequence == NULL || repeatCount == 0) {
+      return false;
    }
+   soundSequence = sequence;
+   soundSequenceStep = 0;
+   soundSequenceRepeatsLeft = repeatCount;
+   soundSequenceNextTime = startTime;
+   return true;
+}
+
+void AudioHandler::StopSoundSequence() {
+   soundSequence = NULL;
 }
 
 bool AudioHandler::PlaySound(uint16_t soundIndex, uint8_t audioType, uint8_t overrideVolume) {
@@ -529,30 +553,20 @@ bool AudioHandler::FadeSound(uint16_t soundIndex, int fadeGain, int numMilliseco
 }
 
 bool AudioHandler::QueueSound(uint16_t soundIndex, uint8_t audioType, unsigned long timeToPlay, uint8_t overrideVolume) {
-   for (int count = 0; count < SOUND_QUEUE_SIZE; count++) {
-      if (soundQueue[count].playTime == 0) {
-         soundQueue[count].soundIndex = soundIndex;
-         soundQueue[count].audioType = audioType;
-         soundQueue[count].playTime = timeToPlay;
-         soundQueue[count].overrideVolume = overrideVolume;
-         return true;
-      }
-   }
-
-   return false;
+   SoundEntry newEntry;
+   newEntry.soundIndex = soundIndex;
+   newEntry.audioType = audioType;
+   newEntry.overrideVolume = overrideVolume;
+   return soundQueue.Push(newEntry, timeToPlay);
 }
 
 bool AudioHandler::QueueSoundCardCommand(uint8_t scFunction, uint8_t scRegister, uint8_t scData, unsigned long startTime) {
 #ifdef RPU_OS_USE_SB300
-   for (int count = 0; count < SOUND_QUEUE_SIZE; count++) {
-      if (soundCardQueue[count].playTime == 0) {
-         soundCardQueue[count].soundFunction = scFunction;
-         soundCardQueue[count].soundRegister = scRegister;
-         soundCardQueue[count].soundByte = scData;
-         soundCardQueue[count].playTime = startTime;
-         return true;
-      }
-   }
+   SoundCardCommandEntry newEntry;
+   newEntry.soundFunction = scFunction;
+   newEntry.soundRegister = scRegister;
+   newEntry.soundByte = scData;
+   return soundCardQueue.Push(newEntry, startTime);
 #else
    // Phony stuff to get rid of warnings
    unsigned long totalval = scFunction + scRegister + scData + startTime;
@@ -562,7 +576,7 @@ bool AudioHandler::QueueSoundCardCommand(uint8_t scFunction, uint8_t scRegister,
 }
 
 void AudioHandler::InitSoundEffectQueue() {
-#if defined(RPU_WTYPE_1_SOUND)
+#if defined(RPU_OS_USE_WTYPE_1_SOUND) || defined(RPU_OS_USE_WTYPE_2_SOUND)
    CurrentSoundPlaying.soundEffectNum = 0;
    CurrentSoundPlaying.requestedPlayTime = 0;
    CurrentSoundPlaying.playUntil = 0;
@@ -576,6 +590,9 @@ void AudioHandler::InitSoundEffectQueue() {
       SoundEffectQueue[count].priority = 0;
       SoundEffectQueue[count].inUse = false;
    }
+   soundEffectQueueCount = 0;
+   nextSoundEffectTime = 0;
+   soundEffectQueueDrops = 0;
 #endif
 }
 
@@ -589,6 +606,7 @@ bool AudioHandler::PlaySoundCardWhenPossible(uint16_t soundEffectNum, unsigned l
       }
    }
    if (count == SOUND_EFFECT_QUEUE_SIZE) {
+      soundEffectQueueDrops += 1;
       return false;
    }
    SoundEffectQueue[count].soundEffectNum = soundEffectNum;
@@ -596,6 +614,10 @@ bool AudioHandler::PlaySoundCardWhenPossible(uint16_t soundEffectNum, unsigned l
    SoundEffectQueue[count].playUntil = playUntil + requestedPlayTime + currentTime;
    SoundEffectQueue[count].priority = priority;
    SoundEffectQueue[count].inUse = true;
+   if (soundEffectQueueCount == 0 || RPU_TimeHasPassed(nextSoundEffectTime, SoundEffectQueue[count].requestedPlayTime)) {
+      nextSoundEffectTime = SoundEffectQueue[count].requestedPlayTime;
+   }
+   soundEffectQueueCount += 1;
 #else
    // Phony stuff to get rid of warnings
    (void)soundEffectNum;
@@ -610,12 +632,34 @@ bool AudioHandler::PlaySoundCardWhenPossible(uint16_t soundEffectNum, unsigned l
 
 bool AudioHandler::ServiceSoundQueue(unsigned long currentTime) {
    bool soundCommandSent = false;
-   for (int count = 0; count < SOUND_QUEUE_SIZE; count++) {
-      if (soundQueue[count].playTime != 0 && soundQueue[count].playTime < currentTime) {
-         PlaySound(soundQueue[count].soundIndex, soundQueue[count].audioType, soundQueue[count].overrideVolume);
-         soundQueue[count].playTime = 0;
-         soundCommandSent = true;
+   SoundEntry dueEntry;
+   while (soundQueue.PopDue(currentTime, &dueEntry)) {
+      PlaySound(dueEntry.soundIndex, dueEntry.audioType, dueEntry.overrideVolume);
+      soundCommandSent = true;
+   }
+
+   return soundCommandSent;
+}
+
+bool AudioHandler::ServiceSoundSequence(unsigned long currentTime) {
+   bool soundCommandSent = false;
+   while (soundSequence != NULL && RPU_TimeHasPassed(currentTime, soundSequenceNextTime)) {
+      const SoundSequenceStep* step = &soundSequence[soundSequenceStep];
+      uint8_t soundByte = pgm_read_byte(&step->soundByte);
+      if (soundByte == SOUND_SEQUENCE_END) {
+         soundSequenceRepeatsLeft -= 1;
+         if (soundSequenceRepeatsLeft == 0) {
+            soundSequence = NULL;
+         }
+         soundSequenceStep = 0;
+         continue;
       }
+
+      PlaySound(soundByte, AUDIO_PLAY_TYPE_ORIGINAL_SOUNDS);
+      soundCommandSent = true;
+      // Step times are kept relative to the start so they don't drift
+      soundSequenceNextTime += pgm_read_byte(&step->delayAfter);
+      soundSequenceStep += 1;
    }
 
    return soundCommandSent;
@@ -624,22 +668,29 @@ bool AudioHandler::ServiceSoundQueue(unsigned long currentTime) {
 bool AudioHandler::ServiceSoundCardQueue(unsigned long currentTime) {
 #ifdef RPU_OS_USE_SB300
    bool soundCommandSent = false;
-   for (int count = 0; count < SOUND_CARD_QUEUE_SIZE; count++) {
-      if (soundCardQueue[count].playTime != 0 && soundCardQueue[count].playTime < currentTime) {
-         if (soundCardQueue[count].soundFunction == SB300_SOUND_FUNCTION_SQUARE_WAVE) {
-            RPU_PlaySB300SquareWave(soundCardQueue[count].soundRegister, soundCardQueue[count].soundByte);
-         } else if (soundCardQueue[count].soundFunction == SB300_SOUND_FUNCTION_ANALOG) {
-            RPU_PlaySB300Analog(soundCardQueue[count].soundRegister, soundCardQueue[count].soundByte);
-         }
-         soundCardQueue[count].playTime = 0;
-         soundCommandSent = true;
+   SoundCardCommandEntry dueEntry;
+   while (soundCardQueue.PopDue(currentTime, &dueEntry)) {
+      if (dueEntry.soundFunction == SB300_SOUND_FUNCTION_SQUARE_WAVE) {
+         RPU_PlaySB300SquareWave(dueEntry.soundRegister, dueEntry.soundByte);
+      } else if (dueEntry.soundFunction == SB300_SOUND_FUNCTION_ANALOG) {
+         RPU_PlaySB300Analog(dueEntry.soundRegister, dueEntry.soundByte);
       }
+      soundCommandSent = true;
    }
 
    return soundCommandSent;
 #elif defined(RPU_OS_USE_WTYPE_1_SOUND) || defined(RPU_OS_USE_WTYPE_2_SOUND)
+   if (CurrentSoundPlaying.inUse && RPU_TimeHasPassed(currentTime, CurrentSoundPlaying.playUntil)) {
+      CurrentSoundPlaying.inUse = false;
+   }
+
+   if (soundEffectQueueCount == 0 || !RPU_TimeHasPassed(currentTime, nextSoundEffectTime)) {
+      return false;
+   }
+
    uint8_t highestPrioritySound = 0xFF;
    uint8_t queuePriority = 0;
+   uint8_t numWaiting = 0;
 
    for (uint8_t count = 0; count < SOUND_EFFECT_QUEUE_SIZE; count++) {
       // Skip sounds that aren't in use
@@ -648,16 +699,24 @@ bool AudioHandler::ServiceSoundCardQueue(unsigned long currentTime) {
       }
 
       // If a sound has expired, flush it
-      if (currentTime > SoundEffectQueue[count].playUntil) {
+      if (RPU_TimeHasPassed(currentTime, SoundEffectQueue[count].playUntil)) {
          SoundEffectQueue[count].inUse = false;
-      } else if (currentTime > SoundEffectQueue[count].requestedPlayTime) {
+         continue;
+      }
+
+      if (numWaiting == 0 || RPU_TimeHasPassed(nextSoundEffectTime, SoundEffectQueue[count].requestedPlayTime)) {
+         nextSoundEffectTime = SoundEffectQueue[count].requestedPlayTime;
+      }
+      numWaiting += 1;
+
+      if (RPU_TimeHasPassed(currentTime, SoundEffectQueue[count].requestedPlayTime)) {
          // If this sound is ready to be played, figure out its priority
          if (SoundEffectQueue[count].priority > queuePriority) {
             queuePriority = SoundEffectQueue[count].priority;
             highestPrioritySound = count;
          } else if (SoundEffectQueue[count].priority == queuePriority) {
             if (highestPrioritySound != 0xFF) {
-               if (SoundEffectQueue[highestPrioritySound].requestedPlayTime > SoundEffectQueue[count].requestedPlayTime) {
+               if (RPU_TimeHasPassed(SoundEffectQueue[highestPrioritySound].requestedPlayTime, SoundEffectQueue[count].requestedPlayTime)) {
                   // The priorities are equal, but this sound was requested before, so switch to it
                   highestPrioritySound = count;
                }
@@ -666,9 +725,7 @@ bool AudioHandler::ServiceSoundCardQueue(unsigned long currentTime) {
       }
    }
 
-   if (CurrentSoundPlaying.inUse && (currentTime > CurrentSoundPlaying.playUntil)) {
-      CurrentSoundPlaying.inUse = false;
-   }
+   soundEffectQueueCount = numWaiting;
 
    bool soundCommandSent = false;
    if (highestPrioritySound != 0xFF) {
@@ -680,6 +737,7 @@ bool AudioHandler::ServiceSoundCardQueue(unsigned long currentTime) {
          CurrentSoundPlaying.priority = SoundEffectQueue[highestPrioritySound].priority;
          CurrentSoundPlaying.inUse = true;
          SoundEffectQueue[highestPrioritySound].inUse = false;
+         soundEffectQueueCount -= 1;
          RPU_PushToSoundStack(CurrentSoundPlaying.soundEffectNum, 8);
          soundCommandSent = true;
       }
@@ -809,6 +867,7 @@ bool AudioHandler::Update(unsigned long currentTime) {
    bool queueHasEntries = false;
    ManageBackgroundSong(currentTime);
    ServiceSoundQueue(currentTime);
+   ServiceSoundSequence(currentTime);
    ServiceSoundCardQueue(currentTime);
    if (ServiceNotificationQueue(currentTime)) {
       queueHasEntries = true;
@@ -41,7 +41,7 @@ bool SolenoidCycle = true;
 #ifndef RPU_OS_DISABLE_CPC_FOR_SPACE
 bool CPCSelectionsHaveBeenRead = false;
 #define NUM_CPC_PAIRS 9
-const uint8_t CPCPairs[NUM_CPC_PAIRS][2] = {{1, 5}, {1, 4}, {1, 3}, {1, 2}, {1, 1}, {2, 3}, {2, 1}, {3, 1}, {4, 1}};
+const uint8_t CPCPairs[NUM_CPC_PAIRS][2] PROGMEM = {{1, 5}, {1, 4}, {1, 3}, {1, 2}, {1, 1}, {2, 3}, {2, 1}, {3, 1}, {4, 1}};
 uint8_t CPCSelection[3];
 
 uint8_t GetCPCSelection(uint8_t chuteNumber) {
@@ -75,14 +75,14 @@ uint8_t GetCPCCoins(uint8_t cpcSelection) {
    if (cpcSelection >= NUM_CPC_PAIRS) {
       return 1;
    }
-   return CPCPairs[cpcSelection][0];
+   return pgm_read_byte(&CPCPairs[cpcSelection][0]);
 }
 
 uint8_t GetCPCCredits(uint8_t cpcSelection) {
    if (cpcSelection >= NUM_CPC_PAIRS) {
       return 1;
    }
-   return CPCPairs[cpcSelection][1];
+   return pgm_read_byte(&CPCPairs[cpcSelection][1]);
 }
 #endif
 
@@ -485,8 +485,8 @@ int RunBaseSelfTest(int curState, bool curStateChanged, unsigned long CurrentTim
          if (SavedValue > NUM_CPC_PAIRS) {
             SavedValue = 4;
          }
-         RPU_SetDisplay(0, CPCPairs[SavedValue][0], true);
-         RPU_SetDisplay(1, CPCPairs[SavedValue][1], true);
+         RPU_SetDisplay(0, GetCPCCoins(SavedValue), true);
+         RPU_SetDisplay(1, GetCPCCredits(SavedValue), true);
       }
 
       if (curSwitch == resetSwitch) {
@@ -501,8 +501,8 @@ int RunBaseSelfTest(int curState, bool curStateChanged, unsigned long CurrentTim
                SavedValue -= 1;
             }
          }
-         RPU_SetDisplay(0, CPCPairs[SavedValue][0], true);
-         RPU_SetDisplay(1, CPCPairs[SavedValue][1], true);
+         RPU_SetDisplay(0, GetCPCCoins(SavedValue), true);
+         RPU_SetDisplay(1, GetCPCCredits(SavedValue), true);
          if (lastValue != SavedValue) {
             RPU_WriteByteToEEProm(cpcSelectorStartByte, (uint8_t)SavedValue);
             if (cpcSelectorStartByte == RPU_CPC_CHUTE_1_SELECTION_BYTE) {
@@ -23,11 +23,12 @@
 // increase mode start time with new qualifier
 #include "AudioHandler.h"
 #include "RPU.h"
+#include "RPU_GameTimers.h"
+#include "RPU_Scheduler.h"
 #include "RPU_config.h"
 #include "SelfTestAndAudit.h"
 #include "Trident2020.h"
 #include <Arduino.h>
-#include <EEPROM.h>
 #include <stdint.h>
 
 #include "MachineState.h"
@@ -37,6 +38,7 @@
 uint8_t ReadSetting(int setting, uint8_t defaultValue);
 void PlaySoundEffect(uint8_t soundEffectNum);
 void PlayBackgroundSongBasedOnBall(uint8_t ballNum);
+void AddLoopTasks();
 
 constexpr unsigned long TRIDENT2020_MAJOR_VERSION = 2020;  
 constexpr unsigned long TRIDENT2020_MINOR_VERSION = 3;
@@ -71,6 +73,15 @@ constexpr uint8_t GAME_MODE_EXPLORE_THE_DEPTHS_FLAG = 0x40;
 constexpr uint8_t GAME_MODE_WIZARD_WITHOUT_FLAGS = 0x0F;
 constexpr uint8_t GAME_MODE_WIZARD = 0x7F;
 
+// Game timers (only the mode & saucer timers stop for a tilt or ball save)
+constexpr uint8_t TIMER_GAME_MODE = 0;
+constexpr uint8_t TIMER_SAUCER_REDUCTION = 1;
+constexpr uint8_t TIMER_STANDUP_DISPLAY = 2;
+constexpr uint8_t TIMER_ROLLOVER_FLASH = 3;
+constexpr uint8_t TIMER_RESCUE_FROM_THE_DEEP = 4;
+constexpr uint8_t TIMER_BALL_OVER = 5;
+constexpr uint8_t NUM_GAME_TIMERS = 6;
+
 constexpr int EEPROM_BALL_SAVE_BYTE = 100;
 constexpr int EEPROM_FREE_PLAY_BYTE = 101;
 constexpr int EEPROM_SOUND_SELECTOR_BYTE = 102;
@@ -206,17 +217,16 @@ constexpr uint8_t ExploreTheDepthsStart = 1;
 uint8_t GameModeFlagsQualified = 0;
 unsigned long LastSpinnerHitTime = 0;
 unsigned long GameModeStartTime = 0;
-unsigned long GameModeEndTime = 0;
 unsigned long LastTiltWarningTime = 0;
-unsigned long NextSaucerReduction = 0;
 unsigned long SaucerHitTime = 0;
 unsigned long DropTargetClearTime = 0;
-unsigned long StandupDisplayEndTime = 0;
-unsigned long RolloverFlashEndTime = 0;
-unsigned long RescueFromTheDeepEndTime = 0;
 unsigned long LastMiniGameBonusTime = 0;
+RPUGameTimers<NUM_GAME_TIMERS> GameTimers;
 
 void ReadStoredParameters() {
+#if defined(RPU_OS_USE_EEPROM_CACHE)
+   RPU_LoadEEPromCache();
+#endif
    HighScore = RPU_ReadULFromEEProm(RPU_HIGHSCORE_EEPROM_START_BYTE, 10000);
    Credits = RPU_ReadByteFromEEProm(RPU_CREDITS_EEPROM_BYTE);
    if (Credits > MaximumCredits) {
@@ -224,7 +234,7 @@ void ReadStoredParameters() {
    }
 
    ReadSetting(EEPROM_FREE_PLAY_BYTE, 0);
-   FreePlayMode = (EEPROM.read(EEPROM_FREE_PLAY_BYTE)) ? true : false;
+   FreePlayMode = (RPU_ReadByteFromEEProm(EEPROM_FREE_PLAY_BYTE)) ? true : false;
 
    BallSaveNumSeconds = ReadSetting(EEPROM_BALL_SAVE_BYTE, 15);
    if (BallSaveNumSeconds > 20) {
@@ -282,7 +292,7 @@ void ReadStoredParameters() {
       BallsPerGame = ballsOverride;
    } else {
       if (ballsOverride != 99) {
-         EEPROM.write(EEPROM_BALLS_OVERRIDE_BYTE, 99);
+         RPU_WriteByteToEEProm(EEPROM_BALLS_OVERRIDE_BYTE, 99);
       }
    }
 
@@ -316,6 +326,12 @@ void QueueDIAGNotification(unsigned short notificationNum) {
    Audio.QueuePrioritizedNotification(notificationNum, 0, 10, CurrentTime);
 }
 
+#if defined(RPU_OS_RECORD_SWITCHES)
+void WriteSwitchRecording(const uint8_t* data, uint8_t numBytes) {
+   Serial.write(data, numBytes);
+}
+#endif
+
 void setup() {
    #if defined(DEBUG_MESSAGES)
       Serial.begin(115200);
@@ -336,7 +352,7 @@ void setup() {
    Audio.StopAllAudio();
 
    // Tell the OS about game-specific lights and switches
-   RPU_SetupGameSwitches(NUM_SWITCHES_WITH_TRIGGERS, NUM_PRIORITY_SWITCHES_WITH_TRIGGERS, TriggeredSwitches);
+   RPU_SetupGameSwitches(NUM_SWITCHES_WITH_TRIGGERS, NUM_PRIORITY_SWITCHES_WITH_TRIGGERS, TriggeredSwitches, true);
 
    // Set up the chips and interrupts
    unsigned long initResult = 0;
@@ -384,15 +400,19 @@ void setup() {
    CurrentTime = millis();
    Audio.SetMusicDuckingGain(16);
    Audio.QueueWavTriggerSound(SOUND_EFFECT_TRIDENT_INTRO, CurrentTime + 5000);
+
+#if defined(RPU_OS_RECORD_SWITCHES) && (RPU_OS_HARDWARE_REV > 3)
+   // The WAV Trigger is on Serial1, so the recording goes out the USB port
+   // (don't turn on DEBUG_MESSAGES as well)
+   Serial.begin(115200);
+   RPU_StartSwitchRecording(WriteSwitchRecording);
+#endif
+
+   AddLoopTasks();
 }
 
 uint8_t ReadSetting(int setting, uint8_t defaultValue) {
-   uint8_t value = EEPROM.read(setting);
-   if (value == 0xFF) {
-      EEPROM.write(setting, defaultValue);
-      return defaultValue;
-   }
-   return value;
+   return RPU_ReadByteFromEEProm(setting, defaultValue);
 }
 
 ////////////////////////////////////////////////////////////////////////////
@@ -499,32 +519,25 @@ void ShowSaucerLamps() {
          RPU_SetLampState(TOP_EJECT_5K - count, lampPhase, (lampPhase % 2));
       }
    } else {
-      if (NextSaucerReduction == 0) {
+      if (!GameTimers.IsRunning(TIMER_SAUCER_REDUCTION)) {
          RPU_SetLampState(TOP_EJECT_5K, 1);
          for (int count = 1; count < 4; count++) {
             RPU_SetLampState(TOP_EJECT_5K - count, 0);
          }
          SaucerValue = 5;
-      } else if (CurrentTime < NextSaucerReduction) {
+      } else {
          uint8_t saucerLamp = 0;
          if (SaucerValue > 5) {
             saucerLamp = SaucerValue / 10;
          }
+         unsigned long timeToReduction = GameTimers.GetRemaining(TIMER_SAUCER_REDUCTION, CurrentTime);
          for (int count = 0; count < 4; count++) {
             if (count != saucerLamp) {
                RPU_SetLampState(TOP_EJECT_5K - count, 0);
             } else {
-               RPU_SetLampState(TOP_EJECT_5K - count, 1, 0, ((NextSaucerReduction - CurrentTime) / 2000) * 100 + 200);
+               RPU_SetLampState(TOP_EJECT_5K - count, 1, 0, (timeToReduction / 2000) * 100 + 200);
             }
          }
-      } else {
-         if (SaucerValue > 10) {
-            SaucerValue -= 10;
-            NextSaucerReduction = CurrentTime + 10000;
-         } else if (SaucerValue == 10) {
-            SaucerValue = 5;
-            NextSaucerReduction = 0;
-         }
       }
    }
 }
@@ -611,7 +624,7 @@ void ShowStandupTargetLamps() {
       RPU_SetLampState(STAND_UP_AMBER, (lampPhase == 3), 1);
       RPU_SetLampState(STAND_UP_GREEN, (lampPhase == 3), 1);
       RPU_SetLampState(STAND_UP_WHITE, (lampPhase == 3), 1);
-   } else if (!(GameMode & GAME_MODE_EXPLORE_THE_DEPTHS_FLAG) && StandupDisplayEndTime != 0 && CurrentTime < StandupDisplayEndTime) {
+   } else if (!(GameMode & GAME_MODE_EXPLORE_THE_DEPTHS_FLAG) && GameTimers.IsRunning(TIMER_STANDUP_DISPLAY)) {
       RPU_SetLampState(STAND_UP_PURPLE, CurrentStandupsHit & STANDUP_PURPLE_MASK, (LastStandupTargetHit & STANDUP_PURPLE_MASK) ? 0 : 1,
                        (LastStandupTargetHit & STANDUP_PURPLE_MASK) ? 50 : 0);
       RPU_SetLampState(STAND_UP_YELLOW, CurrentStandupsHit & STANDUP_YELLOW_MASK, (LastStandupTargetHit & STANDUP_YELLOW_MASK) ? 0 : 1,
@@ -686,7 +699,7 @@ void ShowLeftSpinnerLamps() {
          RPU_SetLampState(LEFT_SPINNER_PURPLE, lampPhase == 0);
       } else {
          int flashFrequency = 200;
-         if ((StandupDisplayEndTime - CurrentTime) < 1000) {
+         if (GameTimers.IsRunning(TIMER_STANDUP_DISPLAY) && GameTimers.GetRemaining(TIMER_STANDUP_DISPLAY, CurrentTime) < 1000) {
             flashFrequency = 100;
          }
          RPU_SetLampState(LEFT_SPINNER_AMBER, CurrentStandupsHit & STANDUP_AMBER_MASK, 0,
@@ -718,7 +731,7 @@ void ShowRightSpinnerLamps() {
          RPU_SetLampState(RIGHT_SPINNER_PURPLE, lampPhase == 0);
       } else {
          int flashFrequency = 200;
-         if ((StandupDisplayEndTime - CurrentTime) < 1000) {
+         if (GameTimers.IsRunning(TIMER_STANDUP_DISPLAY) && GameTimers.GetRemaining(TIMER_STANDUP_DISPLAY, CurrentTime) < 1000) {
             flashFrequency = 100;
          }
          RPU_SetLampState(RIGHT_SPINNER_YELLOW, CurrentStandupsHit & STANDUP_YELLOW_MASK, 0,
@@ -740,7 +753,7 @@ void ShowLeftLaneLamps() {
       valueToShow = 8;
       valueFlash = 500;
    } else {
-      if (RolloverFlashEndTime != 0 && CurrentTime < RolloverFlashEndTime) {
+      if (GameTimers.IsRunning(TIMER_ROLLOVER_FLASH)) {
          valueFlash = 100;
       }
    }
@@ -752,8 +765,8 @@ void ShowLeftLaneLamps() {
 }
 
 void ShowAwardLamps() {
-   RPU_SetLampState(EXTRA_BALL, ((NumberOfStandupClears == 1 && !ExtraBallCollected) || RescueFromTheDeepEndTime != 0), 0,
-                    (RescueFromTheDeepEndTime) ? 100 : 0);
+   bool rescueLit = GameTimers.IsRunning(TIMER_RESCUE_FROM_THE_DEEP);
+   RPU_SetLampState(EXTRA_BALL, ((NumberOfStandupClears == 1 && !ExtraBallCollected) || rescueLit), 0, rescueLit ? 100 : 0);
    RPU_SetLampState(DROP_TARGET_SPECIAL, (BonusX == (TargetSpecialBonus - 1)) && !(GameMode & GAME_MODE_SHARP_SHOOTER_FLAG));
    RPU_SetLampState(STAND_UP_SPECIAL,
                     (NumberOfStandupClears == (StandupSpecialLevel - 1)) && !(GameMode & GAME_MODE_EXPLORE_THE_DEPTHS_FLAG));
@@ -776,24 +789,8 @@ void ShowShootAgainLamp() {
 //
 ////////////////////////////////////////////////////////////////////////////
 unsigned long LastTimeScoreChanged = 0;
-unsigned long LastTimeOverrideAnimated = 0;
-unsigned long LastFlashOrDash = 0;
 unsigned long ScoreOverrideValue[4] = {0, 0, 0, 0};
 uint8_t ScoreOverrideStatus = 0;
-uint8_t LastScrollPhase = 0;
-
-uint8_t MagnitudeOfScore(unsigned long score) {
-   if (score == 0) {
-      return 0;
-   }
-
-   uint8_t retval = 0;
-   while (score > 0) {
-      score = score / 10;
-      retval += 1;
-   }
-   return retval;
-}
 
 void OverrideScoreDisplay(uint8_t displayNum, unsigned long value, bool animate) {
    if (displayNum > 3) {
@@ -808,62 +805,21 @@ void OverrideScoreDisplay(uint8_t displayNum, unsigned long value, bool animate)
    ScoreOverrideValue[displayNum] = value;
 }
 
-uint8_t GetDisplayMask(uint8_t numDigits) {
-   uint8_t displayMask = 0;
-   for (uint8_t digitCount = 0; digitCount < numDigits; digitCount++) {
-      displayMask |= (0x20 >> digitCount);
-   }
-   return displayMask;
-}
-
+// The RPU display effects do the flashing, dashing, scrolling & animating,
+// so this only has to say what each display should show
 void ShowPlayerScores(uint8_t displayToUpdate, bool flashCurrent, bool dashCurrent, unsigned long allScoresShowValue = 0) {
    if (displayToUpdate == 0xFF) {
       ScoreOverrideStatus = 0;
    }
 
-   uint8_t displayMask = 0x3F;
    unsigned long displayScore = 0;
-   unsigned long overrideAnimationSeed = CurrentTime / 250;
-   uint8_t scrollPhaseChanged = false;
-
-   uint8_t scrollPhase = ((CurrentTime - LastTimeScoreChanged) / 250) % 16;
-   if (scrollPhase != LastScrollPhase) {
-      LastScrollPhase = scrollPhase;
-      scrollPhaseChanged = true;
-   }
-
-   bool updateLastTimeAnimated = false;
 
    for (uint8_t scoreCount = 0; scoreCount < 4; scoreCount++) {
       // If this display is currently being overriden, then we should update it
       if (allScoresShowValue == 0 && (ScoreOverrideStatus & (0x10 << scoreCount))) {
-         displayScore = ScoreOverrideValue[scoreCount];
-         uint8_t numDigits = MagnitudeOfScore(displayScore);
-         if (numDigits == 0) {
-            numDigits = 1;
-         }
-         if (numDigits < (RPU_OS_NUM_DIGITS - 1) && (ScoreOverrideStatus & (0x01 << scoreCount))) {
-            if (overrideAnimationSeed != LastTimeOverrideAnimated) {
-               updateLastTimeAnimated = true;
-               uint8_t shiftDigits =
-                   (overrideAnimationSeed) % (((RPU_OS_NUM_DIGITS + 1) - numDigits) + ((RPU_OS_NUM_DIGITS - 1) - numDigits));
-               if (shiftDigits >= ((RPU_OS_NUM_DIGITS + 1) - numDigits)) {
-                  shiftDigits = (RPU_OS_NUM_DIGITS - numDigits) * 2 - shiftDigits;
-               }
-               uint8_t digitCount;
-               displayMask = GetDisplayMask(numDigits);
-               for (digitCount = 0; digitCount < shiftDigits; digitCount++) {
-                  displayScore *= 10;
-                  displayMask = displayMask >> 1;
-               }
-               RPU_SetDisplayBlank(scoreCount, 0x00);
-               RPU_SetDisplay(scoreCount, displayScore, false);
-               RPU_SetDisplayBlank(scoreCount, displayMask);
-            }
-         } else {
-            RPU_SetDisplay(scoreCount, displayScore, true);
-         }
-
+         RPU_SetDisplayEffect(scoreCount,
+                              (ScoreOverrideStatus & (0x01 << scoreCount)) ? RPU_DISPLAY_EFFECT_BOUNCE : RPU_DISPLAY_EFFECT_STATIC,
+                              ScoreOverrideValue[scoreCount]);
       } else {
          // No override, update scores designated by displayToUpdate
          if (allScoresShowValue == 0) {
@@ -876,91 +832,23 @@ void ShowPlayerScores(uint8_t displayToUpdate, bool flashCurrent, bool dashCurre
          if (displayToUpdate == 0xFF || displayToUpdate == scoreCount || displayScore > RPU_OS_MAX_DISPLAY_SCORE) {
             // Don't show this score if it's not a current player score (even if it's scrollable)
             if (displayToUpdate == 0xFF && (scoreCount >= CurrentNumPlayers && CurrentNumPlayers != 0) && allScoresShowValue == 0) {
-               RPU_SetDisplayBlank(scoreCount, 0x00);
+               RPU_SetDisplayEffect(scoreCount, RPU_DISPLAY_EFFECT_OFF);
                continue;
             }
 
             if (displayScore > RPU_OS_MAX_DISPLAY_SCORE) {
                // Score needs to be scrolled
-               if ((CurrentTime - LastTimeScoreChanged) < 4000) {
-                  RPU_SetDisplay(scoreCount, displayScore % (RPU_OS_MAX_DISPLAY_SCORE + 1), false);
-                  RPU_SetDisplayBlank(scoreCount, RPU_OS_ALL_DIGITS_MASK);
-               } else {
-                  // Scores are scrolled 10 digits and then we wait for 6
-                  if (scrollPhase < 11 && scrollPhaseChanged) {
-                     uint8_t numDigits = MagnitudeOfScore(displayScore);
-
-                     // Figure out top part of score
-                     unsigned long tempScore = displayScore;
-                     if (scrollPhase < RPU_OS_NUM_DIGITS) {
-                        displayMask = RPU_OS_ALL_DIGITS_MASK;
-                        for (uint8_t scrollCount = 0; scrollCount < scrollPhase; scrollCount++) {
-                           displayScore = (displayScore % (RPU_OS_MAX_DISPLAY_SCORE + 1)) * 10;
-                           displayMask = displayMask >> 1;
-                        }
-                     } else {
-                        displayScore = 0;
-                        displayMask = 0x00;
-                     }
-
-                     // Add in lower part of score
-                     if ((numDigits + scrollPhase) > 10) {
-                        uint8_t numDigitsNeeded = (numDigits + scrollPhase) - 10;
-                        for (uint8_t scrollCount = 0; scrollCount < (numDigits - numDigitsNeeded); scrollCount++) {
-                           tempScore /= 10;
-                        }
-                        displayMask |= GetDisplayMask(MagnitudeOfScore(tempScore));
-                        displayScore += tempScore;
-                     }
-                     RPU_SetDisplayBlank(scoreCount, displayMask);
-                     RPU_SetDisplay(scoreCount, displayScore);
-                  }
-               }
+               RPU_SetDisplayEffect(scoreCount, RPU_DISPLAY_EFFECT_SCROLL, displayScore, LastTimeScoreChanged);
+            } else if (flashCurrent) {
+               RPU_SetDisplayEffect(scoreCount, RPU_DISPLAY_EFFECT_FLASH, displayScore);
+            } else if (dashCurrent) {
+               RPU_SetDisplayEffect(scoreCount, RPU_DISPLAY_EFFECT_DASH, displayScore, 0, 60);
             } else {
-               if (flashCurrent) {
-                  unsigned long flashSeed = CurrentTime / 250;
-                  if (flashSeed != LastFlashOrDash) {
-                     LastFlashOrDash = flashSeed;
-                     if (((CurrentTime / 250) % 2) == 0) {
-                        RPU_SetDisplayBlank(scoreCount, 0x00);
-                     } else {
-                        RPU_SetDisplay(scoreCount, displayScore, true, 2);
-                     }
-                  }
-               } else if (dashCurrent) {
-                  unsigned long dashSeed = CurrentTime / 50;
-                  if (dashSeed != LastFlashOrDash) {
-                     LastFlashOrDash = dashSeed;
-                     uint8_t dashPhase = (CurrentTime / 60) % 36;
-                     uint8_t numDigits = MagnitudeOfScore(displayScore);
-                     if (dashPhase < 12) {
-                        displayMask = GetDisplayMask((numDigits == 0) ? 2 : numDigits);
-                        if (dashPhase < 7) {
-                           for (uint8_t maskCount = 0; maskCount < dashPhase; maskCount++) {
-                              displayMask &= ~(0x01 << maskCount);
-                           }
-                        } else {
-                           for (uint8_t maskCount = 12; maskCount > dashPhase; maskCount--) {
-                              displayMask &= ~(0x20 >> (maskCount - dashPhase - 1));
-                           }
-                        }
-                        RPU_SetDisplay(scoreCount, displayScore);
-                        RPU_SetDisplayBlank(scoreCount, displayMask);
-                     } else {
-                        RPU_SetDisplay(scoreCount, displayScore, true, 2);
-                     }
-                  }
-               } else {
-                  RPU_SetDisplay(scoreCount, displayScore, true, 2);
-               }
+               RPU_SetDisplayEffect(scoreCount, RPU_DISPLAY_EFFECT_STATIC, displayScore);
             }
          } // End if this display should be updated
       } // End on non-overridden
    } // End loop on scores
-
-   if (updateLastTimeAnimated) {
-      LastTimeOverrideAnimated = overrideAnimationSeed;
-   }
 }
 
 ////////////////////////////////////////////////////////////////////////////
@@ -968,6 +856,14 @@ void ShowPlayerScores(uint8_t displayToUpdate, bool flashCurrent, bool dashCurre
 //  Machine State Helper functions
 //
 ////////////////////////////////////////////////////////////////////////////
+// EEPROM writes go out behind the cache a byte at a time (RPU_Update),
+// so this is only for the points where it's safe to wait for the rest
+void CommitEEPromWrites() {
+#if defined(RPU_OS_USE_EEPROM_CACHE)
+   RPU_FlushEEPromCache();
+#endif
+}
+
 bool AddPlayer(bool resetNumPlayers = false) {
    if (Credits < 1 && !FreePlayMode) {
       return false;
@@ -997,12 +893,12 @@ bool AddPlayer(bool resetNumPlayers = false) {
    return true;
 }
 
-unsigned short ChuteAuditByte[] = {RPU_CHUTE_1_COINS_START_BYTE, RPU_CHUTE_2_COINS_START_BYTE, RPU_CHUTE_3_COINS_START_BYTE};
+const unsigned short ChuteAuditByte[] PROGMEM = {RPU_CHUTE_1_COINS_START_BYTE, RPU_CHUTE_2_COINS_START_BYTE, RPU_CHUTE_3_COINS_START_BYTE};
 void AddCoinToAudit(uint8_t chuteNum) {
    if (chuteNum > 2) {
       return;
    }
-   unsigned short coinAuditStartByte = ChuteAuditByte[chuteNum];
+   unsigned short coinAuditStartByte = pgm_read_word(&ChuteAuditByte[chuteNum]);
    RPU_WriteULToEEProm(coinAuditStartByte, RPU_ReadULFromEEProm(coinAuditStartByte) + 1);
 }
 
@@ -1301,7 +1197,7 @@ int RunSelfTest(int curState, bool curStateChanged) {
             }
             *CurrentAdjustmentByte = curVal;
             if (CurrentAdjustmentStorageByte) {
-               EEPROM.write(CurrentAdjustmentStorageByte, curVal);
+               RPU_WriteByteToEEProm(CurrentAdjustmentStorageByte, curVal);
             }
          } else if (CurrentAdjustmentByte && AdjustmentType == ADJ_TYPE_LIST) {
             uint8_t valCount = 0;
@@ -1314,7 +1210,7 @@ int RunSelfTest(int curState, bool curStateChanged) {
             }
             *CurrentAdjustmentByte = AdjustmentValues[newIndex];
             if (CurrentAdjustmentStorageByte) {
-               EEPROM.write(CurrentAdjustmentStorageByte, AdjustmentValues[newIndex]);
+               RPU_WriteByteToEEProm(CurrentAdjustmentStorageByte, AdjustmentValues[newIndex]);
             }
          } else if (CurrentAdjustmentUL && (AdjustmentType == ADJ_TYPE_SCORE_WITH_DEFAULT || AdjustmentType == ADJ_TYPE_SCORE_NO_DEFAULT)) {
             unsigned long curVal = *CurrentAdjustmentUL;
@@ -1377,6 +1273,23 @@ void PlayBackgroundSong(unsigned short songNum) {
    }
 }
 
+// Original sounds - each tone is held for 75ms and then silenced, and
+// repeated tones come every 200ms
+const SoundSequenceStep SequenceTone01[] PROGMEM = {{0x01, 75}, {0x00, 125}, {SOUND_SEQUENCE_END, 0}};
+const SoundSequenceStep SequenceTone02[] PROGMEM = {{0x02, 75}, {0x00, 125}, {SOUND_SEQUENCE_END, 0}};
+const SoundSequenceStep SequenceTone04[] PROGMEM = {{0x04, 75}, {0x00, 125}, {SOUND_SEQUENCE_END, 0}};
+const SoundSequenceStep SequenceTone08[] PROGMEM = {{0x08, 75}, {0x00, 125}, {SOUND_SEQUENCE_END, 0}};
+const SoundSequenceStep SequenceTone10[] PROGMEM = {{0x10, 75}, {0x00, 125}, {SOUND_SEQUENCE_END, 0}};
+const SoundSequenceStep SequenceTone20[] PROGMEM = {{0x20, 75}, {0x00, 125}, {SOUND_SEQUENCE_END, 0}};
+const SoundSequenceStep SequenceRightInlane[] PROGMEM = {{0x04, 75}, {0x00, 125}, {0x04, 75}, {0x00, 125}, {0x04, 75}, {0x00, 125},
+                                                         {0x10, 75}, {0x00, 125}, {0x10, 75}, {0x00, 125}, {0x10, 75}, {0x00, 125},
+                                                         {SOUND_SEQUENCE_END, 0}};
+const SoundSequenceStep SequencePlayerUp[] PROGMEM = {{0x08, 75}, {0x04, 100}, {0x00, 0}, {SOUND_SEQUENCE_END, 0}};
+const SoundSequenceStep SequenceScaleDown[] PROGMEM = {{0x08, 75}, {0x04, 75}, {0x02, 75}, {0x01, 100}, {0x08, 75}, {0x04, 75},
+                                                       {0x02, 75}, {0x01, 100}, {0x00, 0},  {SOUND_SEQUENCE_END, 0}};
+const SoundSequenceStep SequenceScaleUp[] PROGMEM = {{0x01, 75}, {0x02, 75}, {0x04, 75}, {0x08, 100}, {0x01, 75}, {0x02, 75},
+                                                     {0x04, 75}, {0x08, 100}, {0x00, 0},  {SOUND_SEQUENCE_END, 0}};
+
 unsigned long NextSoundEffectTime = 0;
 
 void PlaySoundEffect(uint8_t soundEffectNum) {
@@ -1394,58 +1307,36 @@ void PlaySoundEffect(uint8_t soundEffectNum) {
       case SOUND_EFFECT_RIGHT_SPINNER:
       case SOUND_EFFECT_DROP_TARGET:
       case SOUND_EFFECT_BALL_OVER:
-         Audio.QueueOriginalSound(0x02, CurrentTime);
-         Audio.QueueOriginalSound(0x00, CurrentTime + 75);
+         Audio.PlaySoundSequence(SequenceTone02, CurrentTime);
          break;
       case SOUND_EFFECT_LEFT_INLANE:
-         for (int count = 0; count < RolloverValue; count++) {
-            Audio.QueueOriginalSound(0x04, CurrentTime + 200 * count);
-            Audio.QueueOriginalSound(0x00, CurrentTime + 75 + (200 * count));
-         }
+         Audio.PlaySoundSequence(SequenceTone04, CurrentTime, RolloverValue);
          break;
       case SOUND_EFFECT_RIGHT_INLANE:
-         for (int count = 0; count < 6; count++) {
-            Audio.QueueOriginalSound((count < 3) ? 0x04 : 0x10, CurrentTime + 200 * count);
-            Audio.QueueOriginalSound(0x00, CurrentTime + 75 + (200 * count));
-         }
+         Audio.PlaySoundSequence(SequenceRightInlane, CurrentTime);
          break;
       case SOUND_EFFECT_SAUCER_HIT_5K:
-         for (int count = 0; count < 5; count++) {
-            Audio.QueueOriginalSound(0x04, CurrentTime + 200 * count);
-            Audio.QueueOriginalSound(0x00, CurrentTime + 75 + (200 * count));
-         }
+      case SOUND_EFFECT_RIGHT_OUTLANE:
+         Audio.PlaySoundSequence(SequenceTone04, CurrentTime, 5);
          break;
       case SOUND_EFFECT_SAUCER_HIT_30K:
-         for (int count = 0; count < 3; count++) {
-            Audio.QueueOriginalSound(0x08, CurrentTime + 200 * count);
-            Audio.QueueOriginalSound(0x00, CurrentTime + 75 + (200 * count));
-         }
+         Audio.PlaySoundSequence(SequenceTone08, CurrentTime, 3);
          break;
-
       case SOUND_EFFECT_SAUCER_HIT_20K:
-         for (int count = 0; count < 2; count++) {
-            Audio.QueueOriginalSound(0x08, CurrentTime + 200 * count);
-            Audio.QueueOriginalSound(0x00, CurrentTime + 75 + (200 * count));
-         }
+         Audio.PlaySoundSequence(SequenceTone08, CurrentTime, 2);
          break;
-
       case SOUND_EFFECT_SAUCER_HIT_10K:
-         for (int count = 0; count < 1; count++) {
-            Audio.QueueOriginalSound(0x08, CurrentTime + 200 * count);
-            Audio.QueueOriginalSound(0x00, CurrentTime + 75 + (200 * count));
-         }
-         break;
-      case SOUND_EFFECT_RIGHT_OUTLANE:
-         for (int count = 0; count < 5; count++) {
-            Audio.QueueOriginalSound(0x04, CurrentTime + 200 * count);
-            Audio.QueueOriginalSound(0x00, CurrentTime + 75 + (200 * count));
-         }
+      case SOUND_EFFECT_DROP_TARGET_CLEAR_1:
+      case SOUND_EFFECT_DROP_TARGET_CLEAR_2:
+      case SOUND_EFFECT_DROP_TARGET_CLEAR_3:
+      case SOUND_EFFECT_DROP_TARGET_CLEAR_4:
+      case SOUND_EFFECT_DROP_TARGET_CLEAR_5:
+         Audio.PlaySoundSequence(SequenceTone08, CurrentTime);
          break;
 
       case SOUND_EFFECT_TOP_BUMPER_HIT:
       case SOUND_EFFECT_BOTTOM_BUMPER_HIT:
-         Audio.QueueOriginalSound(0x20, CurrentTime);
-         Audio.QueueOriginalSound(0x00, CurrentTime + 75);
+         Audio.PlaySoundSequence(SequenceTone20, CurrentTime);
          break;
 
       case SOUND_EFFECT_SHOOT_AGAIN:
@@ -1453,9 +1344,7 @@ void PlaySoundEffect(uint8_t soundEffectNum) {
       case SOUND_EFFECT_PLAYER_2_UP:
       case SOUND_EFFECT_PLAYER_3_UP:
       case SOUND_EFFECT_PLAYER_4_UP:
-         Audio.QueueOriginalSound(0x08, CurrentTime);
-         Audio.QueueOriginalSound(0x04, CurrentTime + 75);
-         Audio.QueueOriginalSound(0x00, CurrentTime + 175);
+         Audio.PlaySoundSequence(SequencePlayerUp, CurrentTime);
          break;
 
       case SOUND_EFFECT_BONUS_COUNT:
@@ -1463,52 +1352,28 @@ void PlaySoundEffect(uint8_t soundEffectNum) {
       case SOUND_EFFECT_3X_BONUS_COUNT:
       case SOUND_EFFECT_4X_BONUS_COUNT:
       case SOUND_EFFECT_5X_BONUS_COUNT:
-         Audio.QueueOriginalSound(0x04, CurrentTime);
-         Audio.QueueOriginalSound(0x00, CurrentTime + 75);
+      case SOUND_EFFECT_FIRST_SU_SWITCH_HIT:
+      case SOUND_EFFECT_SECOND_SU_SWITCH_HIT:
+      case SOUND_EFFECT_THIRD_SU_SWITCH_HIT:
+      case SOUND_EFFECT_FOURTH_SU_SWITCH_HIT:
+      case SOUND_EFFECT_FIFTH_SU_SWITCH_HIT:
+         Audio.PlaySoundSequence(SequenceTone04, CurrentTime);
          break;
 
       case SOUND_EFFECT_UPPER_SLING:
       case SOUND_EFFECT_EXTRA_BALL:
       case SOUND_EFFECT_TILT_WARNING:
-         Audio.QueueOriginalSound(0x10, CurrentTime);
-         Audio.QueueOriginalSound(0x00, CurrentTime + 75);
+         Audio.PlaySoundSequence(SequenceTone10, CurrentTime);
          break;
       case SOUND_EFFECT_10PT_SWITCH:
       case SOUND_EFFECT_MATCH_SPIN:
       case SOUND_EFFECT_LOWER_SLING:
-         Audio.QueueOriginalSound(0x01, CurrentTime);
-         Audio.QueueOriginalSound(0x00, CurrentTime + 75);
-         break;
-
-      case SOUND_EFFECT_DROP_TARGET_CLEAR_1:
-      case SOUND_EFFECT_DROP_TARGET_CLEAR_2:
-      case SOUND_EFFECT_DROP_TARGET_CLEAR_3:
-      case SOUND_EFFECT_DROP_TARGET_CLEAR_4:
-      case SOUND_EFFECT_DROP_TARGET_CLEAR_5:
-         Audio.QueueOriginalSound(0x08, CurrentTime);
-         Audio.QueueOriginalSound(0x00, CurrentTime + 75);
-         break;
-
-      case SOUND_EFFECT_FIRST_SU_SWITCH_HIT:
-      case SOUND_EFFECT_SECOND_SU_SWITCH_HIT:
-      case SOUND_EFFECT_THIRD_SU_SWITCH_HIT:
-      case SOUND_EFFECT_FOURTH_SU_SWITCH_HIT:
-      case SOUND_EFFECT_FIFTH_SU_SWITCH_HIT:
-         Audio.QueueOriginalSound(0x04, CurrentTime);
-         Audio.QueueOriginalSound(0x00, CurrentTime + 75);
+         Audio.PlaySoundSequence(SequenceTone01, CurrentTime);
          break;
 
       case SOUND_EFFECT_ADD_CREDIT:
       case SOUND_EFFECT_GAME_OVER:
-         Audio.QueueOriginalSound(0x08, CurrentTime);
-         Audio.QueueOriginalSound(0x04, CurrentTime + 75);
-         Audio.QueueOriginalSound(0x02, CurrentTime + 150);
-         Audio.QueueOriginalSound(0x01, CurrentTime + 225);
-         Audio.QueueOriginalSound(0x08, CurrentTime + 325);
-         Audio.QueueOriginalSound(0x04, CurrentTime + 400);
-         Audio.QueueOriginalSound(0x02, CurrentTime + 475);
-         Audio.QueueOriginalSound(0x01, CurrentTime + 550);
-         Audio.QueueOriginalSound(0x00, CurrentTime + 650);
+         Audio.PlaySoundSequence(SequenceScaleDown, CurrentTime);
          break;
 
       case SOUND_EFFECT_ADD_PLAYER_1:
@@ -1517,15 +1382,7 @@ void PlaySoundEffect(uint8_t soundEffectNum) {
       case SOUND_EFFECT_ADD_PLAYER_4:
       case SOUND_EFFECT_RESCUE_FROM_THE_DEEP:
       case SOUND_EFFECT_TRIDENT_INTRO:
-         Audio.QueueOriginalSound(0x01, CurrentTime);
-         Audio.QueueOriginalSound(0x02, CurrentTime + 75);
-         Audio.QueueOriginalSound(0x04, CurrentTime + 150);
-         Audio.QueueOriginalSound(0x08, CurrentTime + 225);
-         Audio.QueueOriginalSound(0x01, CurrentTime + 325);
-         Audio.QueueOriginalSound(0x02, CurrentTime + 400);
-         Audio.QueueOriginalSound(0x04, CurrentTime + 475);
-         Audio.QueueOriginalSound(0x08, CurrentTime + 550);
-         Audio.QueueOriginalSound(0x00, CurrentTime + 650);
+         Audio.PlaySoundSequence(SequenceScaleUp, CurrentTime);
          break;
       }
       break;
@@ -1666,6 +1523,59 @@ uint8_t CountBits(uint8_t byteToBeCounted) {
    return numBits;
 }
 
+// Ends whichever timed mode is running. Mode timers are cancelled when the
+// mode changes some other way, so this only sees the mode it was started for.
+void GameModeTimerExpired(uint8_t timerId, unsigned long curTime) {
+   (void)timerId;
+   (void)curTime;
+   switch ((GameMode & 0x0F)) {
+   case GAME_MODE_MINI_GAME_QUALIFIED:
+      GameModeStartTime = 0;
+      GameModeFlagsQualified = 0;
+      GameMode = GAME_MODE_UNSTRUCTURED_PLAY;
+      break;
+   case GAME_MODE_MINI_GAME_ENGAGED:
+      GameModeStartTime = 0;
+      LastMiniGameBonusTime = 0;
+      ShowPlayerScores(0xFF, false, false);
+      PlayBackgroundSong(SOUND_EFFECT_NONE);
+      GameMode = GAME_MODE_MINI_GAME_REWARD_COUNTDOWN;
+      break;
+   case GAME_MODE_WIZARD_WITHOUT_FLAGS:
+      FeedingFrenzySpins[CurrentPlayer] = 0;
+      SharpShooterHits[CurrentPlayer] = 0;
+      ExploreTheDepthsHits[CurrentPlayer] = 0;
+      JackpotLit = false;
+      GameModeStartTime = 0;
+      LastMiniGameBonusTime = 0;
+      ShowPlayerScores(0xFF, false, false);
+      PlayBackgroundSongBasedOnBall(CurrentBallInPlay);
+      PlaySoundEffect(SOUND_EFFECT_MODE_FINISHED);
+      GameMode = GAME_MODE_UNSTRUCTURED_PLAY;
+      break;
+   }
+}
+
+void StartGameModeTimer(unsigned long durationMs) {
+   GameTimers.Start(TIMER_GAME_MODE, CurrentTime, durationMs, GameModeTimerExpired);
+}
+
+// Runs every 10 seconds after the saucer's last hit. The value holds in
+// the modes that take over the saucer lamps.
+void ReduceSaucerValue(uint8_t timerId, unsigned long curTime) {
+   (void)timerId;
+   (void)curTime;
+   if (GameMode == GAME_MODE_MINI_GAME_QUALIFIED || GameMode == GAME_MODE_SKILL_SHOT || GameMode == GAME_MODE_WIZARD) {
+      return;
+   }
+   if (SaucerValue > 10) {
+      SaucerValue -= 10;
+   } else {
+      SaucerValue = 5;
+      GameTimers.Cancel(TIMER_SAUCER_REDUCTION);
+   }
+}
+
 void ResetDropTargets() {
    RPU_PushToTimedSolenoidStack(SOL_DROP_TARGET_RESET, 12, CurrentTime + 400);
    DropTargetClearTime = CurrentTime;
@@ -1739,7 +1649,7 @@ void HandleDropTargetHit(uint8_t switchHit, unsigned long scoreMultiplier) {
                   SharpShooterTarget = 1;
                   // If a mini game is already qualified, give the player more time
                   if ((GameMode & 0x0F) == GAME_MODE_MINI_GAME_QUALIFIED) {
-                     GameModeEndTime = CurrentTime + MODE_QUALIFY_TIME;
+                     StartGameModeTimer(MODE_QUALIFY_TIME);
                   }
                }
 
@@ -1772,15 +1682,15 @@ void HandleStandupHit(uint8_t switchHit, unsigned long scoreMultiplier) {
    uint8_t switchMask = (1 << (switchHit - 19));
 
    if (!(GameMode & GAME_MODE_EXPLORE_THE_DEPTHS_FLAG)) {
-      if (CurrentTime > StandupDisplayEndTime || StandupDisplayEndTime == 0) {
-         StandupDisplayEndTime = CurrentTime + STANDUP_HIT_DISPLAY_DURATION;
+      if (!GameTimers.IsRunning(TIMER_STANDUP_DISPLAY)) {
+         GameTimers.Start(TIMER_STANDUP_DISPLAY, CurrentTime, STANDUP_HIT_DISPLAY_DURATION, NULL, 0, false);
          LastStandupTargetHit = 0;
       } else {
          uint8_t numSwitchesOn = CountBits(LastStandupTargetHit);
          if (numSwitchesOn > 3) {
             numSwitchesOn = 3;
          }
-         StandupDisplayEndTime = CurrentTime + STANDUP_HIT_DISPLAY_DURATION * numSwitchesOn;
+         GameTimers.Start(TIMER_STANDUP_DISPLAY, CurrentTime, STANDUP_HIT_DISPLAY_DURATION * numSwitchesOn, NULL, 0, false);
       }
 
       if (GameMode == GAME_MODE_SKILL_SHOT) {
@@ -1824,7 +1734,7 @@ void HandleStandupHit(uint8_t switchHit, unsigned long scoreMultiplier) {
          GameModeFlagsQualified |= GAME_MODE_EXPLORE_THE_DEPTHS_FLAG;
          // If a mini game is already qualified, give the player more time
          if ((GameMode & 0x0F) == GAME_MODE_MINI_GAME_QUALIFIED) {
-            GameModeEndTime = CurrentTime + MODE_QUALIFY_TIME;
+            StartGameModeTimer(MODE_QUALIFY_TIME);
          }
       } else {
          PlaySoundEffect(SOUND_EFFECT_STANDUPS_CLEARED);
@@ -1922,16 +1832,13 @@ int InitNewBall(bool curStateChanged, uint8_t playerNum, int ballNum) {
       GameModeStartTime = CurrentTime;
       GameMode = GAME_MODE_SKILL_SHOT;
       GameModeFlagsQualified = 0;
+      GameTimers.CancelAll();
       SaucerValue = 5;
-      NextSaucerReduction = 0;
       ShowSaucerHit = 0;
       SaucerHitTime = 0;
       DropTargetClearTime = 0;
-      StandupDisplayEndTime = 0;
       CurrentDropTargetsValid = 0x1F;
       RolloverValue = 2;
-      RolloverFlashEndTime = 0;
-      RescueFromTheDeepEndTime = 0;
       RescueFromTheDeepAvailable = true;
       LastSpinnerSide = 0; // 1=left, 2=right
       AlternatingSpinnerCount = 0;
@@ -1996,7 +1903,7 @@ void CheckForFeedingFrenzyQualify() {
       PlaySoundEffect(SOUND_EFFECT_FEEDING_FRENZY_QUALIFIED);
       // If a mini game is already qualified, give the player more time
       if ((GameMode & 0x0F) == GAME_MODE_MINI_GAME_QUALIFIED) {
-         GameModeEndTime = CurrentTime + MODE_QUALIFY_TIME;
+         StartGameModeTimer(MODE_QUALIFY_TIME);
       }
    }
 }
@@ -2021,10 +1928,6 @@ int ManageGameMode() {
       }
    }
 
-   if (CurrentTime > RescueFromTheDeepEndTime) {
-      RescueFromTheDeepEndTime = 0;
-   }
-
    switch ((GameMode & 0x0F)) {
    case GAME_MODE_SKILL_SHOT:
       if (BallFirstSwitchHitTime != 0) {
@@ -2042,7 +1945,8 @@ int ManageGameMode() {
          GameModeStartTime = CurrentTime;
       }
 
-      if (CurrentTime > StandupDisplayEndTime) {
+      // The spinners only pay for the last standups hit while they're shown
+      if (!GameTimers.IsRunning(TIMER_STANDUP_DISPLAY)) {
          LastStandupTargetHit = 0;
       }
 
@@ -2084,16 +1988,10 @@ int ManageGameMode() {
    case GAME_MODE_MINI_GAME_QUALIFIED:
       if (GameModeStartTime == 0) {
          GameModeStartTime = CurrentTime;
-         GameModeEndTime = CurrentTime + MODE_QUALIFY_TIME;
+         StartGameModeTimer(MODE_QUALIFY_TIME);
          // Play sound to direct player to saucer
       }
       CheckForFeedingFrenzyQualify();
-
-      if (CurrentTime > GameModeEndTime) {
-         GameModeStartTime = 0;
-         GameModeFlagsQualified = 0;
-         GameMode = GAME_MODE_UNSTRUCTURED_PLAY;
-      }
       break;
    case GAME_MODE_MINI_GAME_ENGAGED:
       if (GameModeStartTime == 0) {
@@ -2127,20 +2025,20 @@ int ManageGameMode() {
          uint8_t numMiniGames = CountBits(0xF0 & GameMode);
          if (numMiniGames == 1) {
             PlayBackgroundSong(SOUND_EFFECT_BACKGROUND_FOR_SINGLE_MODE);
-            GameModeEndTime = CurrentTime + (MINI_GAME_SINGLE_DURATION);
+            StartGameModeTimer(MINI_GAME_SINGLE_DURATION);
          } else if (numMiniGames == 2) {
             PlayBackgroundSong(SOUND_EFFECT_BACKGROUND_FOR_DOUBLE_MODE);
-            GameModeEndTime = CurrentTime + (MINI_GAME_DOUBLE_DURATION);
+            StartGameModeTimer(MINI_GAME_DOUBLE_DURATION);
          } else {
             PlayBackgroundSong(SOUND_EFFECT_BACKGROUND_FOR_TRIPLE_MODE);
-            GameModeEndTime = CurrentTime + (MINI_GAME_TRIPLE_DURATION);
+            StartGameModeTimer(MINI_GAME_TRIPLE_DURATION);
          }
       }
 
       if ((CurrentTime - GameModeStartTime) > MODE_START_DISPLAY_DURATION) {
          for (uint8_t count = 0; count < 4; count++) {
             if (count != CurrentPlayer) {
-               OverrideScoreDisplay(count, (GameModeEndTime - CurrentTime) / 1000, true);
+               OverrideScoreDisplay(count, GameTimers.GetRemaining(TIMER_GAME_MODE, CurrentTime) / 1000, true);
             }
          }
       }
@@ -2154,15 +2052,6 @@ int ManageGameMode() {
             ResetDropTargets();
          }
       }
-
-      if (CurrentTime > GameModeEndTime) {
-         GameModeEndTime = 0;
-         GameModeStartTime = 0;
-         LastMiniGameBonusTime = 0;
-         ShowPlayerScores(0xFF, false, false);
-         PlayBackgroundSong(SOUND_EFFECT_NONE);
-         GameMode = GAME_MODE_MINI_GAME_REWARD_COUNTDOWN;
-      }
       break;
    case GAME_MODE_MINI_GAME_REWARD_COUNTDOWN:
       if (GameModeStartTime == 0) {
@@ -2185,7 +2074,6 @@ int ManageGameMode() {
             CurrentPlayerCurrentScore += 2500;
             PlaySoundEffect(SOUND_EFFECT_EXPLORE_HIT);
          } else {
-            GameModeEndTime = 0;
             GameModeStartTime = 0;
             if (FeedingFrenzySpins[CurrentPlayer] && SharpShooterHits[CurrentPlayer] && ExploreTheDepthsHits[CurrentPlayer]) {
                GameMode = GAME_MODE_WIZARD;
@@ -2201,7 +2089,7 @@ int ManageGameMode() {
    case GAME_MODE_WIZARD_WITHOUT_FLAGS:
       if (GameModeStartTime == 0) {
          GameModeStartTime = CurrentTime;
-         GameModeEndTime = CurrentTime + WIZARD_MODE_DURATION;
+         StartGameModeTimer(WIZARD_MODE_DURATION);
          PlayBackgroundSong(SOUND_EFFECT_BACKGROUND_WIZ);
          PlaySoundEffect(SOUND_EFFECT_DEEP_BLUE_SEA_MODE);
          JackpotLit = true;
@@ -2215,24 +2103,9 @@ int ManageGameMode() {
 
       for (uint8_t count = 0; count < 4; count++) {
          if (count != CurrentPlayer) {
-            OverrideScoreDisplay(count, (GameModeEndTime - CurrentTime) / 1000, true);
+            OverrideScoreDisplay(count, GameTimers.GetRemaining(TIMER_GAME_MODE, CurrentTime) / 1000, true);
          }
       }
-
-      if (CurrentTime > GameModeEndTime) {
-         FeedingFrenzySpins[CurrentPlayer] = 0;
-         SharpShooterHits[CurrentPlayer] = 0;
-         ExploreTheDepthsHits[CurrentPlayer] = 0;
-         JackpotLit = false;
-         GameModeEndTime = 0;
-         GameModeStartTime = 0;
-         LastMiniGameBonusTime = 0;
-         ShowPlayerScores(0xFF, false, false);
-         PlayBackgroundSongBasedOnBall(CurrentBallInPlay);
-         PlaySoundEffect(SOUND_EFFECT_MODE_FINISHED);
-         GameMode = GAME_MODE_UNSTRUCTURED_PLAY;
-      }
-
       break;
    }
 
@@ -2269,11 +2142,14 @@ int ManageGameMode() {
                if (!BallSaveUsed && ((CurrentTime - BallFirstSwitchHitTime) / 1000) < ((unsigned long)BallSaveNumSeconds)) {
                   RPU_PushToTimedSolenoidStack(SOL_OUTHOLE, 4, CurrentTime + 100);
                   BallSaveUsed = true;
+                  // The mode clock and the saucer value stop until the saved
+                  // ball scores again (the short lamp & rescue windows don't)
+                  GameTimers.Pause(CurrentTime);
                   PlaySoundEffect(SOUND_EFFECT_SWIM_AGAIN);
                   RPU_SetLampState(SHOOT_AGAIN, 0);
                   BallTimeInTrough = CurrentTime;
                   returnState = MACHINE_STATE_NORMAL_GAMEPLAY;
-               } else if (RescueFromTheDeepEndTime != 0 && CurrentTime < RescueFromTheDeepEndTime) {
+               } else if (GameTimers.IsRunning(TIMER_RESCUE_FROM_THE_DEEP)) {
                   RPU_PushToTimedSolenoidStack(SOL_OUTHOLE, 4, CurrentTime + 100);
                   PlaySoundEffect(SOUND_EFFECT_RESCUE_FROM_THE_DEEP);
                   RescueFromTheDeepAvailable = false;
@@ -2285,6 +2161,7 @@ int ManageGameMode() {
                   ExploreTheDepthsHits[CurrentPlayer] += CurrentExploreTheDepths;
                   SharpShooterHits[CurrentPlayer] += CurrentSharpShooter;
                   PlayBackgroundSong(SOUND_EFFECT_NONE);
+                  GameTimers.CancelAll();
                   returnState = MACHINE_STATE_COUNTDOWN_BONUS;
                }
             }
@@ -2299,7 +2176,7 @@ int ManageGameMode() {
 
 unsigned long CountdownStartTime = 0;
 unsigned long LastCountdownReportTime = 0;
-unsigned long BonusCountDownEndTime = 0;
+bool BonusCountDownFinished = false;
 
 int CountdownBonus(bool curStateChanged) {
    // If this is the first time through the countdown loop
@@ -2310,7 +2187,7 @@ int CountdownBonus(bool curStateChanged) {
       ShowBonusOnTree(Bonus);
 
       LastCountdownReportTime = CountdownStartTime;
-      BonusCountDownEndTime = 0xFFFFFFFF;
+      BonusCountDownFinished = false;
    }
 
    if ((CurrentTime - LastCountdownReportTime) > 200) {
@@ -2323,18 +2200,19 @@ int CountdownBonus(bool curStateChanged) {
 
          Bonus -= 1;
          ShowBonusOnTree(Bonus);
-      } else if (BonusCountDownEndTime == 0xFFFFFFFF) {
+      } else if (!BonusCountDownFinished) {
          PlaySoundEffect(SOUND_EFFECT_BALL_OVER);
          RPU_SetLampState(BONUS_1, 0);
-         BonusCountDownEndTime = CurrentTime + 1000;
+         BonusCountDownFinished = true;
+         GameTimers.Start(TIMER_BALL_OVER, CurrentTime, 1000, NULL, 0, false);
       }
       LastCountdownReportTime = CurrentTime;
    }
 
-   if (CurrentTime > BonusCountDownEndTime) {
+   if (BonusCountDownFinished && !GameTimers.IsRunning(TIMER_BALL_OVER)) {
       // Reset any lights & variables of goals that weren't completed
 
-      BonusCountDownEndTime = 0xFFFFFFFF;
+      BonusCountDownFinished = false;
       return MACHINE_STATE_BALL_OVER;
    }
 
@@ -2454,6 +2332,438 @@ int ShowMatchSequence(bool curStateChanged) {
    return MACHINE_STATE_MATCH_MODE;
 }
 
+/*********************************************************************
+    Game play switch handlers
+*********************************************************************/
+// Each handler gets the switch that closed and the state the game loop
+// will return, and gives back that state (changed if the switch starts
+// a new game, for example).
+typedef int (*SwitchHandler)(uint8_t switchHit, int returnState, unsigned long scoreMultiplier);
+
+int HandleTiltSwitch(uint8_t /* switchHit */, int returnState, unsigned long /* scoreMultiplier */) {
+   // This should be debounced
+   if ((CurrentTime - LastTiltWarningTime) > TILT_WARNING_DEBOUNCE_TIME) {
+      LastTiltWarningTime = CurrentTime;
+      NumTiltWarnings += 1;
+      if (NumTiltWarnings > MaxTiltWarnings) {
+         RPU_DisableSolenoidStack();
+         RPU_SetDisableFlippers(true);
+         RPU_TurnOffAllLamps();
+         RPU_SetLampState(TILT, 1);
+         GameTimers.Pause(CurrentTime);
+      }
+      PlaySoundEffect(SOUND_EFFECT_TILT_WARNING);
+   }
+   return returnState;
+}
+
+int HandleLeftInlaneSwitch(uint8_t /* switchHit */, int returnState, unsigned long /* scoreMultiplier */) {
+   CurrentPlayerCurrentScore += ((unsigned long)RolloverValue) * (unsigned long)1000;
+   AddToBonus(1);
+   PlaySoundEffect(SOUND_EFFECT_LEFT_INLANE);
+   if (BallFirstSwitchHitTime == 0) {
+      BallFirstSwitchHitTime = CurrentTime;
+   }
+   return returnState;
+}
+
+int HandleRightInlaneSwitch(uint8_t /* switchHit */, int returnState, unsigned long /* scoreMultiplier */) {
+   CurrentPlayerCurrentScore += 3000;
+   AddToBonus(3);
+   PlaySoundEffect(SOUND_EFFECT_RIGHT_INLANE);
+   if (RescueFromTheDeepAvailable) {
+      // Keeps running through a tilt or ball save, so a tilted ball can't
+      // drain into a rescue
+      GameTimers.Start(TIMER_RESCUE_FROM_THE_DEEP, CurrentTime, RESCUE_FROM_THE_DEEP_TIME, NULL, 0, false);
+   }
+   if (NumberOfStandupClears == 1 && !ExtraBallCollected) {
+      ExtraBallCollected = true;
+      // Set shoot again or give score
+      if (TournamentScoring) {
+         CurrentPlayerCurrentScore += (unsigned long)ExtraBallValue;
+      } else {
+         SamePlayerShootsAgain = true;
+         PlaySoundEffect(SOUND_EFFECT_SWIM_AGAIN);
+      }
+   }
+   if (BallFirstSwitchHitTime == 0) {
+      BallFirstSwitchHitTime = CurrentTime;
+   }
+   return returnState;
+}
+
+int HandleRightOutlaneSwitch(uint8_t /* switchHit */, int returnState, unsigned long /* scoreMultiplier */) {
+   CurrentPlayerCurrentScore += 500;
+   PlaySoundEffect(SOUND_EFFECT_RIGHT_OUTLANE);
+   if (NumberOfStandupClears == StandupSpecialLevel && !SpecialCollected) {
+      SpecialCollected = true;
+      // Set shoot again or give score
+      if (TournamentScoring) {
+         CurrentPlayerCurrentScore += (unsigned long)SpecialValue;
+      } else {
+      }
+   }
+   if (BallFirstSwitchHitTime == 0) {
+      BallFirstSwitchHitTime = CurrentTime;
+   }
+   return returnState;
+}
+
+int Handle10PointSwitch(uint8_t /* switchHit */, int returnState, unsigned long /* scoreMultiplier */) {
+   CurrentPlayerCurrentScore += 10;
+   PlaySoundEffect(SOUND_EFFECT_10PT_SWITCH);
+   return returnState;
+}
+
+int HandleLeftSpinnerSwitch(uint8_t /* switchHit */, int returnState, unsigned long scoreMultiplier) {
+   if (GameMode == GAME_MODE_SKILL_SHOT) {
+      CurrentPlayerCurrentScore += 10000;
+      PlaySoundEffect(SOUND_EFFECT_LEFT_SPINNER);
+   } else if ((GameMode & GAME_MODE_FEEDING_FRENZY_FLAG)) {
+      CurrentPlayerCurrentScore += (unsigned long)5000 * (unsigned long)scoreMultiplier;
+      PlaySoundEffect(SOUND_EFFECT_FEEDING_FRENZY);
+      if (CurrentFeedingFrenzy < 255) {
+         CurrentFeedingFrenzy += 1;
+      }
+   } else {
+      unsigned long scoreAddition = 0;
+      if (LastStandupTargetHit & STANDUP_AMBER_MASK) {
+         scoreAddition += 400;
+      }
+      if (LastStandupTargetHit & STANDUP_WHITE_MASK) {
+         scoreAddition += 400;
+      }
+      if (LastStandupTargetHit & STANDUP_PURPLE_MASK) {
+         scoreAddition += 1000;
+      }
+      if (CurrentStandupsHit & STANDUP_AMBER_MASK) {
+         scoreAddition += 400;
+      }
+      if (CurrentStandupsHit & STANDUP_WHITE_MASK) {
+         scoreAddition += 400;
+      }
+      if (CurrentStandupsHit & STANDUP_PURPLE_MASK) {
+         scoreAddition += 1000;
+      }
+      CurrentPlayerCurrentScore += (200 + (unsigned long)scoreAddition);
+      if (LastSpinnerHitTime != 0 && LastSpinnerSide == 2) {
+         AlternatingSpinnerCount += 1;
+      }
+      LastSpinnerHitTime = CurrentTime;
+      LastSpinnerSide = 1;
+      PlaySoundEffect(SOUND_EFFECT_LEFT_SPINNER);
+   }
+   if (BallFirstSwitchHitTime == 0) {
+      BallFirstSwitchHitTime = CurrentTime;
+   }
+   return returnState;
+}
+
+int HandleRightSpinnerSwitch(uint8_t /* switchHit */, int returnState, unsigned long scoreMultiplier) {
+   if ((GameMode & GAME_MODE_FEEDING_FRENZY_FLAG)) {
+      CurrentPlayerCurrentScore += (unsigned long)5000 * (unsigned long)scoreMultiplier;
+      PlaySoundEffect(SOUND_EFFECT_FEEDING_FRENZY);
+      if (CurrentFeedingFrenzy < 255) {
+         CurrentFeedingFrenzy += 1;
+      }
+   } else if (GameMode != GAME_MODE_SKILL_SHOT) {
+      unsigned long scoreAddition = 0;
+      if (LastStandupTargetHit & STANDUP_YELLOW_MASK) {
+         scoreAddition += 400;
+      }
+      if (LastStandupTargetHit & STANDUP_GREEN_MASK) {
+         scoreAddition += 400;
+      }
+      if (LastStandupTargetHit & STANDUP_PURPLE_MASK) {
+         scoreAddition += 1000;
+      }
+      if (CurrentStandupsHit & STANDUP_YELLOW_MASK) {
+         scoreAddition += 400;
+      }
+      if (CurrentStandupsHit & STANDUP_GREEN_MASK) {
+         scoreAddition += 400;
+      }
+      if (CurrentStandupsHit & STANDUP_PURPLE_MASK) {
+         scoreAddition += 1000;
+      }
+      CurrentPlayerCurrentScore += (200 + (unsigned long)scoreAddition);
+      PlaySoundEffect(SOUND_EFFECT_RIGHT_SPINNER);
+      if (BallFirstSwitchHitTime == 0) {
+         BallFirstSwitchHitTime = CurrentTime;
+      }
+      if (LastSpinnerHitTime != 0 && LastSpinnerSide == 1) {
+         AlternatingSpinnerCount += 1;
+      }
+      LastSpinnerHitTime = CurrentTime;
+      LastSpinnerSide = 2;
+   }
+   return returnState;
+}
+
+int HandleSaucerSwitch(uint8_t /* switchHit */, int returnState, unsigned long /* scoreMultiplier */) {
+   // We only count a saucer hit if it hasn't happened in the last 500ms
+   // (software debounce)
+   if (SaucerHitTime == 0 || (CurrentTime - SaucerHitTime) > 500) {
+      SaucerHitTime = CurrentTime;
+      ShowSaucerHit = SaucerValue;
+
+      if (JackpotLit) {
+         FeedingFrenzySpins[CurrentPlayer] += CurrentFeedingFrenzy;
+         ExploreTheDepthsHits[CurrentPlayer] += CurrentExploreTheDepths;
+         SharpShooterHits[CurrentPlayer] += CurrentSharpShooter;
+         CurrentFeedingFrenzy = 0;
+         CurrentExploreTheDepths = 0;
+         CurrentSharpShooter = 0;
+         PlaySoundEffect(SOUND_EFFECT_JACKPOT);
+         CurrentPlayerCurrentScore += (unsigned long)FeedingFrenzySpins[CurrentPlayer] * 1000;
+         CurrentPlayerCurrentScore += (unsigned long)ExploreTheDepthsHits[CurrentPlayer] * 10000;
+         CurrentPlayerCurrentScore += (unsigned long)SharpShooterHits[CurrentPlayer] * 10000;
+         JackpotLit = false;
+      } else {
+         CurrentPlayerCurrentScore += 1000 * ((unsigned long)SaucerValue);
+         switch (SaucerValue) {
+         case 5:
+            PlaySoundEffect(SOUND_EFFECT_SAUCER_HIT_5K);
+            break;
+         case 10:
+            PlaySoundEffect(SOUND_EFFECT_SAUCER_HIT_10K);
+            break;
+         case 20:
+            PlaySoundEffect(SOUND_EFFECT_SAUCER_HIT_20K);
+            break;
+         case 30:
+            PlaySoundEffect(SOUND_EFFECT_SAUCER_HIT_30K);
+            break;
+         }
+      }
+
+      if (GameMode != GAME_MODE_SKILL_SHOT) {
+         GameTimers.Start(TIMER_SAUCER_REDUCTION, CurrentTime, SAUCER_DISPLAY_DURATION + 10000, ReduceSaucerValue, 10000);
+         if (SaucerValue == 5) {
+            SaucerValue = 10;
+         } else if (SaucerValue < 30) {
+            SaucerValue += 10;
+         }
+      }
+      if (GameMode == GAME_MODE_MINI_GAME_QUALIFIED) {
+         GameMode = GAME_MODE_MINI_GAME_ENGAGED | GameModeFlagsQualified;
+         GameModeFlagsQualified = 0;
+         GameModeStartTime = 0;
+         // The mini game starts its own timer once the intro is over
+         GameTimers.Cancel(TIMER_GAME_MODE);
+         RPU_PushToTimedSolenoidStack(SOL_SAUCER, 5, CurrentTime + MODE_START_DISPLAY_DURATION);
+      } else {
+         RPU_PushToTimedSolenoidStack(SOL_SAUCER, 5, CurrentTime + SAUCER_DISPLAY_DURATION);
+      }
+   }
+   if (BallFirstSwitchHitTime == 0) {
+      BallFirstSwitchHitTime = CurrentTime;
+   }
+   return returnState;
+}
+
+int HandleRolloverSwitch(uint8_t /* switchHit */, int returnState, unsigned long /* scoreMultiplier */) {
+   if (GameMode == GAME_MODE_SKILL_SHOT) {
+      CurrentPlayerCurrentScore += 8000;
+      RolloverValue = 6;
+      PlaySoundEffect(SOUND_EFFECT_ROLLOVER_SKILL_SHOT);
+   } else {
+      CurrentPlayerCurrentScore += 1000 * ((unsigned long)RolloverValue);
+      PlaySoundEffect(SOUND_EFFECT_ROLLOVER);
+      RolloverValue += 2;
+      if (RolloverValue > 14) {
+         RolloverValue = 14;
+      }
+   }
+   GameTimers.Start(TIMER_ROLLOVER_FLASH, CurrentTime, ROLLOVER_FLASH_DURATION, NULL, 0, false);
+   if (BallFirstSwitchHitTime == 0) {
+      BallFirstSwitchHitTime = CurrentTime;
+   }
+   return returnState;
+}
+
+int HandleDropTargetSwitch(uint8_t switchHit, int returnState, unsigned long scoreMultiplier) {
+   if (GameMode != GAME_MODE_SKILL_SHOT || (CurrentTime - GameModeStartTime) > 500) {
+      HandleDropTargetHit(switchHit, scoreMultiplier);
+      if (BallFirstSwitchHitTime == 0) {
+         BallFirstSwitchHitTime = CurrentTime;
+      }
+   }
+   return returnState;
+}
+
+int HandleTopBumperSwitch(uint8_t /* switchHit */, int returnState, unsigned long scoreMultiplier) {
+   CurrentPlayerCurrentScore += (unsigned long)100 * (unsigned long)scoreMultiplier;
+   PlaySoundEffect(SOUND_EFFECT_TOP_BUMPER_HIT);
+   if (BallFirstSwitchHitTime == 0) {
+      BallFirstSwitchHitTime = CurrentTime;
+   }
+   return returnState;
+}
+
+int HandleBottomBumperSwitch(uint8_t /* switchHit */, int returnState, unsigned long scoreMultiplier) {
+   CurrentPlayerCurrentScore += (unsigned long)100 * (unsigned long)scoreMultiplier;
+   PlaySoundEffect(SOUND_EFFECT_BOTTOM_BUMPER_HIT);
+   if (BallFirstSwitchHitTime == 0) {
+      BallFirstSwitchHitTime = CurrentTime;
+   }
+   return returnState;
+}
+
+int HandleStandupSwitch(uint8_t switchHit, int returnState, unsigned long scoreMultiplier) {
+   HandleStandupHit(switchHit, scoreMultiplier);
+   if (BallFirstSwitchHitTime == 0) {
+      BallFirstSwitchHitTime = CurrentTime;
+   }
+   return returnState;
+}
+
+int HandleUpperSlingSwitch(uint8_t /* switchHit */, int returnState, unsigned long /* scoreMultiplier */) {
+   CurrentPlayerCurrentScore += 10;
+   AddToBonus(1);
+   PlaySoundEffect(SOUND_EFFECT_UPPER_SLING);
+   if (BallFirstSwitchHitTime == 0) {
+      BallFirstSwitchHitTime = CurrentTime;
+   }
+   return returnState;
+}
+
+int HandleLowerSlingSwitch(uint8_t /* switchHit */, int returnState, unsigned long /* scoreMultiplier */) {
+   CurrentPlayerCurrentScore += 10;
+   PlaySoundEffect(SOUND_EFFECT_LOWER_SLING);
+   if (BallFirstSwitchHitTime == 0) {
+      BallFirstSwitchHitTime = CurrentTime;
+   }
+   return returnState;
+}
+
+int HandleCoinSwitch(uint8_t switchHit, int returnState, unsigned long /* scoreMultiplier */) {
+   AddCoinToAudit(switchHit);
+   AddCredit(true, 1);
+   return returnState;
+}
+
+int HandleCreditResetSwitch(uint8_t /* switchHit */, int returnState, unsigned long /* scoreMultiplier */) {
+   if (CurrentBallInPlay < 2) {
+      // If we haven't finished the first ball, we can add players
+      AddPlayer();
+   } else {
+      // If the first ball is over, pressing start again resets the game
+      if (Credits >= 1 || FreePlayMode) {
+         if (!FreePlayMode) {
+            Credits -= 1;
+            RPU_WriteByteToEEProm(RPU_CREDITS_EEPROM_BYTE, Credits);
+            RPU_SetDisplayCredits(Credits);
+         }
+         returnState = MACHINE_STATE_INIT_GAMEPLAY;
+      }
+   }
+   DEBUG_MESSAGE("Start game button pressed\n\r");
+   return returnState;
+}
+
+int HandleTiltedSaucerSwitch(uint8_t /* switchHit */, int returnState, unsigned long /* scoreMultiplier */) {
+   // Kick the ball out without scoring
+   RPU_PushToSolenoidStack(SOL_SAUCER, 5, true);
+   return returnState;
+}
+
+// SW_OUTHOLE is the highest numbered switch
+constexpr uint8_t NUM_SWITCH_HANDLERS = SW_OUTHOLE + 1;
+
+// Handlers by switch number - switches without one (like the outhole,
+// which is watched by ManageGameMode) are NULL
+const SwitchHandler GamePlaySwitchHandlers[NUM_SWITCH_HANDLERS] PROGMEM = {
+    HandleCoinSwitch,         // 0 SW_COIN_2
+    HandleCoinSwitch,         // 1 SW_COIN_1
+    HandleCoinSwitch,         // 2 SW_COIN_3
+    HandleRightSpinnerSwitch, // 3 SW_RIGHT_SPINNER
+    HandleLeftSpinnerSwitch,  // 4 SW_LEFT_SPINNER
+    HandleCreditResetSwitch,  // 5 SW_CREDIT_RESET
+    HandleTiltSwitch,         // 6 SW_TILT
+    NULL,                     // 7 SW_SLAM
+    NULL,                     // 8
+    HandleRolloverSwitch,     // 9 SW_ROLLOVER
+    HandleUpperSlingSwitch,   // 10 SW_UR_SLING
+    HandleUpperSlingSwitch,   // 11 SW_UL_SLING
+    HandleLowerSlingSwitch,   // 12 SW_LR_SLING
+    HandleLowerSlingSwitch,   // 13 SW_LL_SLING
+    HandleTopBumperSwitch,    // 14 SW_TOP_BUMPER
+    HandleBottomBumperSwitch, // 15 SW_BOTTOM_BUMPER
+    HandleRightOutlaneSwitch, // 16 SW_RIGHT_OUTLANE
+    HandleRightInlaneSwitch,  // 17 SW_RIGHT_INLANE
+    HandleLeftInlaneSwitch,   // 18 SW_LEFT_INLANE
+    HandleStandupSwitch,      // 19 SW_PURPLE
+    HandleStandupSwitch,      // 20 SW_YELLOW
+    HandleStandupSwitch,      // 21 SW_AMBER
+    HandleStandupSwitch,      // 22 SW_GREEN
+    HandleStandupSwitch,      // 23 SW_WHITE
+    NULL,                     // 24
+    HandleSaucerSwitch,       // 25 SW_SAUCER
+    Handle10PointSwitch,      // 26 SW_10_PTS
+    HandleDropTargetSwitch,   // 27 SW_DROP_TARGET_5
+    HandleDropTargetSwitch,   // 28 SW_DROP_TARGET_4
+    HandleDropTargetSwitch,   // 29 SW_DROP_TARGET_3
+    HandleDropTargetSwitch,   // 30 SW_DROP_TARGET_2
+    HandleDropTargetSwitch,   // 31 SW_DROP_TARGET_1
+    NULL,                     // 32 SW_OUTHOLE
+};
+
+// When tilted, only coins and the saucer (to get the ball back) count
+const SwitchHandler TiltedSwitchHandlers[NUM_SWITCH_HANDLERS] PROGMEM = {
+    HandleCoinSwitch,         // 0 SW_COIN_2
+    HandleCoinSwitch,         // 1 SW_COIN_1
+    HandleCoinSwitch,         // 2 SW_COIN_3
+    NULL,                     // 3 SW_RIGHT_SPINNER
+    NULL,                     // 4 SW_LEFT_SPINNER
+    NULL,                     // 5 SW_CREDIT_RESET
+    NULL,                     // 6 SW_TILT
+    NULL,                     // 7 SW_SLAM
+    NULL,                     // 8
+    NULL,                     // 9 SW_ROLLOVER
+    NULL,                     // 10 SW_UR_SLING
+    NULL,                     // 11 SW_UL_SLING
+    NULL,                     // 12 SW_LR_SLING
+    NULL,                     // 13 SW_LL_SLING
+    NULL,                     // 14 SW_TOP_BUMPER
+    NULL,                     // 15 SW_BOTTOM_BUMPER
+    NULL,                     // 16 SW_RIGHT_OUTLANE
+    NULL,                     // 17 SW_RIGHT_INLANE
+    NULL,                     // 18 SW_LEFT_INLANE
+    NULL,                     // 19 SW_PURPLE
+    NULL,                     // 20 SW_YELLOW
+    NULL,                     // 21 SW_AMBER
+    NULL,                     // 22 SW_GREEN
+    NULL,                     // 23 SW_WHITE
+    NULL,                     // 24
+    HandleTiltedSaucerSwitch, // 25 SW_SAUCER
+    NULL,                     // 26 SW_10_PTS
+    NULL,                     // 27 SW_DROP_TARGET_5
+    NULL,                     // 28 SW_DROP_TARGET_4
+    NULL,                     // 29 SW_DROP_TARGET_3
+    NULL,                     // 30 SW_DROP_TARGET_2
+    NULL,                     // 31 SW_DROP_TARGET_1
+    NULL,                     // 32 SW_OUTHOLE
+};
+
+// Every game play switch goes through here, so this is the place to
+// count or time switch hits
+int DispatchSwitch(const SwitchHandler* switchHandlers, uint8_t switchHit, int returnState, unsigned long scoreMultiplier) {
+   if (switchHit == SW_SELF_TEST_SWITCH) {
+      SetLastSelfTestChangedTime(CurrentTime);
+      return MACHINE_STATE_TEST_LAMPS;
+   }
+   if (switchHit >= NUM_SWITCH_HANDLERS) {
+      return returnState;
+   }
+
+   SwitchHandler handler = (SwitchHandler)pgm_read_ptr(&switchHandlers[switchHit]);
+   if (handler == NULL) {
+      return returnState;
+   }
+   return handler(switchHit, returnState, scoreMultiplier);
+}
+
 int RunGamePlayMode(int curState, bool curStateChanged) {
    int returnState = curState;
    uint8_t bonusAtTop = Bonus;
@@ -2463,6 +2773,8 @@ int RunGamePlayMode(int curState, bool curStateChanged) {
       scoreMultiplier = (unsigned long)CountBits(GameMode & 0x70);
    }
 
+   GameTimers.Update(CurrentTime);
+
    // Very first time into gameplay loop
    if (curState == MACHINE_STATE_INIT_GAMEPLAY) {
       returnState = InitGamePlay();
@@ -2507,362 +2819,12 @@ int RunGamePlayMode(int curState, bool curStateChanged) {
       returnState = ShowMatchSequence(curStateChanged);
    }
 
+   // The tilt is checked once, so switches already on the stack when the
+   // game tilts are still scored
+   const SwitchHandler* switchHandlers = (NumTiltWarnings <= MaxTiltWarnings) ? GamePlaySwitchHandlers : TiltedSwitchHandlers;
    uint8_t switchHit;
-
-   if (NumTiltWarnings <= MaxTiltWarnings) {
-      while ((switchHit = RPU_PullFirstFromSwitchStack()) != SWITCH_STACK_EMPTY) {
-         switch (switchHit) {
-         case SW_SLAM:
-            //          RPU_DisableSolenoidStack();
-            //          RPU_SetDisableFlippers(true);
-            //          RPU_TurnOffAllLamps();
-            //          RPU_SetLampState(GAME_OVER, 1);
-            //          delay(1000);
-            //          return MACHINE_STATE_ATTRACT;
-            break;
-
-         case SW_TILT:
-            // This should be debounced
-            if ((CurrentTime - LastTiltWarningTime) > TILT_WARNING_DEBOUNCE_TIME) {
-               LastTiltWarningTime = CurrentTime;
-               NumTiltWarnings += 1;
-               if (NumTiltWarnings > MaxTiltWarnings) {
-                  RPU_DisableSolenoidStack();
-                  RPU_SetDisableFlippers(true);
-                  RPU_TurnOffAllLamps();
-                  RPU_SetLampState(TILT, 1);
-               }
-               PlaySoundEffect(SOUND_EFFECT_TILT_WARNING);
-            }
-            break;
-
-         case SW_SELF_TEST_SWITCH:
-            returnState = MACHINE_STATE_TEST_LAMPS;
-            SetLastSelfTestChangedTime(CurrentTime);
-            break;
-
-         case SW_LEFT_INLANE:
-            CurrentPlayerCurrentScore += ((unsigned long)RolloverValue) * (unsigned long)1000;
-            AddToBonus(1);
-            PlaySoundEffect(SOUND_EFFECT_LEFT_INLANE);
-            if (BallFirstSwitchHitTime == 0) {
-               BallFirstSwitchHitTime = CurrentTime;
-            }
-            break;
-
-         case SW_RIGHT_INLANE:
-            CurrentPlayerCurrentScore += 3000;
-            AddToBonus(3);
-            PlaySoundEffect(SOUND_EFFECT_RIGHT_INLANE);
-            if (RescueFromTheDeepAvailable) {
-               RescueFromTheDeepEndTime = CurrentTime + RESCUE_FROM_THE_DEEP_TIME;
-            }
-            if (NumberOfStandupClears == 1 && !ExtraBallCollected) {
-               ExtraBallCollected = true;
-               // Set shoot again or give score
-               if (TournamentScoring) {
-                  CurrentPlayerCurrentScore += (unsigned long)ExtraBallValue;
-               } else {
-                  SamePlayerShootsAgain = true;
-                  PlaySoundEffect(SOUND_EFFECT_SWIM_AGAIN);
-               }
-            }
-            if (BallFirstSwitchHitTime == 0) {
-               BallFirstSwitchHitTime = CurrentTime;
-            }
-            break;
-
-         case SW_RIGHT_OUTLANE:
-            CurrentPlayerCurrentScore += 500;
-            PlaySoundEffect(SOUND_EFFECT_RIGHT_OUTLANE);
-            if (NumberOfStandupClears == StandupSpecialLevel && !SpecialCollected) {
-               SpecialCollected = true;
-               // Set shoot again or give score
-               if (TournamentScoring) {
-                  CurrentPlayerCurrentScore += (unsigned long)SpecialValue;
-               } else {
-               }
-            }
-            if (BallFirstSwitchHitTime == 0) {
-               BallFirstSwitchHitTime = CurrentTime;
-            }
-            break;
-
-         case SW_10_PTS:
-            CurrentPlayerCurrentScore += 10;
-            PlaySoundEffect(SOUND_EFFECT_10PT_SWITCH);
-            break;
-
-         case SW_LEFT_SPINNER:
-            if (GameMode == GAME_MODE_SKILL_SHOT) {
-               CurrentPlayerCurrentScore += 10000;
-               PlaySoundEffect(SOUND_EFFECT_LEFT_SPINNER);
-            } else if ((GameMode & GAME_MODE_FEEDING_FRENZY_FLAG)) {
-               CurrentPlayerCurrentScore += (unsigned long)5000 * (unsigned long)scoreMultiplier;
-               PlaySoundEffect(SOUND_EFFECT_FEEDING_FRENZY);
-               if (CurrentFeedingFrenzy < 255) {
-                  CurrentFeedingFrenzy += 1;
-               }
-            } else {
-               unsigned long scoreAddition = 0;
-               if (LastStandupTargetHit & STANDUP_AMBER_MASK) {
-                  scoreAddition += 400;
-               }
-               if (LastStandupTargetHit & STANDUP_WHITE_MASK) {
-                  scoreAddition += 400;
-               }
-               if (LastStandupTargetHit & STANDUP_PURPLE_MASK) {
-                  scoreAddition += 1000;
-               }
-               if (CurrentStandupsHit & STANDUP_AMBER_MASK) {
-                  scoreAddition += 400;
-               }
-               if (CurrentStandupsHit & STANDUP_WHITE_MASK) {
-                  scoreAddition += 400;
-               }
-               if (CurrentStandupsHit & STANDUP_PURPLE_MASK) {
-                  scoreAddition += 1000;
-               }
-               CurrentPlayerCurrentScore += (200 + (unsigned long)scoreAddition);
-               if (LastSpinnerHitTime != 0 && LastSpinnerSide == 2) {
-                  AlternatingSpinnerCount += 1;
-               }
-               LastSpinnerHitTime = CurrentTime;
-               LastSpinnerSide = 1;
-               PlaySoundEffect(SOUND_EFFECT_LEFT_SPINNER);
-            }
-            if (BallFirstSwitchHitTime == 0) {
-               BallFirstSwitchHitTime = CurrentTime;
-            }
-            break;
-
-         case SW_RIGHT_SPINNER:
-            if ((GameMode & GAME_MODE_FEEDING_FRENZY_FLAG)) {
-               CurrentPlayerCurrentScore += (unsigned long)5000 * (unsigned long)scoreMultiplier;
-               PlaySoundEffect(SOUND_EFFECT_FEEDING_FRENZY);
-               if (CurrentFeedingFrenzy < 255) {
-                  CurrentFeedingFrenzy += 1;
-               }
-            } else if (GameMode != GAME_MODE_SKILL_SHOT) {
-               unsigned long scoreAddition = 0;
-               if (LastStandupTargetHit & STANDUP_YELLOW_MASK) {
-                  scoreAddition += 400;
-               }
-               if (LastStandupTargetHit & STANDUP_GREEN_MASK) {
-                  scoreAddition += 400;
-               }
-               if (LastStandupTargetHit & STANDUP_PURPLE_MASK) {
-                  scoreAddition += 1000;
-               }
-               if (CurrentStandupsHit & STANDUP_YELLOW_MASK) {
-                  scoreAddition += 400;
-               }
-               if (CurrentStandupsHit & STANDUP_GREEN_MASK) {
-                  scoreAddition += 400;
-               }
-               if (CurrentStandupsHit & STANDUP_PURPLE_MASK) {
-                  scoreAddition += 1000;
-               }
-               CurrentPlayerCurrentScore += (200 + (unsigned long)scoreAddition);
-               PlaySoundEffect(SOUND_EFFECT_RIGHT_SPINNER);
-               if (BallFirstSwitchHitTime == 0) {
-                  BallFirstSwitchHitTime = CurrentTime;
-               }
-               if (LastSpinnerHitTime != 0 && LastSpinnerSide == 1) {
-                  AlternatingSpinnerCount += 1;
-               }
-               LastSpinnerHitTime = CurrentTime;
-               LastSpinnerSide = 2;
-            }
-            break;
-
-         case SW_SAUCER:
-            // We only count a saucer hit if it hasn't happened in the last 500ms
-            // (software debounce)
-            if (SaucerHitTime == 0 || (CurrentTime - SaucerHitTime) > 500) {
-               SaucerHitTime = CurrentTime;
-               ShowSaucerHit = SaucerValue;
-
-               if (JackpotLit) {
-                  FeedingFrenzySpins[CurrentPlayer] += CurrentFeedingFrenzy;
-                  ExploreTheDepthsHits[CurrentPlayer] += CurrentExploreTheDepths;
-                  SharpShooterHits[CurrentPlayer] += CurrentSharpShooter;
-                  CurrentFeedingFrenzy = 0;
-                  CurrentExploreTheDepths = 0;
-                  CurrentSharpShooter = 0;
-                  PlaySoundEffect(SOUND_EFFECT_JACKPOT);
-                  CurrentPlayerCurrentScore += (unsigned long)FeedingFrenzySpins[CurrentPlayer] * 1000;
-                  CurrentPlayerCurrentScore += (unsigned long)ExploreTheDepthsHits[CurrentPlayer] * 10000;
-                  CurrentPlayerCurrentScore += (unsigned long)SharpShooterHits[CurrentPlayer] * 10000;
-                  JackpotLit = false;
-               } else {
-                  CurrentPlayerCurrentScore += 1000 * ((unsigned long)SaucerValue);
-                  switch (SaucerValue) {
-                  case 5:
-                     PlaySoundEffect(SOUND_EFFECT_SAUCER_HIT_5K);
-                     break;
-                  case 10:
-                     PlaySoundEffect(SOUND_EFFECT_SAUCER_HIT_10K);
-                     break;
-                  case 20:
-                     PlaySoundEffect(SOUND_EFFECT_SAUCER_HIT_20K);
-                     break;
-                  case 30:
-                     PlaySoundEffect(SOUND_EFFECT_SAUCER_HIT_30K);
-                     break;
-                  }
-               }
-
-               if (GameMode != GAME_MODE_SKILL_SHOT) {
-                  NextSaucerReduction = CurrentTime + SAUCER_DISPLAY_DURATION + 10000;
-                  if (SaucerValue == 5) {
-                     SaucerValue = 10;
-                  } else if (SaucerValue < 30) {
-                     SaucerValue += 10;
-                  }
-               }
-               if (GameMode == GAME_MODE_MINI_GAME_QUALIFIED) {
-                  GameMode = GAME_MODE_MINI_GAME_ENGAGED | GameModeFlagsQualified;
-                  GameModeFlagsQualified = 0;
-                  GameModeStartTime = 0;
-                  RPU_PushToTimedSolenoidStack(SOL_SAUCER, 5, CurrentTime + MODE_START_DISPLAY_DURATION);
-               } else {
-                  RPU_PushToTimedSolenoidStack(SOL_SAUCER, 5, CurrentTime + SAUCER_DISPLAY_DURATION);
-               }
-            }
-            if (BallFirstSwitchHitTime == 0) {
-               BallFirstSwitchHitTime = CurrentTime;
-            }
-            break;
-
-         case SW_ROLLOVER:
-            if (GameMode == GAME_MODE_SKILL_SHOT) {
-               CurrentPlayerCurrentScore += 8000;
-               RolloverValue = 6;
-               PlaySoundEffect(SOUND_EFFECT_ROLLOVER_SKILL_SHOT);
-            } else {
-               CurrentPlayerCurrentScore += 1000 * ((unsigned long)RolloverValue);
-               PlaySoundEffect(SOUND_EFFECT_ROLLOVER);
-               RolloverValue += 2;
-               if (RolloverValue > 14) {
-                  RolloverValue = 14;
-               }
-            }
-            RolloverFlashEndTime = CurrentTime + ROLLOVER_FLASH_DURATION;
-            if (BallFirstSwitchHitTime == 0) {
-               BallFirstSwitchHitTime = CurrentTime;
-            }
-            break;
-
-         case SW_OUTHOLE:
-            break;
-
-         case SW_DROP_TARGET_1:
-         case SW_DROP_TARGET_2:
-         case SW_DROP_TARGET_3:
-         case SW_DROP_TARGET_4:
-         case SW_DROP_TARGET_5:
-            if (GameMode != GAME_MODE_SKILL_SHOT || (CurrentTime - GameModeStartTime) > 500) {
-               HandleDropTargetHit(switchHit, scoreMultiplier);
-               if (BallFirstSwitchHitTime == 0) {
-                  BallFirstSwitchHitTime = CurrentTime;
-               }
-            }
-            break;
-
-         case SW_TOP_BUMPER:
-            CurrentPlayerCurrentScore += (unsigned long)100 * (unsigned long)scoreMultiplier;
-            PlaySoundEffect(SOUND_EFFECT_TOP_BUMPER_HIT);
-            if (BallFirstSwitchHitTime == 0) {
-               BallFirstSwitchHitTime = CurrentTime;
-            }
-            break;
-
-         case SW_BOTTOM_BUMPER:
-            CurrentPlayerCurrentScore += (unsigned long)100 * (unsigned long)scoreMultiplier;
-            PlaySoundEffect(SOUND_EFFECT_BOTTOM_BUMPER_HIT);
-            if (BallFirstSwitchHitTime == 0) {
-               BallFirstSwitchHitTime = CurrentTime;
-            }
-            break;
-
-         case SW_WHITE:
-         case SW_GREEN:
-         case SW_AMBER:
-         case SW_YELLOW:
-         case SW_PURPLE:
-            HandleStandupHit(switchHit, scoreMultiplier);
-            if (BallFirstSwitchHitTime == 0) {
-               BallFirstSwitchHitTime = CurrentTime;
-            }
-            break;
-
-         case SW_UL_SLING:
-         case SW_UR_SLING:
-            CurrentPlayerCurrentScore += 10;
-            AddToBonus(1);
-            PlaySoundEffect(SOUND_EFFECT_UPPER_SLING);
-            if (BallFirstSwitchHitTime == 0) {
-               BallFirstSwitchHitTime = CurrentTime;
-            }
-            break;
-
-         case SW_LL_SLING:
-         case SW_LR_SLING:
-            CurrentPlayerCurrentScore += 10;
-            PlaySoundEffect(SOUND_EFFECT_LOWER_SLING);
-            if (BallFirstSwitchHitTime == 0) {
-               BallFirstSwitchHitTime = CurrentTime;
-            }
-            break;
-
-         case SW_COIN_1:
-         case SW_COIN_2:
-         case SW_COIN_3:
-            AddCoinToAudit(switchHit);
-            AddCredit(true, 1);
-            break;
-
-         case SW_CREDIT_RESET:
-            if (CurrentBallInPlay < 2) {
-               // If we haven't finished the first ball, we can add players
-               AddPlayer();
-            } else {
-               // If the first ball is over, pressing start again resets the game
-               if (Credits >= 1 || FreePlayMode) {
-                  if (!FreePlayMode) {
-                     Credits -= 1;
-                     RPU_WriteByteToEEProm(RPU_CREDITS_EEPROM_BYTE, Credits);
-                     RPU_SetDisplayCredits(Credits);
-                  }
-                  returnState = MACHINE_STATE_INIT_GAMEPLAY;
-               }
-            }
-            DEBUG_MESSAGE("Start game button pressed\n\r");
-            break;
-         }
-      }
-   } else {
-      // We're tilted, so just wait for outhole
-      while ((switchHit = RPU_PullFirstFromSwitchStack()) != SWITCH_STACK_EMPTY) {
-         switch (switchHit) {
-         case SW_SELF_TEST_SWITCH:
-            returnState = MACHINE_STATE_TEST_LAMPS;
-            SetLastSelfTestChangedTime(CurrentTime);
-            break;
-
-         case SW_SAUCER:
-            RPU_PushToSolenoidStack(SOL_SAUCER, 5, true);
-            break;
-
-         case SW_COIN_1:
-         case SW_COIN_2:
-         case SW_COIN_3:
-            AddCoinToAudit(switchHit);
-            AddCredit(true, 1);
-            break;
-         }
-      }
+   while ((switchHit = RPU_PullFirstFromSwitchStack()) != SWITCH_STACK_EMPTY) {
+      returnState = DispatchSwitch(switchHandlers, switchHit, returnState, scoreMultiplier);
    }
 
    if (bonusAtTop != Bonus) {
@@ -2875,6 +2837,9 @@ int RunGamePlayMode(int curState, bool curStateChanged) {
 
    if (scoreAtTop != CurrentPlayerCurrentScore) {
       LastTimeScoreChanged = CurrentTime;
+      if (GameTimers.IsPaused() && NumTiltWarnings <= MaxTiltWarnings) {
+         GameTimers.Resume(CurrentTime);
+      }
       if (!TournamentScoring) {
          for (int awardCount = 0; awardCount < 3; awardCount++) {
             if (AwardScores[awardCount] != 0 && scoreAtTop < AwardScores[awardCount] &&
@@ -2896,9 +2861,16 @@ int RunGamePlayMode(int curState, bool curStateChanged) {
    return returnState;
 }
 
-void loop() {
-   RPU_DataRead(0);
-   CurrentTime = millis();
+/*********************************************************************
+    Main loop tasks
+*********************************************************************/
+// Rules run every pass so they see switches as soon as they're pulled
+// from the stack (they also keep their own timers). The rest only run
+// as often as they need to.
+RPUScheduler<6> LoopTasks;
+
+void RunRulesTask(unsigned long curTime) {
+   (void)curTime;
    int newMachineState = MachineState;
 
    if (MachineState < 0) {
@@ -2910,12 +2882,71 @@ void loop() {
    }
 
    if (newMachineState != MachineState) {
+      if (newMachineState == MACHINE_STATE_ATTRACT || (newMachineState < 0 && MachineState >= 0)) {
+         // Nothing is timing-critical in attract mode or self test, so
+         // finish off anything the cache hasn't written yet (self test
+         // can be left with the power switch)
+         CommitEEPromWrites();
+      }
       MachineState = newMachineState;
       MachineStateChanged = true;
    } else {
       MachineStateChanged = false;
    }
+}
+
+void RunAudioTask(unsigned long curTime) {
+   Audio.Update(curTime);
+}
+
+void RunFrameTask(unsigned long curTime) {
+   (void)curTime;
+   RPU_CommitFrame();
+}
+
+void AddLoopTasks() {
+   // name, function, period (ms), priority, budget (us)
+   LoopTasks.AddTask("Rules", RunRulesTask, 0, 50, 2000);
+   LoopTasks.AddTask("RPU", RPU_UpdateTimedStacks, 0, 40, 200);
+   LoopTasks.AddTask("Audio", RunAudioTask, 5, 30, 1000);
+   LoopTasks.AddTask("Lamps", RPU_ApplyFlashToLamps, 50, 20, 500);
+   LoopTasks.AddTask("Displays", RPU_UpdateDisplayEffects, 25, 20, 500);
+   // Last, so it picks up everything drawn this pass
+   LoopTasks.AddTask("Frame", RunFrameTask, 0, 0, 200);
+   LoopTasks.ResetStats();
+}
+
+void loop() {
+   RPU_DataRead(0);
+   CurrentTime = millis();
+
+#if defined(DEBUG_MESSAGES)
+   // On the debug console, 's' dumps the task stats, 'p' dumps the
+   // interrupt profile, 'l' dumps the switch latencies and 'r' resets
+   // all of them
+   if (Serial.available()) {
+      int debugCommand = Serial.read();
+      if (debugCommand == 's') {
+         LoopTasks.DumpStats();
+      } else if (debugCommand == 'r') {
+         LoopTasks.ResetStats();
+      }
+#if defined(RPU_OS_PROFILE_INTERRUPTS)
+      if (debugCommand == 'p') {
+         RPU_DumpInterruptProfile();
+      } else if (debugCommand == 'r') {
+         RPU_ResetInterruptProfile();
+      }
+#endif
+#if defined(RPU_OS_TRACK_SWITCH_LATENCY)
+      if (debugCommand == 'l') {
+         RPU_DumpSwitchLatency();
+      } else if (debugCommand == 'r') {
+         RPU_ResetSwitchLatency();
+      }
+#endif
+   }
+#endif
 
-   Audio.Update(CurrentTime);
-   RPU_Update(CurrentTime);
+   LoopTasks.Run(CurrentTime);
 }